@@ -0,0 +1,83 @@
+#!/usr/bin/python3
+
+# Measures the first-load time of the web app served by a device: index.html
+# is fetched, then every script, style sheet and image it references, six at a
+# time like a browser does. No request is answered from a cache, so it is the
+# time a browser needs on its first visit until the app starts. The chunks of
+# the views, which the app imports once it runs, are not included.
+#
+# Passing a second device compares the two, e.g. a device serving the web app
+# from the asset partition (see src/web/AssetImage.h) with one running a
+# firmware that still serves it from LittleFS.
+#
+# Usage:
+#   python bench-web.py http://192.168.4.1
+#   python bench-web.py http://192.168.4.1 --baseline http://192.168.4.2 --runs 20
+
+import argparse
+import gzip
+import re
+import statistics
+import sys
+import time
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+from urllib.parse import urljoin
+
+CONNECTIONS = 6
+REFERENCE = re.compile(r'(?:src|href)="(/[^"]+)"')
+
+
+def fetch(url, timeout):
+    """Fetch a URL, returns the bytes received and the decoded content."""
+
+    request = urllib.request.Request(url, headers={"Accept-Encoding": "gzip"})
+    with urllib.request.urlopen(request, timeout=timeout) as response:
+        data = response.read()
+        encoding = response.headers.get("Content-Encoding", "")
+    return data, gzip.decompress(data) if encoding == "gzip" else data
+
+
+def load(base, timeout):
+    """Load the web app once, returns the time in seconds, the number of requests and bytes."""
+
+    start = time.perf_counter()
+    received, index = fetch(urljoin(base, "/"), timeout)
+    paths = sorted(set(REFERENCE.findall(index.decode("utf-8", "replace"))))
+    with ThreadPoolExecutor(max_workers=CONNECTIONS) as pool:
+        responses = list(pool.map(lambda path: fetch(urljoin(base, path), timeout), paths))
+    size = len(received) + sum(len(data) for data, _ in responses)
+    return time.perf_counter() - start, len(paths) + 1, size
+
+
+def measure(base, runs, timeout):
+    """Load the web app a number of times and print the statistics, returns the median in seconds."""
+
+    times = []
+    for _ in range(runs):
+        seconds, requests, size = load(base, timeout)
+        times.append(seconds)
+    median = statistics.median(times)
+    print(
+        f"{base}: {requests} requests, {size:,} bytes, "
+        f"median {median * 1000:.0f} ms, min {min(times) * 1000:.0f} ms, max {max(times) * 1000:.0f} ms"
+    )
+    return median
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Measure the first-load time of the web app")
+    parser.add_argument("url", help="base URL of the device")
+    parser.add_argument("--baseline", help="base URL of a device to compare with")
+    parser.add_argument("--runs", type=int, default=10)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    try:
+        median = measure(args.url, args.runs, args.timeout)
+        if args.baseline:
+            baseline = measure(args.baseline, args.runs, args.timeout)
+            print(f"{args.url} loads in {median / baseline * 100:.0f} % of the time of {args.baseline}")
+    except OSError as error:
+        print(f"Loading failed: {error}")
+        sys.exit(1)
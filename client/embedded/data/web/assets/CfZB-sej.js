@@ -1 +0,0 @@
-import{z as o}from"./C117Z9UZ.js";function n(t,e,a,m){return o({get:t,set:u=>{e(Math.max(a,Math.min(m,u)))}})}export{n as u};
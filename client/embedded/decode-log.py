@@ -0,0 +1,235 @@
+#!/usr/bin/python3
+
+# Decodes the binary log frames the firmware sends when it is built with
+# -DLOGGER_BINARY_FRAMES=1 (see src/util/Logger.cpp). Deferred messages carry
+# only the address of their format string, which is looked up in the firmware
+# ELF, so the ELF has to be the one of the running firmware.
+#
+# Frame:
+#   Byte   0:     0xA5 sync
+#   Byte   1:     Type
+#   Byte   2:     Payload length
+#   --- payload ---
+#   'M' module:   id (uint8_t), name
+#   'T' text:     timestamp ms (uint32_t), level (uint8_t), module id (uint8_t), text
+#   'D' deferred: timestamp ms (uint32_t), level (uint8_t), module id (uint8_t),
+#                 format string address (uint32_t), packed arguments
+#   'X' dropped:  number of dropped messages (uint32_t)
+#   --- ---
+#   Byte   n:     XOR of the payload bytes
+#
+# The arguments of deferred messages are tagged and packed as described in
+# lib/util/LogArgs.h. Bytes outside of frames (e.g. boot messages) are printed
+# as they are.
+#
+# Usage:
+#   python decode-log.py .pio/build/wemos_d1_mini32/firmware.elf --port /dev/ttyUSB0
+#   python decode-log.py .pio/build/wemos_d1_mini32/firmware.elf < capture.bin
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+LEVELS = ["OK", "DEBUG", "INFO", "WARN", "ERROR"]
+
+# Width of long on the ESP32
+LONG_BITS = 32
+
+CONVERSION = re.compile(r"%([-+ #0]*[0-9]*(?:\.[0-9]*)?)(hh|h|ll|l|z|j|t)?([a-zA-Z%])")
+
+SHT_NOBITS = 8
+SHF_ALLOC = 2
+
+
+class Elf:
+    """Minimal ELF reader, resolving addresses of loaded sections to their bytes."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        is64 = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x3A)
+            section = endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x2E)
+            section = endian + "IIIIII"
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from(section, self.data, shoff + i * shentsize)
+            if flags & SHF_ALLOC and sh_type != SHT_NOBITS and size > 0:
+                self.sections.append((addr, size, offset))
+        self.strings = {}
+
+    def string_at(self, address):
+        """Provide the NUL-terminated string at a load address, or None."""
+
+        if address in self.strings:
+            return self.strings[address]
+        result = None
+        for addr, size, offset in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.find(b"\0", start, offset + size)
+                if end >= 0:
+                    result = self.data[start:end].decode("utf-8", "replace")
+                break
+        self.strings[address] = result
+        return result
+
+
+def read_argument(args, consumed):
+    """Read the tagged argument at an offset, returns the value and the next offset."""
+
+    tag = chr(args[consumed])
+    consumed += 1
+    if tag == "s":
+        end = args.find(b"\0", consumed)
+        end = len(args) if end < 0 else end
+        return args[consumed:end].decode("utf-8", "replace"), end + 1
+    sizes = {"i": 4, "u": 4, "q": 8, "Q": 8, "d": 8}
+    if tag not in sizes or consumed + sizes[tag] > len(args):
+        raise ValueError(f"invalid argument tag {tag!r}")
+    raw = args[consumed : consumed + sizes[tag]]
+    if tag == "d":
+        value, = struct.unpack("<d", raw)
+    else:
+        value = int.from_bytes(raw, "little", signed=tag in "iq")
+    return value, consumed + sizes[tag]
+
+
+def format_deferred(fmt, args):
+    """Format a deferred message exactly as Logger::formatDeferred() does on the device."""
+
+    out = []
+    consumed = 0
+    pos = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[pos : match.start()])
+        pos = match.end()
+        flags, length, conversion = match.group(1), match.group(2) or "", match.group(3)
+        if conversion == "%":
+            out.append("%")
+            continue
+        if conversion not in "diouxXcsfFeEgGaAp":
+            continue
+        if consumed >= len(args):
+            out.append("?")
+            continue
+        try:
+            value, consumed = read_argument(args, consumed)
+        except ValueError:
+            consumed = len(args)
+            out.append("?")
+            continue
+        if conversion == "s":
+            out.append(("%" + flags + "s") % value)
+        elif isinstance(value, str):
+            out.append("?")
+        elif conversion in "fFeEgGaA":
+            out.append(("%" + flags + conversion.replace("a", "e").replace("A", "E")) % float(value))
+        elif conversion == "p":
+            out.append("0x%x" % (int(value) & 0xFFFFFFFF))
+        else:
+            bits = 64 if length in ("ll", "j") else LONG_BITS if length == "l" else 32
+            value = int(value) & ((1 << bits) - 1)
+            if conversion in "dic" and value >= 1 << (bits - 1):
+                value -= 1 << bits
+            if conversion == "c":
+                out.append(("%" + flags + "c") % (value & 0xFF))
+            else:
+                out.append(("%" + flags + ("d" if conversion == "i" else conversion)) % value)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Decoder:
+    """Splits the serial stream into frames and prints them as log lines."""
+
+    def __init__(self, elf, out):
+        self.elf = elf
+        self.out = out
+        self.modules = {}
+        self.buffer = bytearray()
+
+    def feed(self, data):
+        self.buffer += data
+        while self.buffer:
+            sync = self.buffer.find(bytes([SYNC]))
+            if sync != 0:
+                text = self.buffer if sync < 0 else self.buffer[:sync]
+                self.out.write(text.decode("utf-8", "replace"))
+                del self.buffer[: len(text)]
+                continue
+            if len(self.buffer) < 3:
+                return
+            length = self.buffer[2]
+            if len(self.buffer) < length + 4:
+                return
+            payload = bytes(self.buffer[3 : 3 + length])
+            check = 0
+            for byte in payload:
+                check ^= byte
+            if check != self.buffer[3 + length]:
+                # not a frame, print the sync byte as it is and resynchronize
+                self.out.write(bytes(self.buffer[:1]).decode("latin-1"))
+                del self.buffer[:1]
+                continue
+            self.frame(chr(self.buffer[1]), payload)
+            del self.buffer[: length + 4]
+        self.out.flush()
+
+    def frame(self, kind, payload):
+        if kind == "M":
+            self.modules[payload[0]] = payload[1:].decode("utf-8", "replace")
+        elif kind in "TD":
+            timestamp, level, module = struct.unpack_from("<IBB", payload)
+            if kind == "T":
+                message = payload[6:].decode("utf-8", "replace")
+            else:
+                address, = struct.unpack_from("<I", payload, 6)
+                fmt = self.elf.string_at(address)
+                if fmt is None:
+                    message = f"<unknown format 0x{address:08x}> {payload[10:].hex()}"
+                else:
+                    message = format_deferred(fmt, payload[10:])
+            self.write(timestamp, level, self.modules.get(module, "?"), message)
+        elif kind == "X":
+            count, = struct.unpack_from("<I", payload)
+            self.out.write(f"[WARN][Logger] {count} messages dropped, log ring full\n")
+
+    def write(self, timestamp, level, module, message):
+        name = LEVELS[level] if level < len(LEVELS) else "UNKNOWN"
+        self.out.write(f"[{timestamp // 1000}.{timestamp % 1000:03d}][{name}][{module}] {message}\n")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Decode the binary log frames of the firmware")
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("--port", help="serial port to read from, stdin is read if omitted")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    decoder = Decoder(Elf(args.elf), sys.stdout)
+    try:
+        if args.port:
+            import serial
+
+            with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+                while True:
+                    decoder.feed(port.read(256))
+        else:
+            while True:
+                data = sys.stdin.buffer.read1(256) if hasattr(sys.stdin.buffer, "read1") else sys.stdin.buffer.read(256)
+                if not data:
+                    break
+                decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,264 @@
+#!/usr/bin/python3
+
+# Packs the web app in webapp/ (the output of the web client build) into the
+# asset image, which is written to the "assets" flash partition and served
+# from memory-mapped flash (see src/web/AssetImage.h). Generates
+# src/web/AssetTable.h, the manifest of the image, so that the web server
+# finds an asset with one hash lookup (see src/web/AssetManifest.h).
+#
+# Every file is listed under the URL it is served at, a gzip-compressed file
+# without its .gz extension. An entry records the offset and size of the file
+# in the image, its content type, encoding and a strong ETag derived from the
+# served bytes.
+#
+# Image format (32-byte header + payload):
+#   Bytes  0-3:   GFAS Magic
+#   Byte   4:     Format version (1)
+#   Bytes  5-7:   Reserved (0x00)
+#   Bytes  8-11:  Image id (uint32_t, little-endian), AssetTable::imageId
+#   Bytes  12-15: Asset count (uint32_t, little-endian)
+#   Bytes  16-19: Image size including the header (uint32_t, little-endian)
+#   Bytes  20-31: Reserved (0x00)
+#   --- payload ---
+#   [files, each starting on a 4-byte boundary]
+#
+# The firmware only serves an image with the id of its manifest.
+#
+# The entries form a minimal perfect hash table (hash and displace): the first
+# FNV-1a hash of a path selects a seed, its hash with that seed the entry.
+# Paths not in the table still hash to some entry, so the device compares the
+# path of the entry.
+#
+# Usage:
+#   PlatformIO:  runs automatically before the firmware is built, the image is
+#                written to the build directory as assets.bin and added to the
+#                images written by upload (and merged by mergebin) at the offset
+#                of the "assets" partition in partitions.csv
+#   Standalone:  python gen-asset-manifest.py [<web dir> [<output header> [<output image>]]]
+
+import csv
+import hashlib
+import os
+import struct
+import sys
+
+WEB_DIR = "webapp"
+OUTPUT = os.path.join("src", "web", "AssetTable.h")
+IMAGE_NAME = "assets.bin"
+PARTITION_NAME = "assets"
+COMPRESSED_EXTENSION = ".gz"
+MAX_SEED = 0xFFFF
+
+HEADER_SIZE = 32
+MAGIC = b"GFAS"
+FORMAT_VERSION = 1
+ALIGNMENT = 4
+
+CONTENT_TYPES = {
+    "html": "text/html",
+    "css": "text/css",
+    "js": "application/javascript",
+    "ico": "image/x-icon",
+    "png": "image/png",
+    "svg": "image/svg+xml",
+    "jpg": "image/jpeg",
+    "jpeg": "image/jpeg",
+    "json": "application/json",
+    "woff2": "font/woff2",
+    "woff": "font/woff",
+    "ttf": "font/ttf",
+    "txt": "text/plain",
+}
+DEFAULT_CONTENT_TYPE = "application/octet-stream"
+
+
+def fnv1a(text, seed):
+    """32 bit FNV-1a of a path with a seed, must match AssetManifest::Hash()."""
+
+    h = (0x811C9DC5 ^ seed) & 0xFFFFFFFF
+    for byte in text.encode("utf-8"):
+        h ^= byte
+        h = (h * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def collect(web_dir):
+    """List the assets of the web app with their contents, sorted by URL."""
+
+    assets = {}
+    for root, _, files in os.walk(web_dir):
+        for name in files:
+            path = os.path.join(root, name)
+            relative = "/" + os.path.relpath(path, web_dir).replace(os.sep, "/")
+            gzip = relative.endswith(COMPRESSED_EXTENSION)
+            url = relative[: -len(COMPRESSED_EXTENSION)] if gzip else relative
+            # the compressed file wins, like on the device before
+            if url in assets and not gzip:
+                continue
+            with open(path, "rb") as f:
+                data = f.read()
+            extension = url.rsplit(".", 1)[-1].lower() if "." in url else ""
+            assets[url] = {
+                "url": url,
+                "data": data,
+                "content_type": CONTENT_TYPES.get(extension, DEFAULT_CONTENT_TYPE),
+                "gzip": gzip,
+                "size": len(data),
+                "etag": '"' + hashlib.sha256(data).hexdigest()[:16] + '"',
+            }
+    return [assets[url] for url in sorted(assets)]
+
+
+def layout(assets):
+    """Assign the offsets of the files in the image, returns the image id and size."""
+
+    offset = HEADER_SIZE
+    image_id = 0
+    for asset in assets:
+        asset["offset"] = offset
+        offset += (asset["size"] + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+        image_id = fnv1a(asset["url"] + asset["etag"], image_id)
+    return image_id, offset
+
+
+def pack(assets, image_id, size):
+    """Build the image, layout() must have been called."""
+
+    image = bytearray(size)
+    image[0:HEADER_SIZE] = MAGIC + struct.pack("<B3xIII12x", FORMAT_VERSION, image_id, len(assets), size)
+    for asset in assets:
+        image[asset["offset"] : asset["offset"] + asset["size"]] = asset["data"]
+    return bytes(image)
+
+
+def build_table(urls):
+    """Find a seed per bucket, so that every URL gets its own slot. Returns the seeds and slots."""
+
+    count = len(urls)
+    buckets = [[] for _ in range(count)]
+    for index, url in enumerate(urls):
+        buckets[fnv1a(url, 0) % count].append(index)
+    seeds = [0] * count
+    slots = [None] * count
+    # place the largest buckets first, while most slots are free
+    for bucket in sorted(range(count), key=lambda b: -len(buckets[b])):
+        members = buckets[bucket]
+        if not members:
+            break
+        for seed in range(1, MAX_SEED + 1):
+            targets = [fnv1a(urls[i], seed) % count for i in members]
+            if len(set(targets)) == len(targets) and all(slots[t] is None for t in targets):
+                for i, t in zip(members, targets):
+                    slots[t] = i
+                seeds[bucket] = seed
+                break
+        else:
+            raise RuntimeError("No perfect hash seed found")
+    return seeds, slots
+
+
+def render(assets, image_id, size):
+    lines = [
+        "// Generated by gen-asset-manifest.py from webapp/, do not edit.",
+        "",
+        "#pragma once",
+        "",
+        '#include "AssetManifest.h"',
+        "",
+        "namespace AssetTable",
+        "{",
+        f"    constexpr uint32_t imageId = 0x{image_id:08x};",
+        f"    constexpr uint32_t imageSize = {size};",
+    ]
+    if not assets:
+        lines += [
+            "    constexpr uint32_t count = 0;",
+            "    constexpr uint16_t seeds[1] = { 0 };",
+            '    constexpr Asset assets[1] = { { "", "", 0, 0, false, "" } };',
+            "}",
+            "",
+        ]
+        return "\n".join(lines)
+    seeds, slots = build_table([asset["url"] for asset in assets])
+    lines.append(f"    constexpr uint32_t count = {len(assets)};")
+    lines.append("")
+    lines.append("    constexpr uint16_t seeds[count] = {")
+    for start in range(0, len(seeds), 16):
+        lines.append("        " + ", ".join(str(seed) for seed in seeds[start : start + 16]) + ",")
+    lines.append("    };")
+    lines.append("")
+    lines.append("    constexpr Asset assets[count] = {")
+    for slot in slots:
+        asset = assets[slot]
+        etag = asset["etag"].replace('"', '\\"')
+        lines.append(
+            f'        {{ "{asset["url"]}", "{asset["content_type"]}", {asset["offset"]}, '
+            f'{asset["size"]}, {"true" if asset["gzip"] else "false"}, "{etag}" }},'
+        )
+    lines.append("    };")
+    lines.append("}")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def generate(web_dir, output, image_path):
+    """Write the image and the manifest header, the header only if it changed so that nothing is rebuilt needlessly."""
+
+    assets = collect(web_dir) if os.path.isdir(web_dir) else []
+    image_id, size = layout(assets)
+    os.makedirs(os.path.dirname(os.path.abspath(image_path)), exist_ok=True)
+    with open(image_path, "wb") as f:
+        f.write(pack(assets, image_id, size))
+    content = render(assets, image_id, size)
+    if os.path.isfile(output):
+        with open(output, "r") as f:
+            if f.read() == content:
+                return
+    with open(output, "w") as f:
+        f.write(content)
+    print(f"[ASSETS] Generated {output} and {image_path} with {len(assets)} assets, {size:,} bytes")
+
+
+def find_partition_offset(table, name):
+    """Look up the offset of a partition in a partition table, or None."""
+
+    if not os.path.isfile(table):
+        return None
+    with open(table, newline="") as f:
+        for row in csv.reader(f):
+            fields = [field.strip() for field in row]
+            if len(fields) >= 4 and fields[0] == name:
+                return fields[3]
+    return None
+
+
+# ---------------------------------------------------------------------------
+# PlatformIO integration – regenerate before the firmware is compiled
+# ---------------------------------------------------------------------------
+try:
+    Import("env")
+
+    project_dir = env.subst("${PROJECT_DIR}")
+    image_path = os.path.join(env.subst("${BUILD_DIR}"), IMAGE_NAME)
+    generate(
+        os.path.join(project_dir, WEB_DIR),
+        os.path.join(project_dir, OUTPUT),
+        image_path,
+    )
+
+    # registered before the upload command is assembled, hence in this pre script
+    partition_table = os.path.join(project_dir, env.GetProjectOption("board_build.partitions", "partitions.csv"))
+    offset = find_partition_offset(partition_table, PARTITION_NAME)
+    if offset is not None:
+        env.Append(FLASH_EXTRA_IMAGES=[(offset, image_path)])
+except Exception:
+    pass
+
+# ---------------------------------------------------------------------------
+# Standalone CLI usage
+# ---------------------------------------------------------------------------
+if __name__ == "__main__":
+    web_dir = sys.argv[1] if len(sys.argv) > 1 else WEB_DIR
+    output = sys.argv[2] if len(sys.argv) > 2 else OUTPUT
+    image_path = sys.argv[3] if len(sys.argv) > 3 else os.path.join(".pio", "build", "wemos_d1_mini32", IMAGE_NAME)
+    generate(web_dir, output, image_path)
@@ -13,7 +13,7 @@ bool FileSystem::Begin()
 
 File FileSystem::OpenFile(String path) 
 {
-    Logger::log("FileSystem", Logger::LogLevel::INFO, "Opened file: %s", path.c_str());
+    LOG(FileSystem, INFO, "Opened file: %s", path.c_str());
     return LittleFS.open(path, FILE_READ);
 }
 
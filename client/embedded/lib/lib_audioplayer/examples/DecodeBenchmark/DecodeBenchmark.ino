@@ -0,0 +1,75 @@
+/*
+ * Compares the CPU cost of decoding the MP3 clips with their .gfa siblings
+ * created by transcode-audio.py.
+ *
+ * Upload the filesystem image with the transcoded clips first, then flash
+ * this sketch and open the serial monitor (115200 baud). For every clip the
+ * CPU cycles needed per second of audio are printed for both formats.
+ */
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioGeneratorGfa.h>
+
+/** Discards the samples, so that only the decoder is measured. */
+class AudioOutputNull : public AudioOutput
+{
+    public:
+        uint32_t frames = 0;
+
+        virtual bool begin() override { frames = 0; return true; }
+        virtual bool ConsumeSample(int16_t sample[2]) override { frames++; return true; }
+        virtual bool stop() override { return true; }
+        int GetRate() const { return hertz; }
+};
+
+static const char* clips[] = { "/hit-1", "/miss-1", "/miss-2", "/miss-3", "/tick-1", "/tick-2", "/tick-3", "/tick-4", "/tick-5", "/waiting" };
+
+/** Decodes a clip completely, returns the cycles per second of audio or 0 if the clip cannot be decoded. */
+static uint64_t Measure(AudioGenerator& decoder, const String& path)
+{
+    AudioFileSourceFS file(LittleFS);
+    AudioOutputNull output;
+    if (!LittleFS.exists(path) || !file.open(path.c_str()) || !decoder.begin(&file, &output)) {
+        return 0;
+    }
+    uint64_t cycles = 0;
+    bool running = true;
+    while (running) {
+        uint32_t start = ESP.getCycleCount();
+        running = decoder.isRunning() && decoder.loop();
+        cycles += (uint32_t)(ESP.getCycleCount() - start);
+    }
+    decoder.stop();
+    if (output.frames == 0 || output.GetRate() == 0) {
+        return 0;
+    }
+    return cycles * output.GetRate() / output.frames;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    if (!LittleFS.begin()) {
+        Serial.println("LittleFS not mounted");
+        return;
+    }
+    Serial.printf("CPU: %u MHz\n", ESP.getCpuFreqMHz());
+    Serial.println("clip        MP3 cycles/s   GFA cycles/s   MP3 load   GFA load");
+
+    AudioGeneratorMP3 mp3;
+    AudioGeneratorGfa gfa;
+    uint64_t cyclesPerCore = (uint64_t)ESP.getCpuFreqMHz() * 1000000ULL;
+    for (const char* clip : clips) {
+        uint64_t mp3Cycles = Measure(mp3, String(clip) + ".mp3");
+        uint64_t gfaCycles = Measure(gfa, String(clip) + ".gfa");
+        Serial.printf("%-10s %14llu %14llu %9.2f%% %9.2f%%\n", clip, mp3Cycles, gfaCycles, 
+            100.0 * mp3Cycles / cyclesPerCore, 100.0 * gfaCycles / cyclesPerCore);
+    }
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <FileSystem.h>
+
+/** The decoded beginning of a clip, kept in internal RAM. */
+struct AudioClipHead
+{
+    /** The clip path, points to static storage */
+    const char* path;
+    /** The samples, interleaved if the clip has two channels */
+    int16_t* samples;
+    uint32_t frames;
+    /** The allocated size of samples */
+    size_t bytes;
+    uint32_t sampleRate;
+    uint8_t channels;
+    /** The use counter value of the last lookup, used for eviction */
+    uint32_t lastUsed;
+    /** The number of voices playing the samples, a pinned head is not evicted */
+    uint8_t pins;
+};
+
+struct AudioClipCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    size_t bytesUsed;
+    size_t budgetBytes;
+    uint8_t clips;
+};
+
+/**
+ * Keeps the first milliseconds of clips as decoded PCM in internal RAM,
+ * so that playback starts without opening and decoding the file.
+ *
+ * The cache never uses more than its byte budget, the least recently used
+ * clips are evicted to make room. Heads pinned by a voice are skipped, so a
+ * clip that is playing keeps its samples even if that leaves no room for
+ * another one. It is owned by the audio task, only GetStats() may be called
+ * from other tasks.
+ */
+class AudioClipCache
+{
+    public:
+        static const uint8_t maxClips = 8;
+
+        AudioClipCache(FileSystem* fileSystem, size_t budgetBytes, uint16_t headMs);
+        virtual ~AudioClipCache();
+
+        /** Decodes and caches the head of the clip unless it is cached already. */
+        bool Load(const char* path);
+        /** Provides the head of the clip or nullptr, counting a cache hit or miss. */
+        AudioClipHead* Find(const char* path);
+        AudioClipCacheStats GetStats() const;
+
+    private:
+        friend class AudioOutputCapture;
+
+        AudioClipHead* Lookup(const char* path);
+        /** Evicts least recently used, unpinned clips until the requested bytes fit, returns the bytes that fit. */
+        size_t Reserve(size_t bytes, const AudioClipHead* keep);
+        void Evict(AudioClipHead& head);
+
+        FileSystem* fileSystem;
+        size_t budgetBytes;
+        uint16_t headMs;
+        AudioClipHead heads[maxClips];
+        uint32_t useCounter;
+
+        std::atomic<uint32_t> hits;
+        std::atomic<uint32_t> misses;
+        std::atomic<size_t> bytesUsed;
+        std::atomic<uint8_t> clips;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <AudioGenerator.h>
+
+/**
+ * Streams .gfa clips created by transcode-audio.py: mono PCM or IMA-ADPCM
+ * with a 16-byte header. The fixed-point decoder needs a table lookup and a
+ * few additions per sample, so it costs a fraction of MP3 decoding.
+ */
+class AudioGeneratorGfa : public AudioGenerator
+{
+    public:
+        static const uint8_t codecPcm = 0;
+        static const uint8_t codecImaAdpcm = 1;
+
+        /** Indicates whether the path refers to a .gfa clip. */
+        static bool IsGfaClip(const char* path);
+
+        AudioGeneratorGfa();
+        virtual ~AudioGeneratorGfa() override;
+
+        virtual bool begin(AudioFileSource* source, AudioOutput* output) override;
+        virtual bool loop() override;
+        virtual bool stop() override;
+        virtual bool isRunning() override;
+
+    private:
+        static const uint8_t headerSize = 16;
+        static const uint16_t blockSize = 256;
+        static const uint8_t blockHeaderSize = 4;
+
+        /** Decodes the next sample, returns false at the end of the clip. */
+        bool NextSample(int16_t& sample);
+        bool ReadBlock();
+
+        uint8_t codec;
+        uint32_t samplesLeft;
+        bool samplePending;
+
+        uint8_t block[blockSize];
+        uint16_t blockLength;
+        /** The position in the block, in nibbles for IMA-ADPCM and in bytes for PCM */
+        uint16_t blockPosition;
+        uint16_t blockEnd;
+
+        int32_t predictor;
+        int8_t stepIndex;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <FileSystem.h>
+
+struct AudioMetronomeStats
+{
+    uint32_t ticks;
+    /** The range of how far ahead of its play time a tick has been written to the output */
+    int32_t minLeadUs;
+    int32_t maxLeadUs;
+    /** Ticks written after their play time because the output ran empty */
+    uint32_t lateTicks;
+    /** The largest deviation of a tick from its scheduled play time */
+    uint32_t maxJitterUs;
+};
+
+/**
+ * Schedules metronome ticks in the sample domain. Ticks are due on exact frame
+ * numbers of the output stream and are played from RAM, so their timing does
+ * not depend on when the audio task runs, as long as the output does not run
+ * empty.
+ *
+ * The tick clip is decoded into RAM at the output rate when the metronome
+ * starts, up to the interval of the current tempo and at most budgetBytes.
+ * Only the clip of the running metronome is kept, changing the clip decodes
+ * it again and stopping frees it. A tick that is still playing when the next
+ * one is due is faded out, so ticks never overlap.
+ * Owned by the audio task, only GetStats() may be called from other tasks.
+ */
+class AudioMetronome
+{
+    public:
+        /** budgetBytes limits the RAM of the tick clip (44 B/ms), longer clips are cut even at slow tempos. */
+        AudioMetronome(FileSystem* fileSystem, uint32_t outputRate, size_t budgetBytes);
+        virtual ~AudioMetronome();
+
+        /**
+         * Starts ticking with the clip and beats per minute, the first tick is due
+         * on the given frame. A running metronome keeps its beat and only changes
+         * the clip and tempo of the following ticks.
+         */
+        void Start(const char* path, uint16_t bpm, uint64_t frame);
+        void Stop();
+        bool IsRunning() const;
+
+        bool IsDue(uint64_t frame) const;
+        /** Starts the due tick and schedules the next one. */
+        void Trigger(uint64_t frame, int32_t leadUs);
+        /** Provides the next sample of the current tick, returns false if no tick is playing. */
+        bool Peek(int16_t& sample) const;
+        void Advance();
+
+        AudioMetronomeStats GetStats() const;
+
+    private:
+        struct Clip
+        {
+            const char* path;
+            int16_t* samples;
+            uint32_t frames;
+            /** The frames the clip was cut to when it was decoded, 0 if it is complete */
+            uint32_t limit;
+        };
+
+        /** Decodes the clip into at most the given frames in place of the loaded one, unless it is loaded already. */
+        bool Load(const char* path, uint32_t capacity);
+        void Free();
+        /** The frames of a clip that play before the next tick, at most the limit in RAM */
+        uint32_t GetCapacity(uint32_t interval) const;
+
+        FileSystem* fileSystem;
+        uint32_t outputRate;
+        uint32_t maxClipFrames;
+        /** The step the decode buffer grows by */
+        uint32_t growFrames;
+        /** The length of the fade out of a cut tick */
+        uint32_t fadeFrames;
+        /** The only clip in RAM, empty while the metronome is stopped */
+        Clip clip;
+        bool running;
+        uint16_t bpm;
+        uint32_t intervalFrames;
+        uint64_t nextTickFrame;
+        /** The clip of the current tick, nullptr if no tick is playing */
+        const Clip* tick;
+        uint32_t tickPosition;
+        /** The frame the current tick ends at, before the end of its clip if the next tick is due */
+        uint32_t tickEnd;
+
+        std::atomic<uint32_t> ticks;
+        std::atomic<int32_t> minLeadUs;
+        std::atomic<int32_t> maxLeadUs;
+        std::atomic<uint32_t> lateTicks;
+        std::atomic<uint32_t> maxJitterUs;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <AudioVoice.h>
+
+struct AudioMixerStats
+{
+    /** CPU cycles spent per second of audio on decoding all voices */
+    uint32_t decodeCyclesPerSecond;
+    /** CPU cycles spent per second of audio on mixing and writing to I2S */
+    uint32_t mixCyclesPerSecond;
+    /** The share of the mixing cycles per voice playing for a second */
+    uint32_t mixCyclesPerVoiceSecond;
+    /** The most voices mixed at once within the last second */
+    uint8_t peakVoices;
+    uint8_t maxVoices;
+};
+
+/**
+ * Sums the frames of several voices, each scaled by its gain, in fixed point
+ * with saturation. Also measures the CPU cycles spent per second of audio, so
+ * that the number of voices can be weighed against the detection workload.
+ *
+ * Owned by the audio task, only GetStats() may be called from other tasks.
+ */
+class AudioMixer
+{
+    public:
+        static const uint8_t maxVoices = 3;
+
+        AudioMixer(FileSystem* fileSystem, uint32_t outputRate);
+        virtual ~AudioMixer();
+
+        /** Provides an idle voice, or the voice playing the oldest clip if all are busy. */
+        AudioVoice& Allocate();
+        void Stop();
+        bool IsActive() const;
+
+        /** Decodes all voices until their buffers are full. */
+        void Decode();
+        /** Adds the next frame of every voice to the sum, returns the number of voices with a frame. */
+        uint8_t Peek(int32_t sum[2]);
+        /** Consumes the frames added by the last Peek(). */
+        void Pop();
+        /** Records the cycles spent on writing the given number of frames. */
+        void AccountMix(uint32_t cycles, uint32_t frames);
+
+        static int16_t Saturate(int32_t sample);
+
+        AudioMixerStats GetStats() const;
+
+    private:
+        AudioVoice* voices[maxVoices];
+        /** The voices that contributed to the last Peek() */
+        bool peeked[maxVoices];
+        uint32_t outputRate;
+
+        // measurement of the current second of audio
+        uint64_t decodeCycles;
+        uint64_t mixCycles;
+        uint32_t mixedFrames;
+        uint32_t mixedVoiceFrames;
+        uint8_t peakVoices;
+
+        std::atomic<uint32_t> decodeCyclesPerSecond;
+        std::atomic<uint32_t> mixCyclesPerSecond;
+        std::atomic<uint32_t> mixCyclesPerVoiceSecond;
+        std::atomic<uint8_t> lastPeakVoices;
+};
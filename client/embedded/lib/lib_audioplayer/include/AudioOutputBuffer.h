@@ -0,0 +1,34 @@
+#pragma once
+#include <AudioOutput.h>
+#include <AudioResampler.h>
+
+/**
+ * Buffers the decoded frames of a clip, converted to the output rate of the
+ * player. The decoder fills the buffer, the player drains it into the I2S
+ * stream. Both happen on the audio task.
+ */
+class AudioOutputBuffer : public AudioOutput
+{
+    public:
+        static const uint16_t capacity = 512;
+
+        AudioOutputBuffer(uint32_t outputRate);
+
+        virtual bool SetRate(int hz) override;
+        virtual bool begin() override;
+        virtual bool ConsumeSample(int16_t sample[2]) override;
+        virtual bool stop() override;
+
+        bool Peek(int16_t frame[2]) const;
+        void Pop();
+        uint16_t Available() const;
+        /** Drops all buffered frames. */
+        void Clear();
+
+    private:
+        uint32_t outputRate;
+        AudioResampler resampler;
+        int16_t frames[capacity][2];
+        uint16_t readIndex;
+        uint16_t count;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <AudioOutput.h>
+
+/**
+ * Forwards the decoded samples to another output, but discards the first ones
+ * which have already been played from the clip cache. Once the skipped samples
+ * are consumed, the samples are held back until the cached head has been played.
+ */
+class AudioOutputHeadSkip : public AudioOutput
+{
+    public:
+        AudioOutputHeadSkip(AudioOutput* sink);
+
+        /** Starts a clip, skipping the given number of frames and holding back the rest until Release(). */
+        void Skip(uint32_t frames);
+        /** Passes all further samples to the sink. */
+        void Release();
+        bool IsReleased() const;
+
+        virtual bool SetRate(int hz) override;
+        virtual bool SetBitsPerSample(int bits) override;
+        virtual bool SetChannels(int channels) override;
+        virtual bool begin() override;
+        virtual bool ConsumeSample(int16_t sample[2]) override;
+        virtual bool stop() override;
+
+    private:
+        AudioOutput* sink;
+        uint32_t framesToSkip;
+        bool released;
+};
@@ -1,24 +1,130 @@
 #pragma once
+#include <atomic>
 #include <FileSystem.h>
 #include <AudioFileSourceFS.h>
-#include <AudioGeneratorMP3.h>
 #include <AudioOutputI2S.h>
+#include <AudioClipCache.h>
+#include <AudioMixer.h>
+#include <AudioMetronome.h>
+#include "util/SpscRing.h"
 
+/** A request to the task owning the audio player. */
+struct AudioCommand
+{
+    enum Type : uint8_t {
+        Play,
+        Stop,
+        SetVolume,
+        Preload
+    };
+
+    Type type;
+    /** The clip to play or preload, must point to static storage */
+    const char* path;
+    /** The volume in percent, or the gain of the voice in percent for Play */
+    uint8_t volume;
+};
+
+/**
+ * Plays MP3 clips via I2S. If a clip has been transcoded by transcode-audio.py,
+ * its .gfa sibling is played instead, which is much cheaper to decode.
+ *
+ * Every clip plays on its own voice of the mixer, so clips and metronome ticks
+ * overlap instead of cutting each other off. Clips whose head is in the clip
+ * cache start playing from RAM instantly.
+ *
+ * All audio is converted to a fixed output rate and written to I2S as one
+ * stream. While the metronome runs, the stream is continuous, so the frames
+ * written are a clock on which the metronome ticks are scheduled.
+ *
+ * The player is owned by a single task, which is the only one allowed to call
+ * Loop() and the playback functions. Exactly one other task may control the
+ * player via the Request*() functions, which never block or take a lock.
+ */
 class AudioPlayer 
 {
     public:
-        AudioPlayer(FileSystem* fileSystem, int bclkPin, int wclkPin, int doutPin);
+        /** The sample rate of the I2S stream, clips are converted to it */
+        static const uint32_t outputRate = 22050;
+
+        AudioPlayer(FileSystem* fileSystem, int bclkPin, int wclkPin, int doutPin, 
+            size_t cacheBudgetBytes = 0, uint16_t cacheHeadMs = 250, size_t metronomeBudgetBytes = 32 * 1024);
         virtual ~AudioPlayer();
-        void PlayMP3(const char* path);
+
+        // Owner task only
+        /** Plays the clip on a free voice with the given gain, the oldest clip is cut off if all voices are busy. */
+        void Play(const char* path, uint8_t gainPercent = 100);
         void SetVolume(uint8_t percent);
+        /** Caches the head of the clip and opens it in advance, so that the next Play() of it starts instantly. */
+        void Preload(const char* path);
+        /** Executes all requested commands, decodes the next part of the clips and fills the I2S buffers. */
         void Loop();
+        /** Stops all clips. */
         void Stop();
+        /** Starts the metronome or changes its clip and tempo, 0 bpm stops it. */
+        void StartMetronome(const char* path, uint16_t bpm);
+        void StopMetronome();
+        /** Sets the gain of the metronome ticks in percent. */
+        void SetMetronomeGain(uint8_t percent);
+        /** Indicates whether the I2S stream has to be refilled periodically. */
+        bool IsStreaming();
+
+        // Controlling task
+        bool RequestPlay(const char* path, uint8_t gainPercent = 100);
+        bool RequestStop();
+        bool RequestVolume(uint8_t percent);
+        bool RequestPreload(const char* path);
+
+        /** Indicates whether a clip is playing or a requested playback has not been started yet. */
         bool IsPlaying();
+
+        /** Provides the number of commands rejected because the command queue was full. */
+        uint32_t GetDroppedCommands() const;
+
+        AudioClipCacheStats GetCacheStats() const;
+        AudioMetronomeStats GetMetronomeStats() const;
+        AudioMixerStats GetMixerStats() const;
     private:
+        void ProcessCommands();
+        /** Provides the path of the transcoded sibling of the clip if there is one, else the clip path. */
+        const char* ResolveClip(const char* path);
+        /** Mixes the clips and the metronome ticks into the I2S stream until its buffers are full. */
+        void Render();
+        void UpdatePlayingState();
+
         FileSystem* fileSystem;
-        AudioFileSource* currentFile;
-        AudioGeneratorMP3* mp3Generator;
+        /** Opened ahead by Preload(), positioned at the beginning of preloadedPath */
+        AudioFileSource* preloadFile;
+        const char* preloadedPath;
         AudioOutputI2S* audioOutput;
+        AudioClipCache clipCache;
+        AudioMixer mixer;
+        AudioMetronome metronome;
+        /** The gain of the metronome ticks in Q15 fixed point */
+        int32_t metronomeGain;
+        /** The frames written to I2S, the clock of the metronome */
+        uint64_t framesWritten;
+        /** The time at which frame 0 is played, assuming that I2S never ran empty */
+        int64_t streamOriginUs;
+        bool outputStarted;
+        bool streamIdle;
+
+        struct ClipPath
+        {
+            const char* path;
+            char resolved[32];
+        };
+        static const uint8_t maxClipPaths = 16;
+        /** Clip paths resolved so far, so that the file system is probed only once per clip */
+        ClipPath clipPaths[maxClipPaths];
+        uint8_t clipPathCount;
         /** The volume in percent */
         uint8_t volumePc;
-};
\ No newline at end of file
+
+        SpscRing<AudioCommand, 8> commands;
+        /** Play requests posted by the controlling task */
+        std::atomic<uint32_t> playRequests;
+        /** Play requests executed by the owner task */
+        std::atomic<uint32_t> playRequestsDone;
+        std::atomic<bool> playing;
+};
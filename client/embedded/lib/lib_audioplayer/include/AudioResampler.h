@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Converts a stream of stereo frames to another sample rate by linear
+ * interpolation in 16.16 fixed point.
+ */
+class AudioResampler
+{
+    public:
+        AudioResampler() : step(1UL << 16), phase(0), primed(false)
+        {
+            previous[0] = 0;
+            previous[1] = 0;
+        }
+
+        void SetRates(uint32_t inputRate, uint32_t outputRate)
+        {
+            step = (inputRate > 0 && outputRate > 0) ? (uint32_t)(((uint64_t)inputRate << 16) / outputRate) : (1UL << 16);
+            if (step == 0)
+            {
+                step = 1;
+            }
+        }
+
+        void Reset()
+        {
+            phase = 0;
+            primed = false;
+        }
+
+        /** The maximum number of frames a single input frame produces. */
+        uint32_t GetMaxOutputFrames() const
+        {
+            return ((1UL << 16) + step - 1) / step;
+        }
+
+        /** Converts one input frame, calling emit(frame) for every output frame. */
+        template<typename Emit>
+        void Push(const int16_t frame[2], Emit emit)
+        {
+            if (!primed)
+            {
+                previous[0] = frame[0];
+                previous[1] = frame[1];
+                primed = true;
+                return;
+            }
+            int16_t output[2];
+            // the phase is reduced to 15 bits, so that the product fits into 32 bits
+            while (phase < (1UL << 16))
+            {
+                output[0] = (int16_t)(previous[0] + (((int32_t)(frame[0] - previous[0]) * (int32_t)(phase >> 1)) >> 15));
+                output[1] = (int16_t)(previous[1] + (((int32_t)(frame[1] - previous[1]) * (int32_t)(phase >> 1)) >> 15));
+                emit(output);
+                phase += step;
+            }
+            phase -= (1UL << 16);
+            previous[0] = frame[0];
+            previous[1] = frame[1];
+        }
+
+    private:
+        /** The input frames per output frame in 16.16 fixed point */
+        uint32_t step;
+        /** The position of the next output frame after the previous input frame in 16.16 fixed point */
+        uint32_t phase;
+        int16_t previous[2];
+        bool primed;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <FileSystem.h>
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioGeneratorGfa.h>
+#include <AudioClipCache.h>
+#include <AudioOutputHeadSkip.h>
+#include <AudioOutputBuffer.h>
+
+/**
+ * One input of the mixer: a clip decoded into its own buffer at the output
+ * rate. A clip with a cached head starts from RAM, while the decoder skips
+ * the cached part and continues seamlessly.
+ */
+class AudioVoice
+{
+    public:
+        AudioVoice(FileSystem* fileSystem, uint32_t outputRate);
+        virtual ~AudioVoice();
+
+        /**
+         * Starts the clip with the given gain in percent. The head may be nullptr.
+         * An opened file replaces the file of the voice, which is handed back closed.
+         *
+         * The voice reads the samples of the head until it continues from the
+         * file or is stopped, and pins the head for that time so that the
+         * cache does not evict it. The cache must outlive the voice.
+         */
+        void Play(const char* path, AudioClipHead* head, uint8_t gainPercent, AudioFileSource** openedFile);
+        void Stop();
+        /** Decodes the clip until the buffer is full. */
+        void Decode();
+        bool IsActive() const;
+
+        bool Peek(int16_t frame[2]) const;
+        void Pop();
+        /** The gain in Q15 fixed point */
+        int32_t GetGain() const;
+        /** Increments with every clip started by any voice, tells which voice plays the oldest clip */
+        uint32_t GetSequence() const;
+
+    private:
+        void PlayHead();
+        /** Continues from the file only, unpinning the head. */
+        void LeaveHead();
+
+        static uint32_t sequenceCounter;
+
+        AudioFileSource* file;
+        AudioGeneratorMP3* mp3Generator;
+        AudioGeneratorGfa* gfaGenerator;
+        /** The generator of the current clip */
+        AudioGenerator* generator;
+        AudioOutputBuffer* buffer;
+        AudioOutputHeadSkip* skipOutput;
+        /** The cached head being played, nullptr if playing from the file */
+        AudioClipHead* head;
+        uint32_t headPosition;
+        int32_t gain;
+        uint32_t sequence;
+};
@@ -0,0 +1,196 @@
+#include <AudioClipCache.h>
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioGeneratorGfa.h>
+#include <esp_heap_caps.h>
+#include "util/Logger.h"
+
+/** Captures the first decoded samples of a clip into a cache entry. */
+class AudioOutputCapture : public AudioOutput
+{
+    public:
+        AudioOutputCapture(AudioClipCache* cache, AudioClipHead* head) : cache(cache), head(head), capacity(0), failed(false)
+        {
+        }
+
+        virtual bool begin() override { return true; }
+        virtual bool stop() override { return true; }
+
+        virtual bool ConsumeSample(int16_t sample[2]) override
+        {
+            if (head->samples == nullptr && !Allocate()) {
+                return false;
+            }
+            if (head->frames >= capacity) {
+                return false;
+            }
+            int16_t* frame = head->samples + head->frames * head->channels;
+            frame[0] = sample[LEFTCHANNEL];
+            if (head->channels > 1) {
+                frame[1] = sample[RIGHTCHANNEL];
+            }
+            head->frames++;
+            return true;
+        }
+
+        bool IsDone() const
+        {
+            return failed || (head->samples != nullptr && head->frames >= capacity);
+        }
+
+    private:
+        bool Allocate()
+        {
+            if (failed) {
+                return false;
+            }
+            // rate and channels are known once the first frame is decoded
+            head->sampleRate = hertz;
+            head->channels = channels > 1 ? 2 : 1;
+            size_t frameBytes = head->channels * sizeof(int16_t);
+            size_t wanted = (size_t)cache->headMs * hertz / 1000 * frameBytes;
+            size_t granted = cache->Reserve(wanted, head) / frameBytes * frameBytes;
+            if (granted > 0) {
+                head->samples = (int16_t*)heap_caps_malloc(granted, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+            if (head->samples == nullptr) {
+                failed = true;
+                return false;
+            }
+            capacity = granted / frameBytes;
+            head->bytes = granted;
+            cache->bytesUsed += granted;
+            return true;
+        }
+
+        AudioClipCache* cache;
+        AudioClipHead* head;
+        uint32_t capacity;
+        bool failed;
+};
+
+AudioClipCache::AudioClipCache(FileSystem* fileSystem, size_t budgetBytes, uint16_t headMs) : 
+    fileSystem(fileSystem), budgetBytes(budgetBytes), headMs(headMs), useCounter(0), hits(0), misses(0), bytesUsed(0), clips(0)
+{
+    memset(heads, 0, sizeof(heads));
+}
+
+AudioClipCache::~AudioClipCache()
+{
+    for (uint8_t i = 0; i < maxClips; i++) {
+        Evict(heads[i]);
+    }
+}
+
+bool AudioClipCache::Load(const char* path)
+{
+    if (budgetBytes == 0) {
+        return false;
+    }
+    AudioClipHead* head = Lookup(path);
+    if (head != nullptr) {
+        head->lastUsed = ++useCounter;
+        return true;
+    }
+    // take a free slot or the least recently used one that no voice is playing
+    for (uint8_t i = 0; i < maxClips; i++) {
+        if (heads[i].path == nullptr) {
+            head = &heads[i];
+            break;
+        }
+        if (heads[i].pins == 0 && (head == nullptr || heads[i].lastUsed < head->lastUsed)) {
+            head = &heads[i];
+        }
+    }
+    if (head == nullptr) {
+        LOG(AudioClipCache, WARN, "Could not cache '%s', all cached clips are playing", path);
+        return false;
+    }
+    Evict(*head);
+    head->path = path;
+    head->lastUsed = ++useCounter;
+
+    AudioFileSourceFS file(*fileSystem->GetInternalFileSystem());
+    AudioGeneratorMP3 mp3Decoder;
+    AudioGeneratorGfa gfaDecoder;
+    AudioGenerator* decoder = AudioGeneratorGfa::IsGfaClip(path) ? (AudioGenerator*)&gfaDecoder : (AudioGenerator*)&mp3Decoder;
+    AudioOutputCapture capture(this, head);
+    if (file.open(path) && decoder->begin(&file, &capture)) {
+        while (decoder->isRunning() && !capture.IsDone() && decoder->loop()) {
+        }
+        decoder->stop();
+    }
+    if (head->frames == 0) {
+        // nothing captured, so the slot is not counted as cached clip
+        Evict(*head);
+        LOG(AudioClipCache, WARN, "Could not cache '%s'", path);
+        return false;
+    }
+    clips++;
+    LOG(AudioClipCache, INFO, "Cached %u ms of '%s' (%u of %u bytes used)", 
+        (unsigned)(head->frames * 1000UL / head->sampleRate), path, (unsigned)bytesUsed.load(), (unsigned)budgetBytes);
+    return true;
+}
+
+AudioClipHead* AudioClipCache::Find(const char* path)
+{
+    AudioClipHead* head = Lookup(path);
+    if (head == nullptr) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    head->lastUsed = ++useCounter;
+    return head;
+}
+
+AudioClipCacheStats AudioClipCache::GetStats() const
+{
+    AudioClipCacheStats stats;
+    stats.hits = hits.load();
+    stats.misses = misses.load();
+    stats.bytesUsed = bytesUsed.load();
+    stats.budgetBytes = budgetBytes;
+    stats.clips = clips.load();
+    return stats;
+}
+
+AudioClipHead* AudioClipCache::Lookup(const char* path)
+{
+    for (uint8_t i = 0; i < maxClips; i++) {
+        if (heads[i].path != nullptr && heads[i].frames > 0 && strcmp(heads[i].path, path) == 0) {
+            return &heads[i];
+        }
+    }
+    return nullptr;
+}
+
+size_t AudioClipCache::Reserve(size_t bytes, const AudioClipHead* keep)
+{
+    while (bytesUsed + bytes > budgetBytes) {
+        AudioClipHead* oldest = nullptr;
+        for (uint8_t i = 0; i < maxClips; i++) {
+            if (&heads[i] != keep && heads[i].samples != nullptr && heads[i].pins == 0 && 
+                (oldest == nullptr || heads[i].lastUsed < oldest->lastUsed)) {
+                oldest = &heads[i];
+            }
+        }
+        if (oldest == nullptr) {
+            break;
+        }
+        Evict(*oldest);
+    }
+    return min(bytes, budgetBytes - bytesUsed);
+}
+
+void AudioClipCache::Evict(AudioClipHead& head)
+{
+    if (head.samples != nullptr) {
+        heap_caps_free(head.samples);
+        bytesUsed -= head.bytes;
+        if (head.frames > 0) {
+            clips--;
+        }
+    }
+    memset(&head, 0, sizeof(head));
+}
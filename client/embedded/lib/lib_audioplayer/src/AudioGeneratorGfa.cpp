@@ -0,0 +1,169 @@
+#include <AudioGeneratorGfa.h>
+
+static const int8_t indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+bool AudioGeneratorGfa::IsGfaClip(const char* path)
+{
+    const char* extension = strrchr(path, '.');
+    return extension != nullptr && strcmp(extension, ".gfa") == 0;
+}
+
+AudioGeneratorGfa::AudioGeneratorGfa() : 
+    codec(codecPcm), samplesLeft(0), samplePending(false), blockLength(0), blockPosition(0), blockEnd(0), predictor(0), stepIndex(0)
+{
+    running = false;
+    file = nullptr;
+    output = nullptr;
+}
+
+AudioGeneratorGfa::~AudioGeneratorGfa()
+{
+    if (running) {
+        stop();
+    }
+}
+
+bool AudioGeneratorGfa::begin(AudioFileSource* source, AudioOutput* output)
+{
+    if (source == nullptr || output == nullptr || !source->isOpen()) {
+        return false;
+    }
+    file = source;
+    this->output = output;
+
+    uint8_t header[headerSize];
+    if (file->read(header, headerSize) != headerSize || memcmp(header, "GFAU", 4) != 0 || header[4] != 1 || header[6] != 1) {
+        return false;
+    }
+    codec = header[5];
+    if (codec != codecPcm && codec != codecImaAdpcm) {
+        return false;
+    }
+    uint32_t sampleRate = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+    samplesLeft = header[12] | (header[13] << 8) | (header[14] << 16) | ((uint32_t)header[15] << 24);
+    samplePending = false;
+    blockPosition = 0;
+    blockEnd = 0;
+
+    output->SetRate(sampleRate);
+    output->SetBitsPerSample(16);
+    output->SetChannels(1);
+    if (!output->begin()) {
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+bool AudioGeneratorGfa::loop()
+{
+    if (running) {
+        // push samples until the output buffer is full
+        while (true) {
+            if (!samplePending) {
+                if (!NextSample(lastSample[AudioOutput::LEFTCHANNEL])) {
+                    running = false;
+                    break;
+                }
+                lastSample[AudioOutput::RIGHTCHANNEL] = lastSample[AudioOutput::LEFTCHANNEL];
+                samplePending = true;
+            }
+            if (!output->ConsumeSample(lastSample)) {
+                break;
+            }
+            samplePending = false;
+        }
+        output->loop();
+    }
+    return running;
+}
+
+bool AudioGeneratorGfa::stop()
+{
+    running = false;
+    samplePending = false;
+    if (output != nullptr) {
+        output->stop();
+    }
+    return file != nullptr ? file->close() : true;
+}
+
+bool AudioGeneratorGfa::isRunning()
+{
+    return running;
+}
+
+bool AudioGeneratorGfa::NextSample(int16_t& sample)
+{
+    if (samplesLeft == 0) {
+        return false;
+    }
+    if (blockPosition >= blockEnd && !ReadBlock()) {
+        return false;
+    }
+    samplesLeft--;
+
+    if (codec == codecPcm) {
+        sample = (int16_t)(block[blockPosition] | (block[blockPosition + 1] << 8));
+        blockPosition += 2;
+        return true;
+    }
+
+    uint8_t nibble = block[blockHeaderSize + (blockPosition >> 1)];
+    nibble = (blockPosition & 1) ? (nibble >> 4) : (nibble & 0x0f);
+    blockPosition++;
+
+    int32_t step = stepTable[stepIndex];
+    int32_t diff = step >> 3;
+    if (nibble & 4) {
+        diff += step;
+    }
+    if (nibble & 2) {
+        diff += step >> 1;
+    }
+    if (nibble & 1) {
+        diff += step >> 2;
+    }
+    predictor += (nibble & 8) ? -diff : diff;
+    if (predictor > 32767) {
+        predictor = 32767;
+    } else if (predictor < -32768) {
+        predictor = -32768;
+    }
+    stepIndex += indexTable[nibble & 7];
+    if (stepIndex < 0) {
+        stepIndex = 0;
+    } else if (stepIndex > 88) {
+        stepIndex = 88;
+    }
+    sample = (int16_t)predictor;
+    return true;
+}
+
+bool AudioGeneratorGfa::ReadBlock()
+{
+    blockLength = file->read(block, blockSize);
+    blockPosition = 0;
+    if (codec == codecPcm) {
+        blockEnd = blockLength & ~1;
+    } else {
+        if (blockLength <= blockHeaderSize) {
+            return false;
+        }
+        // every block starts with the decoder state
+        predictor = (int16_t)(block[0] | (block[1] << 8));
+        stepIndex = block[2] > 88 ? 88 : block[2];
+        blockEnd = (blockLength - blockHeaderSize) * 2;
+    }
+    return blockEnd > 0;
+}
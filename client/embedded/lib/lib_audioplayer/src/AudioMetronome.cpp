@@ -0,0 +1,263 @@
+#include <AudioMetronome.h>
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioGeneratorGfa.h>
+#include <AudioResampler.h>
+#include <esp_heap_caps.h>
+#include "util/Logger.h"
+
+/** Captures a decoded clip as mono samples at the output rate. */
+class AudioOutputTickCapture : public AudioOutput
+{
+    public:
+        AudioOutputTickCapture(int16_t* samples, uint32_t capacity, uint32_t outputRate) : 
+            samples(samples), capacity(capacity), frames(0), outputRate(outputRate), full(false)
+        {
+        }
+
+        virtual bool SetRate(int hz) override
+        {
+            AudioOutput::SetRate(hz);
+            resampler.SetRates(hz, outputRate);
+            return true;
+        }
+
+        virtual bool begin() override { return true; }
+        virtual bool stop() override { return true; }
+
+        virtual bool ConsumeSample(int16_t sample[2]) override
+        {
+            if (frames + resampler.GetMaxOutputFrames() > capacity) {
+                full = true;
+                return false;
+            }
+            int16_t frame[2];
+            frame[0] = channels == 1 ? sample[LEFTCHANNEL] : (int16_t)(((int32_t)sample[LEFTCHANNEL] + sample[RIGHTCHANNEL]) / 2);
+            frame[1] = frame[0];
+            resampler.Push(frame, [this](const int16_t* output) {
+                samples[frames++] = output[0];
+            });
+            return true;
+        }
+
+        /** Continues the capture in a larger buffer that holds the frames captured so far. */
+        void Grow(int16_t* samples, uint32_t capacity)
+        {
+            this->samples = samples;
+            this->capacity = capacity;
+            full = false;
+        }
+
+        uint32_t GetFrames() const { return frames; }
+        bool IsFull() const { return full; }
+
+    private:
+        int16_t* samples;
+        uint32_t capacity;
+        uint32_t frames;
+        uint32_t outputRate;
+        AudioResampler resampler;
+        bool full;
+};
+
+AudioMetronome::AudioMetronome(FileSystem* fileSystem, uint32_t outputRate, size_t budgetBytes) : 
+    fileSystem(fileSystem), outputRate(outputRate), maxClipFrames(budgetBytes / sizeof(int16_t)), growFrames(outputRate / 4), 
+    fadeFrames(outputRate / 200), running(false), bpm(0), intervalFrames(0), nextTickFrame(0), 
+    tick(nullptr), tickPosition(0), tickEnd(0), ticks(0), minLeadUs(0), maxLeadUs(0), lateTicks(0), maxJitterUs(0)
+{
+    memset(&clip, 0, sizeof(clip));
+}
+
+AudioMetronome::~AudioMetronome()
+{
+    Free();
+}
+
+bool AudioMetronome::Load(const char* path, uint32_t capacity)
+{
+    if (clip.path != nullptr && strcmp(clip.path, path) == 0 && (clip.limit == 0 || clip.limit >= capacity)) {
+        return true;
+    }
+    // only one clip is kept in RAM, a clip cut for a faster tempo is decoded again
+    Free();
+
+    // the buffer grows while decoding, so a short tick never takes the whole budget
+    uint32_t size = min(capacity, growFrames);
+    int16_t* samples = (int16_t*)heap_caps_malloc(size * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (samples == nullptr) {
+        LOG(AudioMetronome, WARN, "No RAM to load '%s'", path);
+        return false;
+    }
+    AudioFileSourceFS file(*fileSystem->GetInternalFileSystem());
+    AudioGeneratorMP3 mp3Decoder;
+    AudioGeneratorGfa gfaDecoder;
+    AudioGenerator* decoder = AudioGeneratorGfa::IsGfaClip(path) ? (AudioGenerator*)&gfaDecoder : (AudioGenerator*)&mp3Decoder;
+    AudioOutputTickCapture capture(samples, size, outputRate);
+    if (file.open(path) && decoder->begin(&file, &capture)) {
+        while (decoder->isRunning()) {
+            if (capture.IsFull()) {
+                if (size >= capacity) {
+                    break;
+                }
+                uint32_t grown = min(capacity, size + growFrames);
+                int16_t* larger = (int16_t*)heap_caps_realloc(samples, grown * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+                if (larger == nullptr) {
+                    // keep the part decoded so far, cut like a clip longer than the budget
+                    LOG(AudioMetronome, WARN, "No RAM to load more than %u ms of '%s'", (unsigned)(size * 1000UL / outputRate), path);
+                    break;
+                }
+                samples = larger;
+                size = grown;
+                capture.Grow(samples, size);
+            }
+            if (!decoder->loop()) {
+                break;
+            }
+        }
+        decoder->stop();
+    }
+    uint32_t frames = capture.GetFrames();
+    if (frames == 0) {
+        heap_caps_free(samples);
+        LOG(AudioMetronome, WARN, "Could not load '%s'", path);
+        return false;
+    }
+    if (capture.IsFull()) {
+        // fade out the truncated tick within 5 ms to avoid a click
+        uint32_t fade = min(frames, fadeFrames);
+        for (uint32_t i = 0; i < fade; i++) {
+            int16_t& sample = samples[frames - fade + i];
+            sample = (int16_t)((int32_t)sample * (int32_t)(fade - i) / (int32_t)fade);
+        }
+        clip.limit = capacity;
+    } else if (frames < size) {
+        int16_t* shrunk = (int16_t*)heap_caps_realloc(samples, frames * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (shrunk != nullptr) {
+            samples = shrunk;
+        }
+    }
+    clip.path = path;
+    clip.samples = samples;
+    clip.frames = frames;
+    LOG(AudioMetronome, INFO, "Loaded %u ms of '%s'", (unsigned)(frames * 1000UL / outputRate), path);
+    return true;
+}
+
+void AudioMetronome::Free()
+{
+    tick = nullptr;
+    if (clip.samples != nullptr) {
+        heap_caps_free(clip.samples);
+    }
+    memset(&clip, 0, sizeof(clip));
+}
+
+void AudioMetronome::Start(const char* path, uint16_t bpm, uint64_t frame)
+{
+    if (bpm == 0) {
+        Stop();
+        return;
+    }
+    if (running && bpm == this->bpm && strcmp(clip.path, path) == 0) {
+        return;
+    }
+    uint32_t interval = (uint32_t)((uint64_t)outputRate * 60 / bpm);
+    if (!Load(path, GetCapacity(interval))) {
+        Stop();
+        return;
+    }
+    if (!running) {
+        nextTickFrame = frame;
+    } else if (interval != intervalFrames) {
+        // keep the beat, the next tick follows the previous one with the new interval
+        nextTickFrame = nextTickFrame - intervalFrames + interval;
+        if (nextTickFrame < frame) {
+            nextTickFrame = frame;
+        }
+    }
+    running = true;
+    this->bpm = bpm;
+    intervalFrames = interval;
+}
+
+void AudioMetronome::Stop()
+{
+    running = false;
+    Free();
+}
+
+bool AudioMetronome::IsRunning() const
+{
+    return running;
+}
+
+bool AudioMetronome::IsDue(uint64_t frame) const
+{
+    return running && frame >= nextTickFrame;
+}
+
+void AudioMetronome::Trigger(uint64_t frame, int32_t leadUs)
+{
+    tick = &clip;
+    tickPosition = 0;
+    tickEnd = min(tick->frames, intervalFrames);
+    uint32_t count = ++ticks;
+    if (count == 1 || leadUs < minLeadUs) {
+        minLeadUs = leadUs;
+    }
+    if (count == 1 || leadUs > maxLeadUs) {
+        maxLeadUs = leadUs;
+    }
+    if (leadUs < 0) {
+        // the output ran empty, so the tick is played late
+        lateTicks++;
+        if ((uint32_t)-leadUs > maxJitterUs) {
+            maxJitterUs = (uint32_t)-leadUs;
+        }
+        LOG(AudioMetronome, WARN, "Tick played %ld us late", (long)-leadUs);
+    }
+    if (count % 32 == 0) {
+        LOG_EXTRA(AudioMetronome, INFO, "%u ticks, lead %ld..%ld us, %u late, max jitter %u us", 
+            (unsigned)count, (long)minLeadUs.load(), (long)maxLeadUs.load(), (unsigned)lateTicks.load(), (unsigned)maxJitterUs.load());
+    }
+    while (nextTickFrame <= frame) {
+        nextTickFrame += intervalFrames;
+    }
+}
+
+bool AudioMetronome::Peek(int16_t& sample) const
+{
+    if (tick == nullptr) {
+        return false;
+    }
+    sample = tick->samples[tickPosition];
+    uint32_t left = tickEnd - tickPosition;
+    if (tickEnd < tick->frames && left < fadeFrames) {
+        // the next tick is due, fade out within 5 ms to avoid a click
+        sample = (int16_t)((int32_t)sample * (int32_t)left / (int32_t)fadeFrames);
+    }
+    return true;
+}
+
+void AudioMetronome::Advance()
+{
+    if (tick != nullptr && ++tickPosition >= tickEnd) {
+        tick = nullptr;
+    }
+}
+
+AudioMetronomeStats AudioMetronome::GetStats() const
+{
+    AudioMetronomeStats stats;
+    stats.ticks = ticks.load();
+    stats.minLeadUs = minLeadUs.load();
+    stats.maxLeadUs = maxLeadUs.load();
+    stats.lateTicks = lateTicks.load();
+    stats.maxJitterUs = maxJitterUs.load();
+    return stats;
+}
+
+uint32_t AudioMetronome::GetCapacity(uint32_t interval) const
+{
+    return interval > 0 ? min(interval, maxClipFrames) : maxClipFrames;
+}
@@ -0,0 +1,133 @@
+#include <AudioMixer.h>
+#include "util/Logger.h"
+
+AudioMixer::AudioMixer(FileSystem* fileSystem, uint32_t outputRate) : 
+    outputRate(outputRate), decodeCycles(0), mixCycles(0), mixedFrames(0), mixedVoiceFrames(0), peakVoices(0),
+    decodeCyclesPerSecond(0), mixCyclesPerSecond(0), mixCyclesPerVoiceSecond(0), lastPeakVoices(0)
+{
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        voices[i] = new AudioVoice(fileSystem, outputRate);
+        peeked[i] = false;
+    }
+}
+
+AudioMixer::~AudioMixer()
+{
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        delete voices[i];
+    }
+}
+
+AudioVoice& AudioMixer::Allocate()
+{
+    AudioVoice* oldest = voices[0];
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        if (!voices[i]->IsActive()) {
+            return *voices[i];
+        }
+        if (voices[i]->GetSequence() < oldest->GetSequence()) {
+            oldest = voices[i];
+        }
+    }
+    return *oldest;
+}
+
+void AudioMixer::Stop()
+{
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        voices[i]->Stop();
+    }
+}
+
+bool AudioMixer::IsActive() const
+{
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        if (voices[i]->IsActive()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioMixer::Decode()
+{
+    uint32_t start = ESP.getCycleCount();
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        voices[i]->Decode();
+    }
+    decodeCycles += (uint32_t)(ESP.getCycleCount() - start);
+}
+
+uint8_t AudioMixer::Peek(int32_t sum[2])
+{
+    uint8_t count = 0;
+    int16_t frame[2];
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        peeked[i] = voices[i]->Peek(frame);
+        if (peeked[i]) {
+            int32_t gain = voices[i]->GetGain();
+            sum[0] += ((int32_t)frame[0] * gain) >> 15;
+            sum[1] += ((int32_t)frame[1] * gain) >> 15;
+            count++;
+        }
+    }
+    return count;
+}
+
+void AudioMixer::Pop()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < maxVoices; i++) {
+        if (peeked[i]) {
+            voices[i]->Pop();
+            peeked[i] = false;
+            count++;
+        }
+    }
+    mixedVoiceFrames += count;
+    if (count > peakVoices) {
+        peakVoices = count;
+    }
+}
+
+void AudioMixer::AccountMix(uint32_t cycles, uint32_t frames)
+{
+    mixCycles += cycles;
+    mixedFrames += frames;
+    if (mixedFrames >= outputRate) {
+        // publish the cycles per second of audio
+        decodeCyclesPerSecond = (uint32_t)(decodeCycles * outputRate / mixedFrames);
+        mixCyclesPerSecond = (uint32_t)(mixCycles * outputRate / mixedFrames);
+        mixCyclesPerVoiceSecond = mixedVoiceFrames > 0 ? (uint32_t)(mixCycles * outputRate / mixedVoiceFrames) : 0;
+        lastPeakVoices = peakVoices;
+        LOG_EXTRA(AudioMixer, INFO, "Decoding %u, mixing %u cycles per second of audio (%u per voice, up to %u voices)", 
+            (unsigned)decodeCyclesPerSecond.load(), (unsigned)mixCyclesPerSecond.load(), (unsigned)mixCyclesPerVoiceSecond.load(), (unsigned)peakVoices);
+        decodeCycles = 0;
+        mixCycles = 0;
+        mixedFrames = 0;
+        mixedVoiceFrames = 0;
+        peakVoices = 0;
+    }
+}
+
+int16_t AudioMixer::Saturate(int32_t sample)
+{
+    if (sample > 32767) {
+        return 32767;
+    }
+    if (sample < -32768) {
+        return -32768;
+    }
+    return (int16_t)sample;
+}
+
+AudioMixerStats AudioMixer::GetStats() const
+{
+    AudioMixerStats stats;
+    stats.decodeCyclesPerSecond = decodeCyclesPerSecond.load();
+    stats.mixCyclesPerSecond = mixCyclesPerSecond.load();
+    stats.mixCyclesPerVoiceSecond = mixCyclesPerVoiceSecond.load();
+    stats.peakVoices = lastPeakVoices.load();
+    stats.maxVoices = maxVoices;
+    return stats;
+}
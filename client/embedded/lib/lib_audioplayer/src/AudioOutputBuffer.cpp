@@ -0,0 +1,72 @@
+#include <AudioOutputBuffer.h>
+
+AudioOutputBuffer::AudioOutputBuffer(uint32_t outputRate) : outputRate(outputRate), readIndex(0), count(0)
+{
+    hertz = outputRate;
+    channels = 2;
+}
+
+bool AudioOutputBuffer::SetRate(int hz)
+{
+    AudioOutput::SetRate(hz);
+    resampler.SetRates(hz, outputRate);
+    return true;
+}
+
+bool AudioOutputBuffer::begin()
+{
+    return true;
+}
+
+bool AudioOutputBuffer::ConsumeSample(int16_t sample[2])
+{
+    if ((uint32_t)(capacity - count) < resampler.GetMaxOutputFrames()) {
+        return false;
+    }
+    int16_t frame[2];
+    frame[0] = sample[LEFTCHANNEL];
+    frame[1] = channels == 1 ? sample[LEFTCHANNEL] : sample[RIGHTCHANNEL];
+    resampler.Push(frame, [this](const int16_t* output) {
+        uint16_t writeIndex = (readIndex + count) % capacity;
+        frames[writeIndex][0] = output[0];
+        frames[writeIndex][1] = output[1];
+        count++;
+    });
+    return true;
+}
+
+bool AudioOutputBuffer::stop()
+{
+    Clear();
+    return true;
+}
+
+bool AudioOutputBuffer::Peek(int16_t frame[2]) const
+{
+    if (count == 0) {
+        return false;
+    }
+    frame[0] = frames[readIndex][0];
+    frame[1] = frames[readIndex][1];
+    return true;
+}
+
+void AudioOutputBuffer::Pop()
+{
+    if (count > 0) {
+        readIndex = (readIndex + 1) % capacity;
+        count--;
+    }
+}
+
+uint16_t AudioOutputBuffer::Available() const
+{
+    return count;
+}
+
+void AudioOutputBuffer::Clear()
+{
+    readIndex = 0;
+    count = 0;
+    resampler.Reset();
+}
@@ -0,0 +1,60 @@
+#include <AudioOutputHeadSkip.h>
+
+AudioOutputHeadSkip::AudioOutputHeadSkip(AudioOutput* sink) : sink(sink), framesToSkip(0), released(true)
+{
+}
+
+void AudioOutputHeadSkip::Skip(uint32_t frames)
+{
+    framesToSkip = frames;
+    released = (frames == 0);
+}
+
+void AudioOutputHeadSkip::Release()
+{
+    released = true;
+}
+
+bool AudioOutputHeadSkip::IsReleased() const
+{
+    return released;
+}
+
+bool AudioOutputHeadSkip::SetRate(int hz)
+{
+    AudioOutput::SetRate(hz);
+    return sink->SetRate(hz);
+}
+
+bool AudioOutputHeadSkip::SetBitsPerSample(int bits)
+{
+    AudioOutput::SetBitsPerSample(bits);
+    return sink->SetBitsPerSample(bits);
+}
+
+bool AudioOutputHeadSkip::SetChannels(int channels)
+{
+    AudioOutput::SetChannels(channels);
+    return sink->SetChannels(channels);
+}
+
+bool AudioOutputHeadSkip::begin()
+{
+    return sink->begin();
+}
+
+bool AudioOutputHeadSkip::ConsumeSample(int16_t sample[2])
+{
+    if (framesToSkip > 0) {
+        framesToSkip--;
+        return true;
+    }
+    // hold the sample back until the cached head has been played
+    return released && sink->ConsumeSample(sample);
+}
+
+bool AudioOutputHeadSkip::stop()
+{
+    // a clip shorter than its cached head must not cut off the head
+    return released ? sink->stop() : true;
+}
@@ -1,11 +1,15 @@
 #include <AudioPlayer.h>
+#include <esp_timer.h>
 #include "util/Logger.h"
 
-AudioPlayer::AudioPlayer(FileSystem* fileSystem, int bclkPin, int wclkPin, int doutPin) : volumePc(0)
+AudioPlayer::AudioPlayer(FileSystem* fileSystem, int bclkPin, int wclkPin, int doutPin, size_t cacheBudgetBytes, uint16_t cacheHeadMs,
+    size_t metronomeBudgetBytes) : 
+    preloadedPath(nullptr), clipCache(fileSystem, cacheBudgetBytes, cacheHeadMs), mixer(fileSystem, outputRate), 
+    metronome(fileSystem, outputRate, metronomeBudgetBytes), metronomeGain(32767), framesWritten(0), streamOriginUs(0), outputStarted(false), streamIdle(true), 
+    clipPathCount(0), volumePc(0), playRequests(0), playRequestsDone(0), playing(false)
 {
     this->fileSystem = fileSystem;
-    currentFile = new AudioFileSourceFS(*fileSystem->GetInternalFileSystem());
-    mp3Generator = new AudioGeneratorMP3();
+    preloadFile = new AudioFileSourceFS(*fileSystem->GetInternalFileSystem());
     audioOutput = new AudioOutputI2S();
     audioOutput->SetPinout(bclkPin, wclkPin, doutPin);
     SetVolume(50);
@@ -13,16 +17,37 @@ AudioPlayer::AudioPlayer(FileSystem* fileSystem, int bclkPin, int wclkPin, int d
 
 AudioPlayer::~AudioPlayer() 
 {
-    delete currentFile;
-    delete mp3Generator;
+    delete preloadFile;
     delete audioOutput;
 }
 
-void AudioPlayer::PlayMP3(const char* path)
+void AudioPlayer::Play(const char* path, uint8_t gainPercent)
 {
-    Stop();
-    currentFile->open(path);
-    mp3Generator->begin(currentFile, audioOutput);
+    path = ResolveClip(path);
+    AudioClipHead* head = clipCache.Find(path);
+    AudioClipCacheStats stats = clipCache.GetStats();
+    LOG_EXTRA(AudioPlayer, INFO, "Playing '%s' from %s (cache hits: %u, misses: %u)", 
+        path, head != nullptr ? "RAM" : "file", (unsigned)stats.hits, (unsigned)stats.misses);
+    // the preloaded file is already open and positioned at its beginning
+    bool preloaded = (preloadedPath != nullptr && strcmp(preloadedPath, path) == 0);
+    mixer.Allocate().Play(path, head, gainPercent, preloaded ? &preloadFile : nullptr);
+    if (preloaded) {
+        preloadedPath = nullptr;
+    }
+    if (head != nullptr) {
+        // start from RAM before the decoder has produced anything
+        Render();
+    }
+    UpdatePlayingState();
+}
+
+void AudioPlayer::Preload(const char* path)
+{
+    path = ResolveClip(path);
+    clipCache.Load(path);
+    if (preloadedPath == nullptr || strcmp(preloadedPath, path) != 0) {
+        preloadedPath = preloadFile->open(path) ? path : nullptr;
+    }
 }
 
 void AudioPlayer::SetVolume(uint8_t percent) 
@@ -38,26 +63,208 @@ void AudioPlayer::SetVolume(uint8_t percent)
         // calculate the gain for the player
         float gain = (gainPc / base) - epsilon;
         
-        Logger::log("AudioPlayer", Logger::LogLevel::INFO, "%4.3f: setting audio gain to '%.3f'", millis() / 1000.0, gain);
+        LOG(AudioPlayer, INFO, "%4.3f: setting audio gain to '%.3f'", millis() / 1000.0, gain);
         audioOutput->SetGain(gain);
     }
 }
 
 void AudioPlayer::Loop() 
 {
-    if(mp3Generator->isRunning() && !mp3Generator->loop()) {
-        mp3Generator->stop();
-    }
+    ProcessCommands();
+    mixer.Decode();
+    Render();
+    // refill the voice buffers drained by Render()
+    mixer.Decode();
+    UpdatePlayingState();
 }
 
 void AudioPlayer::Stop() 
 {
-    if(IsPlaying()) {
-        mp3Generator->stop();
+    mixer.Stop();
+    UpdatePlayingState();
+}
+
+void AudioPlayer::StartMetronome(const char* path, uint16_t bpm)
+{
+    metronome.Start(ResolveClip(path), bpm, framesWritten);
+}
+
+void AudioPlayer::StopMetronome()
+{
+    metronome.Stop();
+}
+
+void AudioPlayer::SetMetronomeGain(uint8_t percent)
+{
+    metronomeGain = (int32_t)(percent > 100 ? 100 : percent) * 32767 / 100;
+}
+
+bool AudioPlayer::IsStreaming()
+{
+    return metronome.IsRunning() || mixer.IsActive();
+}
+
+void AudioPlayer::Render()
+{
+    if (!outputStarted) {
+        audioOutput->SetRate(outputRate);
+        audioOutput->SetChannels(2);
+        audioOutput->SetBitsPerSample(16);
+        outputStarted = audioOutput->begin();
+    }
+    uint32_t start = ESP.getCycleCount();
+    uint32_t frames = 0;
+    int32_t sum[2];
+    int16_t frame[2];
+    while (true) {
+        sum[0] = 0;
+        sum[1] = 0;
+        uint8_t voices = mixer.Peek(sum);
+        if (streamIdle) {
+            if (voices == 0 && !metronome.IsRunning()) {
+                break;
+            }
+            // the I2S buffers ran empty while idle, so the next frame is played right away
+            streamIdle = false;
+            streamOriginUs = esp_timer_get_time() - (int64_t)(framesWritten * 1000000ULL / outputRate);
+        }
+        if (metronome.IsDue(framesWritten)) {
+            int64_t playUs = streamOriginUs + (int64_t)(framesWritten * 1000000ULL / outputRate);
+            int32_t leadUs = (int32_t)(playUs - esp_timer_get_time());
+            if (leadUs < 0) {
+                // the output ran empty, all following frames are played later
+                streamOriginUs -= leadUs;
+            }
+            metronome.Trigger(framesWritten, leadUs);
+        }
+        int16_t tickSample;
+        bool tickFrame = metronome.Peek(tickSample);
+        if (tickFrame) {
+            int32_t tick = ((int32_t)tickSample * metronomeGain) >> 15;
+            sum[0] += tick;
+            sum[1] += tick;
+        } else if (voices == 0 && !metronome.IsRunning()) {
+            streamIdle = true;
+            break;
+        }
+        // the stream stays continuous between the ticks
+        frame[AudioOutput::LEFTCHANNEL] = AudioMixer::Saturate(sum[0]);
+        frame[AudioOutput::RIGHTCHANNEL] = AudioMixer::Saturate(sum[1]);
+        if (!audioOutput->ConsumeSample(frame)) {
+            break;
+        }
+        mixer.Pop();
+        if (tickFrame) {
+            metronome.Advance();
+        }
+        framesWritten++;
+        frames++;
+    }
+    mixer.AccountMix((uint32_t)(ESP.getCycleCount() - start), frames);
+}
+
+const char* AudioPlayer::ResolveClip(const char* path)
+{
+    for (uint8_t i = 0; i < clipPathCount; i++) {
+        if (strcmp(clipPaths[i].path, path) == 0) {
+            return clipPaths[i].resolved;
+        }
+    }
+    if (clipPathCount >= maxClipPaths) {
+        return path;
+    }
+    ClipPath& clipPath = clipPaths[clipPathCount++];
+    clipPath.path = path;
+    strlcpy(clipPath.resolved, path, sizeof(clipPath.resolved));
+    const char* extension = strrchr(path, '.');
+    if (extension != nullptr && strcmp(extension, ".mp3") == 0 && strlen(path) < sizeof(clipPath.resolved)) {
+        strcpy(clipPath.resolved + (extension - path), ".gfa");
+        if (!fileSystem->FileExists(clipPath.resolved)) {
+            strlcpy(clipPath.resolved, path, sizeof(clipPath.resolved));
+        }
+    }
+    return clipPath.resolved;
+}
+
+void AudioPlayer::ProcessCommands()
+{
+    AudioCommand command;
+    while (commands.Pop(command)) {
+        switch (command.type) {
+            case AudioCommand::Play:
+                Play(command.path, command.volume);
+                playRequestsDone.fetch_add(1, std::memory_order_release);
+                break;
+            case AudioCommand::Stop:
+                Stop();
+                break;
+            case AudioCommand::SetVolume:
+                SetVolume(command.volume);
+                break;
+            case AudioCommand::Preload:
+                Preload(command.path);
+                break;
+        }
+    }
+}
+
+void AudioPlayer::UpdatePlayingState()
+{
+    playing.store(mixer.IsActive(), std::memory_order_release);
+}
+
+bool AudioPlayer::RequestPlay(const char* path, uint8_t gainPercent)
+{
+    AudioCommand command = { AudioCommand::Play, path, gainPercent };
+    // count the request before publishing it, so that IsPlaying() never misses it
+    playRequests.fetch_add(1, std::memory_order_release);
+    if (!commands.Push(command)) {
+        playRequests.fetch_sub(1, std::memory_order_release);
+        return false;
     }
+    return true;
+}
+
+bool AudioPlayer::RequestStop()
+{
+    AudioCommand command = { AudioCommand::Stop, nullptr, 0 };
+    return commands.Push(command);
+}
+
+bool AudioPlayer::RequestVolume(uint8_t percent)
+{
+    AudioCommand command = { AudioCommand::SetVolume, nullptr, percent };
+    return commands.Push(command);
+}
+
+bool AudioPlayer::RequestPreload(const char* path)
+{
+    AudioCommand command = { AudioCommand::Preload, path, 0 };
+    return commands.Push(command);
 }
 
 bool AudioPlayer::IsPlaying() 
 {
-    return mp3Generator->isRunning();
-}
\ No newline at end of file
+    return playing.load(std::memory_order_acquire) 
+        || playRequests.load(std::memory_order_acquire) != playRequestsDone.load(std::memory_order_acquire);
+}
+
+uint32_t AudioPlayer::GetDroppedCommands() const
+{
+    return commands.GetDropped();
+}
+
+AudioClipCacheStats AudioPlayer::GetCacheStats() const
+{
+    return clipCache.GetStats();
+}
+
+AudioMetronomeStats AudioPlayer::GetMetronomeStats() const
+{
+    return metronome.GetStats();
+}
+
+AudioMixerStats AudioPlayer::GetMixerStats() const
+{
+    return mixer.GetStats();
+}
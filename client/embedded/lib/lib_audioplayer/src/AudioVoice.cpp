@@ -0,0 +1,119 @@
+#include <AudioVoice.h>
+
+uint32_t AudioVoice::sequenceCounter = 0;
+
+AudioVoice::AudioVoice(FileSystem* fileSystem, uint32_t outputRate) : head(nullptr), headPosition(0), gain(32767), sequence(0)
+{
+    file = new AudioFileSourceFS(*fileSystem->GetInternalFileSystem());
+    mp3Generator = new AudioGeneratorMP3();
+    gfaGenerator = new AudioGeneratorGfa();
+    generator = mp3Generator;
+    buffer = new AudioOutputBuffer(outputRate);
+    skipOutput = new AudioOutputHeadSkip(buffer);
+}
+
+AudioVoice::~AudioVoice()
+{
+    Stop();
+    delete skipOutput;
+    delete buffer;
+    delete mp3Generator;
+    delete gfaGenerator;
+    delete file;
+}
+
+void AudioVoice::Play(const char* path, AudioClipHead* head, uint8_t gainPercent, AudioFileSource** openedFile)
+{
+    Stop();
+    gain = (int32_t)(gainPercent > 100 ? 100 : gainPercent) * 32767 / 100;
+    sequence = ++sequenceCounter;
+    this->head = head;
+    headPosition = 0;
+    if (head != nullptr) {
+        head->pins++;
+        buffer->SetRate(head->sampleRate);
+        buffer->SetChannels(head->channels);
+        skipOutput->Skip(head->frames);
+        PlayHead();
+    } else {
+        skipOutput->Skip(0);
+    }
+    if (openedFile != nullptr) {
+        AudioFileSource* closedFile = file;
+        file = *openedFile;
+        *openedFile = closedFile;
+    } else {
+        file->open(path);
+    }
+    generator = AudioGeneratorGfa::IsGfaClip(path) ? (AudioGenerator*)gfaGenerator : (AudioGenerator*)mp3Generator;
+    generator->begin(file, skipOutput);
+}
+
+void AudioVoice::Stop()
+{
+    LeaveHead();
+    if (generator->isRunning()) {
+        generator->stop();
+    }
+    buffer->Clear();
+}
+
+void AudioVoice::Decode()
+{
+    if (head != nullptr) {
+        PlayHead();
+    }
+    if (generator->isRunning() && !generator->loop()) {
+        generator->stop();
+    }
+}
+
+bool AudioVoice::IsActive() const
+{
+    return head != nullptr || generator->isRunning() || buffer->Available() > 0;
+}
+
+bool AudioVoice::Peek(int16_t frame[2]) const
+{
+    return buffer->Peek(frame);
+}
+
+void AudioVoice::Pop()
+{
+    buffer->Pop();
+}
+
+int32_t AudioVoice::GetGain() const
+{
+    return gain;
+}
+
+uint32_t AudioVoice::GetSequence() const
+{
+    return sequence;
+}
+
+void AudioVoice::PlayHead()
+{
+    int16_t sample[2];
+    while (headPosition < head->frames) {
+        const int16_t* frame = head->samples + headPosition * head->channels;
+        sample[AudioOutput::LEFTCHANNEL] = frame[0];
+        sample[AudioOutput::RIGHTCHANNEL] = head->channels > 1 ? frame[1] : frame[0];
+        if (!buffer->ConsumeSample(sample)) {
+            return;
+        }
+        headPosition++;
+    }
+    // the decoder continues right after the cached samples
+    LeaveHead();
+}
+
+void AudioVoice::LeaveHead()
+{
+    if (head != nullptr) {
+        head->pins--;
+        head = nullptr;
+    }
+    skipOutput->Release();
+}
@@ -0,0 +1,69 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "Wire.h"
+
+#define VL53L0X_I2C_ADDR 0x29
+
+typedef struct {
+    uint32_t TimeStamp;
+    uint32_t MeasurementTimeUsec;
+    uint16_t RangeMilliMeter;
+    uint16_t RangeDMaxMilliMeter;
+    uint32_t SignalRateRtnMegaCps;
+    uint32_t AmbientRateRtnMegaCps;
+    uint16_t EffectiveSpadRtnCount;
+    uint8_t ZoneId;
+    uint8_t RangeFractionalPart;
+    uint8_t RangeStatus;
+} VL53L0X_RangingMeasurementData_t;
+
+/**
+ * The ToF sensor of the simulated board, measuring the distance set with
+ * NativeBoard::SetDistance(). A measurement takes the 30 ms of the default
+ * timing budget; in continuous mode one completes every period, at least
+ * every timing budget.
+ */
+class Adafruit_VL53L0X
+{
+    public:
+        /** The range the sensor reports out of range */
+        static const uint16_t outOfRange = 0xffff;
+        /** The time a measurement takes with the default timing budget */
+        static const unsigned long timingBudgetUs = 30000;
+
+        Adafruit_VL53L0X() : wire(nullptr), continuous(false), periodUs(0), startUs(0) {}
+
+        bool begin(uint8_t address = VL53L0X_I2C_ADDR, bool debug = false, TwoWire* i2c = &Wire);
+        /** Measures once, blocking for a timing budget. */
+        void rangingTest(VL53L0X_RangingMeasurementData_t* data, bool debug = false);
+
+        bool startRangeContinuous(uint16_t periodMs = 50);
+        void stopRangeContinuous();
+        bool isRangeComplete();
+        /** The latest range in millimeters, 0xffff out of range; starts the next measurement. */
+        uint16_t readRangeResult();
+
+    private:
+        TwoWire* wire;
+        bool continuous;
+        unsigned long periodUs;
+        /** The time (micros()) the current measurement started */
+        unsigned long startUs;
+};
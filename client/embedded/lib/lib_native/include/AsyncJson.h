@@ -0,0 +1,57 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include "ESPAsyncWebServer.h"
+
+/** A response holding a JSON document, serialized when the length is set */
+class AsyncJsonResponse : public AsyncWebServerResponse
+{
+    public:
+        AsyncJsonResponse(bool isArray = false) : AsyncWebServerResponse(200, "application/json")
+        {
+            if (isArray) {
+                root = document.to<JsonArray>();
+            } else {
+                root = document.to<JsonObject>();
+            }
+        }
+
+        JsonVariant& getRoot() { return root; }
+
+        size_t setLength()
+        {
+            json.clear();
+            serializeJson(document, json);
+            contentLength = json.length();
+            return contentLength;
+        }
+
+    protected:
+        virtual size_t Fill(uint8_t* buffer, size_t maxLen, size_t index) override
+        {
+            size_t count = index < json.length() ? min(maxLen, json.length() - index) : 0;
+            memcpy(buffer, json.data() + index, count);
+            return count;
+        }
+
+    private:
+        JsonDocument document;
+        JsonVariant root;
+        std::string json;
+};
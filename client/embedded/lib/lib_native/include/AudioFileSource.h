@@ -0,0 +1,35 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class AudioFileSource
+{
+    public:
+        AudioFileSource() {}
+        virtual ~AudioFileSource() {}
+        virtual bool open(const char* filename) { return false; }
+        virtual uint32_t read(void* data, uint32_t len) { return 0; }
+        virtual uint32_t readNonBlock(void* data, uint32_t len) { return read(data, len); }
+        virtual bool seek(int32_t pos, int dir) { return false; }
+        virtual bool close() { return false; }
+        virtual bool isOpen() { return false; }
+        virtual uint32_t getSize() { return 0; }
+        virtual uint32_t getPos() { return 0; }
+        virtual bool loop() { return true; }
+};
@@ -0,0 +1,41 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include "AudioFileSource.h"
+#include "FS.h"
+
+/** Reads a clip from a file system, like its namesake of ESP8266Audio. */
+class AudioFileSourceFS : public AudioFileSource
+{
+    public:
+        AudioFileSourceFS(fs::FS& fileSystem) : fileSystem(&fileSystem) {}
+        AudioFileSourceFS(fs::FS& fileSystem, const char* filename) : fileSystem(&fileSystem) { open(filename); }
+        virtual ~AudioFileSourceFS() override { close(); }
+
+        virtual bool open(const char* filename) override;
+        virtual uint32_t read(void* data, uint32_t len) override;
+        virtual bool seek(int32_t pos, int dir) override;
+        virtual bool close() override;
+        virtual bool isOpen() override;
+        virtual uint32_t getSize() override;
+        virtual uint32_t getPos() override;
+
+    private:
+        fs::FS* fileSystem;
+        fs::File file;
+};
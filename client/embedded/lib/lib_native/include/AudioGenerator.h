@@ -0,0 +1,37 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include "AudioFileSource.h"
+#include "AudioOutput.h"
+
+class AudioGenerator
+{
+    public:
+        AudioGenerator() : running(false), file(nullptr), output(nullptr) { lastSample[0] = 0; lastSample[1] = 0; }
+        virtual ~AudioGenerator() {}
+        virtual bool begin(AudioFileSource* source, AudioOutput* output) { return false; }
+        virtual bool loop() { return false; }
+        virtual bool stop() { return false; }
+        virtual bool isRunning() { return false; }
+
+    protected:
+        bool running;
+        AudioFileSource* file;
+        AudioOutput* output;
+        int16_t lastSample[2];
+};
@@ -0,0 +1,33 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include "AudioGenerator.h"
+
+/**
+ * The native environment has no MP3 decoder, so every clip fails to start
+ * and the firmware falls back to its handling of an unreadable clip. Clips
+ * transcoded by transcode-audio.py play through AudioGeneratorGfa as usual.
+ */
+class AudioGeneratorMP3 : public AudioGenerator
+{
+    public:
+        virtual bool begin(AudioFileSource* source, AudioOutput* output) override;
+        virtual bool loop() override;
+        virtual bool stop() override;
+        virtual bool isRunning() override;
+};
@@ -0,0 +1,48 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class AudioOutput
+{
+    public:
+        enum { LEFTCHANNEL = 0, RIGHTCHANNEL = 1 };
+
+        AudioOutput() : hertz(44100), bps(16), channels(2), gainF2P6(1 << 6) {}
+        virtual ~AudioOutput() {}
+
+        virtual bool SetRate(int hz) { hertz = hz; return true; }
+        virtual bool SetBitsPerSample(int bits) { bps = bits; return true; }
+        virtual bool SetChannels(int chan) { channels = chan; return true; }
+        /** The gain in 2.6 fixed point, like ESP8266Audio */
+        virtual bool SetGain(float f) { gainF2P6 = (uint8_t)(constrain(f, 0.0f, 3.98f) * (1 << 6)); return true; }
+        virtual bool begin() { return false; }
+        virtual bool ConsumeSample(int16_t sample[2]) = 0;
+        virtual uint16_t ConsumeSamples(int16_t* samples, uint16_t count);
+        virtual bool stop() { return false; }
+        virtual void flush() {}
+        virtual bool loop() { return true; }
+
+    protected:
+        int16_t Amplify(int16_t sample);
+
+        int hertz;
+        int bps;
+        int channels;
+        uint8_t gainF2P6;
+};
@@ -0,0 +1,56 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include "AudioOutput.h"
+#include <stdio.h>
+
+/**
+ * The I2S output of the simulated board. Like the DMA buffers of the driver,
+ * it takes up to dmaBufferCount * dmaBufferFrames frames ahead of the playback
+ * and plays them at the sample rate in real time, so the firmware refills it
+ * at the pace of the board. If $GOALFINDER_I2S_OUT names a file, the frames
+ * are appended to it as raw 16 bit PCM, once they are played.
+ */
+class AudioOutputI2S : public AudioOutput
+{
+    public:
+        static const uint32_t dmaBufferCount = 8;
+        static const uint32_t dmaBufferFrames = 64;
+
+        AudioOutputI2S(int port = 0, int outputMode = 0, int dmaBufferCount = 8, int useApll = 0);
+        virtual ~AudioOutputI2S() override;
+
+        bool SetPinout(int bclkPin, int wclkPin, int doutPin) { return true; }
+        virtual bool begin() override;
+        virtual bool ConsumeSample(int16_t sample[2]) override;
+        virtual bool stop() override;
+
+    private:
+        /** Removes the frames played since the last call from the buffers. */
+        void Drain();
+
+        bool started;
+        int16_t frames[dmaBufferCount * dmaBufferFrames][2];
+        uint32_t readIndex;
+        uint32_t count;
+        /** The time (micros()) up to which the buffered frames have been played */
+        unsigned long playedUs;
+        /** The part of a frame played before playedUs, in frames * 1000000 */
+        uint64_t playedRemainder;
+        FILE* pcm;
+};
@@ -0,0 +1,30 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "WString.h"
+#include "IPAddress.h"
+
+/** The captive portal's DNS server answers nothing, the host resolves its own names */
+class DNSServer
+{
+    public:
+        bool start(uint16_t port, const String& domainName, const IPAddress& resolvedIP) { return true; }
+        void stop() {}
+        void processNextRequest() {}
+};
@@ -0,0 +1,311 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+/*
+ * The web server of ESPAsyncWebServer without a network: the firmware
+ * registers its handlers as on the board, and a request built in the same
+ * process is routed to them by AsyncWebServer::handle(). The response is
+ * rendered in full into the request, where the caller reads it back with
+ * sentCode(), sentHeader() and sentContent(). That is how benchmarks and load
+ * tests drive the handlers on the host; nothing listens on a socket.
+ */
+
+typedef enum {
+    HTTP_GET     = 0b00000001,
+    HTTP_POST    = 0b00000010,
+    HTTP_DELETE  = 0b00000100,
+    HTTP_PUT     = 0b00001000,
+    HTTP_PATCH   = 0b00010000,
+    HTTP_HEAD    = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+typedef std::function<void(void)> ArDisconnectHandler;
+/** Fills the buffer with the content from the index on, returns the bytes written, 0 at the end */
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+struct AsyncWebHeader
+{
+    String name;
+    String value;
+};
+
+class AsyncWebParameter
+{
+    public:
+        AsyncWebParameter(const String& name, const String& value) : paramName(name), paramValue(value) {}
+        const String& name() const { return paramName; }
+        const String& value() const { return paramValue; }
+
+    private:
+        String paramName;
+        String paramValue;
+};
+
+class AsyncWebServerRequest
+{
+    public:
+        /** A request to the server of the board, the query of the URL holds the parameters. */
+        AsyncWebServerRequest(WebRequestMethodComposite method, const String& url, const String& host = "192.168.4.1");
+        ~AsyncWebServerRequest();
+
+        /** Native only: sets a header or the body of the request before it is handled. */
+        void setHeader(const String& name, const String& value);
+        void setBody(const String& body) { content = body; }
+
+        WebRequestMethodComposite method() const { return requestMethod; }
+        const String& url() const { return requestUrl; }
+        const String& host() const { return requestHost; }
+        size_t contentLength() const { return content.length(); }
+
+        bool hasParam(const char* name) const;
+        const AsyncWebParameter* getParam(const char* name) const;
+        bool hasHeader(const char* name) const;
+        const String& header(const char* name) const;
+
+        void onDisconnect(ArDisconnectHandler handler) { disconnectHandler = handler; }
+
+        AsyncWebServerResponse* beginResponse(int code, const char* contentType = "", const char* content = "");
+        AsyncWebServerResponse* beginResponse(int code, const String& contentType, const String& content);
+        AsyncWebServerResponse* beginResponse(int code, const char* contentType, const uint8_t* content, size_t len);
+        AsyncWebServerResponse* beginResponse(const char* contentType, size_t len, AwsResponseFiller callback);
+        AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType);
+        AsyncWebServerResponse* beginChunkedResponse(const char* contentType, AwsResponseFiller callback);
+        class AsyncResponseStream* beginResponseStream(const char* contentType, size_t bufferSize = 1460);
+
+        /** Renders the response into the request and deletes it. */
+        void send(AsyncWebServerResponse* response);
+        void send(int code, const char* contentType = "", const char* content = "");
+        void send(int code, const String& contentType, const String& content);
+        void redirect(const String& url);
+
+        /** Native only: the response sent, 0 for none yet */
+        int sentCode() const { return responseCode; }
+        const String& sentHeader(const char* name) const;
+        const String& sentContent() const { return responseContent; }
+
+        void* _tempObject;
+
+    private:
+        friend class AsyncWebServer;
+
+        static const AsyncWebHeader* Find(const std::vector<AsyncWebHeader>& headers, const char* name);
+
+        WebRequestMethodComposite requestMethod;
+        String requestUrl;
+        String requestHost;
+        String content;
+        std::vector<AsyncWebParameter> params;
+        std::vector<AsyncWebHeader> headers;
+        ArDisconnectHandler disconnectHandler;
+        int responseCode;
+        std::vector<AsyncWebHeader> responseHeaders;
+        String responseContent;
+};
+
+class AsyncWebServerResponse
+{
+    public:
+        AsyncWebServerResponse(int code, const String& contentType) : code(code), contentType(contentType), contentLength(0) {}
+        virtual ~AsyncWebServerResponse() {}
+
+        void setCode(int code) { this->code = code; }
+        void setContentType(const String& type) { contentType = type; }
+        void addHeader(const String& name, const String& value) { headers.push_back({ name, value }); }
+
+    protected:
+        friend class AsyncWebServerRequest;
+
+        /** Like AwsResponseFiller, the content of the response */
+        virtual size_t Fill(uint8_t* buffer, size_t maxLen, size_t index) { return 0; }
+
+        int code;
+        String contentType;
+        /** The length announced in the header, 0 for a chunked response */
+        size_t contentLength;
+        std::vector<AsyncWebHeader> headers;
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print
+{
+    public:
+        AsyncResponseStream(const String& contentType, size_t bufferSize);
+
+        virtual size_t write(uint8_t c) override;
+        virtual size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+
+    protected:
+        virtual size_t Fill(uint8_t* buffer, size_t maxLen, size_t index) override;
+
+    private:
+        std::string text;
+};
+
+/** The handler of a range of URLs */
+class AsyncWebHandler
+{
+    public:
+        virtual ~AsyncWebHandler() {}
+
+        AsyncWebHandler& setFilter(ArRequestFilterFunction filter) { this->filter = filter; return *this; }
+        bool filterRequest(AsyncWebServerRequest* request) { return !filter || filter(request); }
+
+        virtual bool canHandle(AsyncWebServerRequest* request) { return false; }
+        virtual void handleRequest(AsyncWebServerRequest* request) {}
+        virtual void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {}
+        virtual void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {}
+
+    protected:
+        ArRequestFilterFunction filter;
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler
+{
+    public:
+        AsyncCallbackWebHandler(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+            ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody);
+
+        virtual bool canHandle(AsyncWebServerRequest* request) override;
+        virtual void handleRequest(AsyncWebServerRequest* request) override;
+        virtual void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) override;
+        virtual void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override;
+
+    private:
+        String uri;
+        WebRequestMethodComposite method;
+        ArRequestHandlerFunction onRequest;
+        ArUploadHandlerFunction onUpload;
+        ArBodyHandlerFunction onBody;
+};
+
+class AsyncWebRewrite
+{
+    public:
+        AsyncWebRewrite(const char* from, const char* to) : from(from), to(to) {}
+        bool match(AsyncWebServerRequest* request) const { return request->url() == from; }
+        const String& toUrl() const { return to; }
+
+    private:
+        String from;
+        String to;
+};
+
+class AsyncWebServer
+{
+    public:
+        AsyncWebServer(uint16_t port) : port(port), started(false) {}
+        ~AsyncWebServer();
+
+        void begin() { started = true; }
+        void end() { started = false; }
+
+        AsyncWebRewrite& rewrite(const char* from, const char* to);
+        AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+        AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+            ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
+        void onNotFound(ArRequestHandlerFunction handler) { notFoundHandler = handler; }
+
+        /**
+         * Native only: routes a request like the server of the board. Its body is
+         * passed in one part, a multipart/form-data body to the upload handler
+         * as a file named "upload", unparsed.
+         * Returns false while the server is not started.
+         */
+        bool handle(AsyncWebServerRequest* request);
+
+    private:
+        uint16_t port;
+        bool started;
+        std::vector<AsyncWebRewrite*> rewrites;
+        std::vector<AsyncWebHandler*> handlers;
+        /** The handlers created by on(), the others belong to the caller */
+        std::vector<AsyncWebHandler*> ownHandlers;
+        ArRequestHandlerFunction notFoundHandler;
+};
+
+/** The headers added to every response */
+class DefaultHeaders
+{
+    public:
+        static DefaultHeaders& Instance();
+
+        void addHeader(const String& name, const String& value) { headers.push_back({ name, value }); }
+        const std::vector<AsyncWebHeader>& getHeaders() const { return headers; }
+
+    private:
+        std::vector<AsyncWebHeader> headers;
+};
+
+class AsyncEventSourceClient
+{
+    public:
+        AsyncEventSourceClient(uint32_t lastId) : lastEventId(lastId), isConnected(true), sentBytes(0) {}
+
+        /** Formats the message like the board does, the host has no one to receive it. */
+        void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+        void close() { isConnected = false; }
+        bool connected() const { return isConnected; }
+        uint32_t lastId() const { return lastEventId; }
+        /** Native only: the bytes of the messages sent */
+        size_t getSentBytes() const { return sentBytes; }
+
+    private:
+        uint32_t lastEventId;
+        bool isConnected;
+        size_t sentBytes;
+};
+
+typedef std::function<void(AsyncEventSourceClient* client)> ArEventHandlerFunction;
+
+/** A stream of server-sent events, a request to its URL connects a client that stays until it is closed */
+class AsyncEventSource : public AsyncWebHandler
+{
+    public:
+        AsyncEventSource(const String& url) : url(url) {}
+        virtual ~AsyncEventSource() override;
+
+        void onConnect(ArEventHandlerFunction handler) { connectHandler = handler; }
+        void close();
+        void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+        size_t count() const;
+
+        virtual bool canHandle(AsyncWebServerRequest* request) override;
+        virtual void handleRequest(AsyncWebServerRequest* request) override;
+
+    private:
+        String url;
+        ArEventHandlerFunction connectHandler;
+        std::vector<AsyncEventSourceClient*> clients;
+};
@@ -0,0 +1,33 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** The chip, a 240 MHz ESP32 whose cycle counter is derived from the clock of the host */
+class EspClass
+{
+    public:
+        void restart() __attribute__((noreturn));
+        uint32_t getCycleCount();
+        uint32_t getCpuFreqMHz() { return cpuFreqMHz; }
+
+    private:
+        static const uint32_t cpuFreqMHz = 240;
+};
+
+extern EspClass ESP;
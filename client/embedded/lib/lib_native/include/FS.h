@@ -0,0 +1,114 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+/*
+ * The file system API of the ESP32 Arduino core, on a directory of the host
+ * (see LittleFS.h). Paths are absolute within the file system, like on the
+ * board.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <memory>
+#include <string>
+#include "Print.h"
+#include "WString.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+/** An open file or directory, copies share it like on the ESP32 */
+class File : public Print
+{
+    public:
+        File(FileImplPtr impl = FileImplPtr()) : impl(impl) {}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+        void flush() override;
+
+        int available();
+        int read();
+        int peek();
+        size_t read(uint8_t* buffer, size_t size);
+        size_t readBytes(char* buffer, size_t length) { return read((uint8_t*)buffer, length); }
+        bool seek(uint32_t position, SeekMode mode);
+        bool seek(uint32_t position) { return seek(position, SeekSet); }
+        size_t position() const;
+        size_t size() const;
+        time_t getLastWrite();
+        void close();
+        operator bool() const;
+
+        /** The path within the file system and the name of the file, like the ESP32 core 2.x */
+        const char* path() const;
+        const char* name() const;
+        bool isDirectory();
+        File openNextFile(const char* mode = FILE_READ);
+        void rewindDirectory();
+
+    private:
+        FileImplPtr impl;
+};
+
+class FS
+{
+    public:
+        File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+        File open(const String& path, const char* mode = FILE_READ, const bool create = false) { return open(path.c_str(), mode, create); }
+        bool exists(const char* path);
+        bool exists(const String& path) { return exists(path.c_str()); }
+        bool remove(const char* path);
+        bool remove(const String& path) { return remove(path.c_str()); }
+        bool rename(const char* pathFrom, const char* pathTo);
+        bool rename(const String& pathFrom, const String& pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+        bool mkdir(const char* path);
+        bool mkdir(const String& path) { return mkdir(path.c_str()); }
+        bool rmdir(const char* path);
+        bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+    protected:
+        /** The host path of a path of the file system */
+        std::string GetHostPath(const char* path) const;
+
+        /** The host directory of the file system, empty while it is not mounted */
+        std::string root;
+};
+
+}
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
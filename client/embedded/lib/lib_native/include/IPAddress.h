@@ -0,0 +1,40 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "WString.h"
+
+class IPAddress
+{
+    public:
+        IPAddress() : address(0) {}
+        IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) :
+            address((uint32_t)first | ((uint32_t)second << 8) | ((uint32_t)third << 16) | ((uint32_t)fourth << 24)) {}
+        IPAddress(uint32_t address) : address(address) {}
+
+        operator uint32_t() const { return address; }
+        uint8_t operator[](int index) const { return (uint8_t)(address >> (index * 8)); }
+        bool operator==(const IPAddress& other) const { return address == other.address; }
+        bool operator!=(const IPAddress& other) const { return address != other.address; }
+
+        String toString() const;
+
+    private:
+        /** In network byte order, like on the ESP32 */
+        uint32_t address;
+};
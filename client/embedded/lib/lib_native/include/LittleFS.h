@@ -0,0 +1,39 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include "FS.h"
+
+namespace fs
+{
+
+/**
+ * LittleFS on the directory $GOALFINDER_FS_DIR, or .littlefs in the working
+ * directory. Mounted empty, it gets a copy of the data directory, like the
+ * image written by uploadfs.
+ */
+class LittleFSFS : public FS
+{
+    public:
+        bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+            const char* partitionLabel = "spiffs");
+        void end();
+};
+
+}
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,81 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * The simulated board the firmware runs on in the native environment.
+ *
+ * It holds the levels of the pins and runs the interrupt handlers attached to
+ * them, the duty cycles of the LED PWM channels and the distance the ToF
+ * sensor measures. Once the firmware is set up, a thread plays shots on it:
+ * the vibration sensor pulses, and for a hit the ball passes the ToF sensor
+ * shortly after. The shots are configured by environment variables:
+ *
+ *   GOALFINDER_SHOT_INTERVAL_MS  Time between two shots, 0 plays none (8000)
+ *   GOALFINDER_HIT_PERCENT       Share of the shots that are hits (50)
+ *
+ * The state of the device survives the process like on the board, in
+ * directories of the working directory (see FS.h, esp_partition.h and the
+ * linux HAL of lib_settings).
+ */
+class NativeBoard
+{
+    public:
+        /** The pin of the vibration sensor */
+        static const uint8_t vibrationPin = 13;
+        /** The width of a pulse of the vibration sensor on a shot */
+        static const unsigned long shotPulseUs = 5000;
+        /** The distance to the ground measured while no ball passes */
+        static const int idleDistanceMm = 1200;
+        /** The distance of a ball passing the ToF sensor */
+        static const int ballDistanceMm = 80;
+        /** The time from the pulse until the ball of a hit passes the sensor, and how long it takes */
+        static const unsigned long ballDelayMs = 600;
+        static const unsigned long ballPassMs = 300;
+
+        /** Remembers the command line for a restart. */
+        static void Init(int argc, char** argv);
+        /** Starts playing the shots, called once the firmware is set up. */
+        static void Begin();
+        /** Replaces the process by a new instance of the firmware, like a reset of the chip. */
+        static void Restart() __attribute__((noreturn));
+
+        /** Sets the level of a pin, an edge runs the attached interrupt handler on the calling thread. */
+        static void SetPin(uint8_t pin, int level);
+        static int GetPin(uint8_t pin);
+        static void AttachInterrupt(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+        static void DetachInterrupt(uint8_t pin);
+
+        static void SetLedDuty(uint8_t channel, uint32_t duty);
+        static uint32_t GetLedDuty(uint8_t channel);
+
+        /** The distance in millimeters the ToF sensor measures next, -1 out of range */
+        static void SetDistance(int millimeters);
+        static int GetDistance();
+
+        /**
+         * Provides the directory holding a part of the state of the device, from the
+         * given environment variable or the default, created if missing.
+         */
+        static std::string GetDirectory(const char* variable, const char* defaultPath);
+
+    private:
+        static void PlayShots();
+};
@@ -0,0 +1,52 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "WString.h"
+
+/** The Arduino Print, the formatting of all overloads funnels into write(). */
+class Print
+{
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t* buffer, size_t size);
+        size_t write(const char* text) { return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0; }
+        size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+        virtual void flush() {}
+
+        size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+        size_t print(const char* text) { return write(text); }
+        size_t print(const String& text) { return write(text.c_str(), text.length()); }
+        size_t print(char c) { return write((uint8_t)c); }
+        size_t print(int value, int base = 10) { return print(String(value, (unsigned char)base)); }
+        size_t print(unsigned int value, int base = 10) { return print(String(value, (unsigned char)base)); }
+        size_t print(long value, int base = 10) { return print(String(value, (unsigned char)base)); }
+        size_t print(unsigned long value, int base = 10) { return print(String(value, (unsigned char)base)); }
+        size_t print(double value, int digits = 2) { return print(String(value, (unsigned int)digits)); }
+
+        size_t println() { return write("\r\n"); }
+        template<typename T>
+        size_t println(const T& value) { return print(value) + println(); }
+        template<typename T>
+        size_t println(const T& value, int format) { return print(value, format) + println(); }
+};
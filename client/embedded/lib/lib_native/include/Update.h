@@ -0,0 +1,76 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Print.h"
+#include "esp_partition.h"
+
+#define UPDATE_ERROR_OK             0
+#define UPDATE_ERROR_WRITE          1
+#define UPDATE_ERROR_ERASE          2
+#define UPDATE_ERROR_SPACE          4
+#define UPDATE_ERROR_SIZE           5
+#define UPDATE_ERROR_MAGIC_BYTE     8
+#define UPDATE_ERROR_NO_PARTITION   10
+#define UPDATE_ERROR_BAD_ARGUMENT   11
+#define UPDATE_ERROR_ABORT          12
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+#define U_FLASH   0
+#define U_SPIFFS  100
+
+/**
+ * Writes an update into the flash partitions (see esp_partition.h), the
+ * firmware into app1 and the file system image into spiffs. The process
+ * keeps running its own binary and file system directory after a restart.
+ */
+class UpdateClass
+{
+    public:
+        UpdateClass();
+
+        bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH, int ledPin = -1, uint8_t ledOn = 0,
+            const char* label = nullptr);
+        size_t write(uint8_t* data, size_t length);
+        bool end(bool evenIfRemaining = false);
+        void abort();
+
+        void printError(Print& out);
+        const char* errorString();
+        uint8_t getError() { return error; }
+        bool hasError() { return error != UPDATE_ERROR_OK; }
+        bool isRunning() { return partition != nullptr; }
+        size_t size() { return updateSize; }
+        size_t progress() { return written; }
+        size_t remaining() { return updateSize - written; }
+
+    private:
+        void Reset();
+
+        const esp_partition_t* partition;
+        size_t updateSize;
+        size_t written;
+        /** End of the erased part of the partition */
+        size_t erased;
+        int command;
+        uint8_t error;
+};
+
+extern UpdateClass Update;
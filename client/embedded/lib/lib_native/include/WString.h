@@ -0,0 +1,123 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * The Arduino String, on top of std::string. Like on the ESP32, an assignment
+ * of a null pointer empties the string.
+ */
+class String
+{
+    public:
+        String(const char* text = "");
+        String(const char* text, size_t length);
+        String(const std::string& text);
+        String(const String& other) = default;
+        String(String&& other) = default;
+        explicit String(char c);
+        explicit String(unsigned char value, unsigned char base = 10);
+        explicit String(int value, unsigned char base = 10);
+        explicit String(unsigned int value, unsigned char base = 10);
+        explicit String(long value, unsigned char base = 10);
+        explicit String(unsigned long value, unsigned char base = 10);
+        explicit String(long long value, unsigned char base = 10);
+        explicit String(unsigned long long value, unsigned char base = 10);
+        explicit String(float value, unsigned int decimalPlaces = 2);
+        explicit String(double value, unsigned int decimalPlaces = 2);
+
+        String& operator=(const String& other) = default;
+        String& operator=(String&& other) = default;
+        String& operator=(const char* text);
+
+        const char* c_str() const { return text.c_str(); }
+        unsigned int length() const { return (unsigned int)text.length(); }
+        bool isEmpty() const { return text.empty(); }
+        bool reserve(unsigned int size);
+        void clear() { text.clear(); }
+
+        bool concat(const String& other);
+        bool concat(const char* other);
+        bool concat(const char* other, unsigned int length);
+        bool concat(char c);
+        bool concat(int value);
+        bool concat(unsigned int value);
+        bool concat(long value);
+        bool concat(unsigned long value);
+        bool concat(double value);
+
+        String& operator+=(const String& other) { concat(other); return *this; }
+        String& operator+=(const char* other) { concat(other); return *this; }
+        String& operator+=(char c) { concat(c); return *this; }
+        String& operator+=(int value) { concat(value); return *this; }
+        String& operator+=(unsigned int value) { concat(value); return *this; }
+        String& operator+=(long value) { concat(value); return *this; }
+        String& operator+=(unsigned long value) { concat(value); return *this; }
+
+        int compareTo(const String& other) const { return text.compare(other.text); }
+        bool equals(const String& other) const { return text == other.text; }
+        bool equals(const char* other) const { return other != nullptr && text == other; }
+        bool equalsIgnoreCase(const String& other) const;
+        bool startsWith(const String& prefix) const;
+        bool startsWith(const String& prefix, unsigned int offset) const;
+        bool endsWith(const String& suffix) const;
+
+        char charAt(unsigned int index) const { return index < text.length() ? text[index] : 0; }
+        void setCharAt(unsigned int index, char c);
+        char operator[](unsigned int index) const { return charAt(index); }
+        char& operator[](unsigned int index);
+
+        int indexOf(char c, unsigned int fromIndex = 0) const;
+        int indexOf(const String& other, unsigned int fromIndex = 0) const;
+        int indexOf(const char* other, unsigned int fromIndex = 0) const;
+        int lastIndexOf(char c) const;
+        int lastIndexOf(const String& other) const;
+        String substring(unsigned int beginIndex) const;
+        String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+        void replace(const String& find, const String& replacement);
+        void remove(unsigned int index);
+        void remove(unsigned int index, unsigned int count);
+        void toLowerCase();
+        void toUpperCase();
+        void trim();
+
+        long toInt() const;
+        float toFloat() const;
+        double toDouble() const;
+
+    private:
+        std::string text;
+};
+
+bool operator==(const String& left, const String& right);
+bool operator==(const String& left, const char* right);
+bool operator==(const char* left, const String& right);
+bool operator!=(const String& left, const String& right);
+bool operator!=(const String& left, const char* right);
+bool operator!=(const char* left, const String& right);
+bool operator<(const String& left, const String& right);
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+String operator+(const String& left, char right);
+
+extern const String emptyString;
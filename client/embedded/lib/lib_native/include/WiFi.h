@@ -0,0 +1,70 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "WString.h"
+#include "IPAddress.h"
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+#define WIFI_SCAN_RUNNING   (-1)
+#define WIFI_SCAN_FAILED    (-2)
+
+/**
+ * The radio of the board, which has no counterpart on the host: the soft AP
+ * is reported as started at its default address, a scan finds the networks
+ * listed in $GOALFINDER_WIFI_NETWORKS (comma separated SSIDs) and no station
+ * ever connects.
+ */
+class WiFiClass
+{
+    public:
+        WiFiClass();
+
+        bool mode(wifi_mode_t mode);
+        wifi_mode_t getMode() { return currentMode; }
+        bool setSleep(bool enabled) { return true; }
+        bool disconnect(bool wifiOff = false, bool eraseAp = false) { return true; }
+
+        bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1, int hidden = 0, int maxConnections = 4);
+        bool softAP(const String& ssid, const char* passphrase = nullptr) { return softAP(ssid.c_str(), passphrase); }
+        bool softAPdisconnect(bool wifiOff = false);
+        IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+        uint8_t softAPgetStationNum() { return 0; }
+        String softAPSSID() { return apSsid; }
+
+        int16_t scanNetworks(bool async = false, bool showHidden = false);
+        String SSID(uint8_t index);
+        void scanDelete();
+
+        String macAddress();
+        uint8_t* macAddress(uint8_t* mac);
+
+    private:
+        wifi_mode_t currentMode;
+        String apSsid;
+        String scanResult;
+        int16_t scanCount;
+};
+
+extern WiFiClass WiFi;
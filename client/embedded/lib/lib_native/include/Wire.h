@@ -0,0 +1,40 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * An I2C bus without devices of its own, the sensors of the simulated board
+ * answer through their drivers (see Adafruit_VL53L0X.h).
+ */
+class TwoWire
+{
+    public:
+        explicit TwoWire(uint8_t bus) : bus(bus), started(false) {}
+
+        bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+        bool end();
+        bool isStarted() const { return started; }
+
+    private:
+        uint8_t bus;
+        bool started;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,192 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <Arduino.h>
+#include <NativeBoard.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static long gmtOffsetSec = 0;
+static int daylightOffsetSec = 0;
+
+/** The time since the start of the process, the boot of the board */
+static std::chrono::steady_clock::duration GetUptime()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::steady_clock::now() - start;
+}
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(GetUptime()).count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(GetUptime()).count();
+}
+
+int64_t esp_timer_get_time()
+{
+    return (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(GetUptime()).count();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return inMax != inMin ? (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin : outMin;
+}
+
+#ifdef NATIVE_STRLCPY
+size_t strlcpy(char* destination, const char* source, size_t size)
+{
+    size_t length = strlen(source);
+    if (size > 0) {
+        size_t count = length < size - 1 ? length : size - 1;
+        memcpy(destination, source, count);
+        destination[count] = '\0';
+    }
+    return length;
+}
+#endif
+
+long random(long howBig)
+{
+    return howBig > 0 ? ::random() % howBig : 0;
+}
+
+long random(long howSmall, long howBig)
+{
+    return howSmall < howBig ? random(howBig - howSmall) + howSmall : howSmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+    if (seed != 0) {
+        srandom((unsigned)seed);
+    }
+}
+
+uint32_t esp_random()
+{
+    static std::random_device device;
+    return device();
+}
+
+void esp_fill_random(void* buffer, size_t length)
+{
+    uint8_t* bytes = (uint8_t*)buffer;
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = (uint8_t)esp_random();
+    }
+}
+
+void esp_restart()
+{
+    NativeBoard::Restart();
+}
+
+void EspClass::restart()
+{
+    NativeBoard::Restart();
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(GetUptime()).count();
+    return (uint32_t)(ns * cpuFreqMHz / 1000);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    // unbuffered, the lines of the tasks do not interleave
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = ::write(STDOUT_FILENO, buffer + written, size - written);
+        if (result <= 0) {
+            break;
+        }
+        written += (size_t)result;
+    }
+    return written;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    if ((size_t)length < sizeof(buffer)) {
+        return write((const uint8_t*)buffer, (size_t)length);
+    }
+    std::string text((size_t)length + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&text[0], text.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)text.data(), (size_t)length);
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2, const char* server3)
+{
+    ::gmtOffsetSec = gmtOffsetSec;
+    ::daylightOffsetSec = daylightOffsetSec;
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms)
+{
+    time_t now = time(nullptr) + gmtOffsetSec + daylightOffsetSec;
+    return gmtime_r(&now, info) != nullptr;
+}
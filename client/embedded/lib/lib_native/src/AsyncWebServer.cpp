@@ -0,0 +1,460 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <ESPAsyncWebServer.h>
+#include <strings.h>
+
+/** The size of the TCP segments the content is sent in on the board */
+static const size_t segmentSize = 1460;
+
+/** A response with its content in memory, copied or pointing to flash */
+class AsyncBasicResponse : public AsyncWebServerResponse
+{
+    public:
+        AsyncBasicResponse(int code, const String& contentType, const uint8_t* content, size_t len, bool copy) :
+            AsyncWebServerResponse(code, contentType), content(content)
+        {
+            if (copy) {
+                text.assign((const char*)content, len);
+                this->content = (const uint8_t*)text.data();
+            }
+            contentLength = len;
+        }
+
+    protected:
+        virtual size_t Fill(uint8_t* buffer, size_t maxLen, size_t index) override
+        {
+            size_t count = index < contentLength ? min(maxLen, contentLength - index) : 0;
+            memcpy(buffer, content + index, count);
+            return count;
+        }
+
+    private:
+        const uint8_t* content;
+        std::string text;
+};
+
+class AsyncCallbackResponse : public AsyncWebServerResponse
+{
+    public:
+        AsyncCallbackResponse(const String& contentType, size_t len, AwsResponseFiller callback) :
+            AsyncWebServerResponse(200, contentType), callback(callback)
+        {
+            contentLength = len;
+        }
+
+    protected:
+        virtual size_t Fill(uint8_t* buffer, size_t maxLen, size_t index) override
+        {
+            if (contentLength > 0) {
+                maxLen = index < contentLength ? min(maxLen, contentLength - index) : 0;
+            }
+            return maxLen > 0 ? callback(buffer, maxLen, index) : 0;
+        }
+
+    private:
+        AwsResponseFiller callback;
+};
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethodComposite method, const String& url, const String& host) :
+    _tempObject(nullptr), requestMethod(method), requestHost(host), responseCode(0)
+{
+    int query = url.indexOf('?');
+    requestUrl = query >= 0 ? url.substring(0, query) : url;
+    for (int start = query; start >= 0; ) {
+        int end = url.indexOf('&', start + 1);
+        String param = url.substring(start + 1, end >= 0 ? end : url.length());
+        int equals = param.indexOf('=');
+        if (param.length() > 0) {
+            params.push_back(AsyncWebParameter(equals >= 0 ? param.substring(0, equals) : param,
+                equals >= 0 ? param.substring(equals + 1) : String()));
+        }
+        start = end;
+    }
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest()
+{
+    if (disconnectHandler) {
+        disconnectHandler();
+    }
+    // freed like the board does once the connection is closed
+    free(_tempObject);
+}
+
+void AsyncWebServerRequest::setHeader(const String& name, const String& value)
+{
+    for (AsyncWebHeader& header : headers) {
+        if (header.name.equalsIgnoreCase(name)) {
+            header.value = value;
+            return;
+        }
+    }
+    headers.push_back({ name, value });
+}
+
+const AsyncWebHeader* AsyncWebServerRequest::Find(const std::vector<AsyncWebHeader>& headers, const char* name)
+{
+    for (const AsyncWebHeader& header : headers) {
+        if (strcasecmp(header.name.c_str(), name) == 0) {
+            return &header;
+        }
+    }
+    return nullptr;
+}
+
+bool AsyncWebServerRequest::hasParam(const char* name) const
+{
+    return getParam(name) != nullptr;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const char* name) const
+{
+    for (const AsyncWebParameter& param : params) {
+        if (param.name() == name) {
+            return &param;
+        }
+    }
+    return nullptr;
+}
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const
+{
+    return Find(headers, name) != nullptr;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const
+{
+    const AsyncWebHeader* header = Find(headers, name);
+    return header != nullptr ? header->value : emptyString;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const char* content)
+{
+    return new AsyncBasicResponse(code, contentType, (const uint8_t*)content, strlen(content), true);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType, const String& content)
+{
+    return new AsyncBasicResponse(code, contentType, (const uint8_t*)content.c_str(), content.length(), true);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const uint8_t* content, size_t len)
+{
+    return new AsyncBasicResponse(code, contentType, content, len, false);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const char* contentType, size_t len, AwsResponseFiller callback)
+{
+    return new AsyncCallbackResponse(contentType, len, callback);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType)
+{
+    File file = fs.open(path);
+    if (!file) {
+        return beginResponse(404);
+    }
+    // the file is read when the response is sent, and closed with the response
+    return new AsyncCallbackResponse(contentType, file.size(), [file](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        File content = file;
+        return content.seek(index) ? content.read(buffer, maxLen) : 0;
+    });
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const char* contentType, AwsResponseFiller callback)
+{
+    return new AsyncCallbackResponse(contentType, 0, callback);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const char* contentType, size_t bufferSize)
+{
+    return new AsyncResponseStream(contentType, bufferSize);
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response)
+{
+    if (response == nullptr) {
+        return;
+    }
+    responseCode = response->code;
+    responseHeaders = DefaultHeaders::Instance().getHeaders();
+    responseHeaders.push_back({ "Content-Type", response->contentType });
+    responseHeaders.insert(responseHeaders.end(), response->headers.begin(), response->headers.end());
+    responseContent = String();
+    uint8_t segment[segmentSize];
+    for (size_t count = response->Fill(segment, sizeof(segment), 0); count > 0; 
+        count = response->Fill(segment, sizeof(segment), responseContent.length())) {
+        responseContent.concat((const char*)segment, count);
+    }
+    delete response;
+}
+
+void AsyncWebServerRequest::send(int code, const char* contentType, const char* content)
+{
+    send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content)
+{
+    send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::redirect(const String& url)
+{
+    AsyncWebServerResponse* response = beginResponse(302);
+    response->addHeader("Location", url);
+    send(response);
+}
+
+const String& AsyncWebServerRequest::sentHeader(const char* name) const
+{
+    const AsyncWebHeader* header = Find(responseHeaders, name);
+    return header != nullptr ? header->value : emptyString;
+}
+
+AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize) : AsyncWebServerResponse(200, contentType)
+{
+    text.reserve(bufferSize);
+}
+
+size_t AsyncResponseStream::write(uint8_t c)
+{
+    text.push_back((char)c);
+    return 1;
+}
+
+size_t AsyncResponseStream::write(const uint8_t* buffer, size_t size)
+{
+    text.append((const char*)buffer, size);
+    return size;
+}
+
+size_t AsyncResponseStream::Fill(uint8_t* buffer, size_t maxLen, size_t index)
+{
+    size_t count = index < text.length() ? min(maxLen, text.length() - index) : 0;
+    memcpy(buffer, text.data() + index, count);
+    return count;
+}
+
+AsyncCallbackWebHandler::AsyncCallbackWebHandler(const char* uri, WebRequestMethodComposite method,
+    ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) :
+    uri(uri), method(method), onRequest(onRequest), onUpload(onUpload), onBody(onBody)
+{
+}
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request)
+{
+    if (!onRequest || (request->method() & method) == 0) {
+        return false;
+    }
+    const String& url = request->url();
+    if (uri.isEmpty() || url == uri) {
+        return true;
+    }
+    // "/path/*" takes everything below the path, "/path" its subpaths too
+    if (uri.endsWith("*")) {
+        return url.startsWith(uri.substring(0, uri.length() - 1));
+    }
+    return url.startsWith(uri + "/");
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request)
+{
+    if (onRequest) {
+        onRequest(request);
+    } else {
+        request->send(500);
+    }
+}
+
+void AsyncCallbackWebHandler::handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+    uint8_t* data, size_t len, bool final)
+{
+    if (onUpload) {
+        onUpload(request, filename, index, data, len, final);
+    }
+}
+
+void AsyncCallbackWebHandler::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)
+{
+    if (onBody) {
+        onBody(request, data, len, index, total);
+    }
+}
+
+AsyncWebServer::~AsyncWebServer()
+{
+    for (AsyncWebRewrite* rewrite : rewrites) {
+        delete rewrite;
+    }
+    for (AsyncWebHandler* handler : ownHandlers) {
+        delete handler;
+    }
+}
+
+AsyncWebRewrite& AsyncWebServer::rewrite(const char* from, const char* to)
+{
+    rewrites.push_back(new AsyncWebRewrite(from, to));
+    return *rewrites.back();
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler)
+{
+    handlers.push_back(handler);
+    return *handler;
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+    ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody)
+{
+    AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler(uri, method, onRequest, onUpload, onBody);
+    ownHandlers.push_back(handler);
+    addHandler(handler);
+    return *handler;
+}
+
+bool AsyncWebServer::handle(AsyncWebServerRequest* request)
+{
+    if (!started) {
+        return false;
+    }
+    for (AsyncWebRewrite* rewrite : rewrites) {
+        if (rewrite->match(request)) {
+            request->requestUrl = rewrite->toUrl();
+        }
+    }
+    AsyncWebHandler* handler = nullptr;
+    for (AsyncWebHandler* candidate : handlers) {
+        if (candidate->filterRequest(request) && candidate->canHandle(request)) {
+            handler = candidate;
+            break;
+        }
+    }
+    if (handler == nullptr) {
+        if (notFoundHandler) {
+            notFoundHandler(request);
+        } else {
+            request->send(404);
+        }
+        return true;
+    }
+    size_t length = request->content.length();
+    if (length > 0) {
+        // the handlers take the body in a buffer they may modify
+        std::vector<uint8_t> body(request->content.c_str(), request->content.c_str() + length);
+        if (request->header("Content-Type").startsWith("multipart/form-data")) {
+            handler->handleUpload(request, "upload", 0, body.data(), length, true);
+        } else {
+            handler->handleBody(request, body.data(), length, 0, length);
+        }
+    }
+    handler->handleRequest(request);
+    return true;
+}
+
+DefaultHeaders& DefaultHeaders::Instance()
+{
+    static DefaultHeaders instance;
+    return instance;
+}
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect)
+{
+    if (!isConnected) {
+        return;
+    }
+    String text;
+    if (reconnect > 0) {
+        text += "retry: " + String(reconnect) + "\r\n";
+    }
+    if (id > 0) {
+        text += "id: " + String(id) + "\r\n";
+    }
+    if (event != nullptr) {
+        text += String("event: ") + event + "\r\n";
+    }
+    // every line of the message is a data line of its own
+    String data = message != nullptr ? message : "";
+    for (int start = 0; start >= 0; ) {
+        int end = data.indexOf('\n', start);
+        text += "data: " + data.substring(start, end >= 0 ? end : data.length()) + "\r\n";
+        start = end >= 0 ? end + 1 : -1;
+    }
+    text += "\r\n";
+    sentBytes += text.length();
+    if (id > 0) {
+        lastEventId = id;
+    }
+}
+
+AsyncEventSource::~AsyncEventSource()
+{
+    for (AsyncEventSourceClient* client : clients) {
+        delete client;
+    }
+}
+
+void AsyncEventSource::close()
+{
+    for (AsyncEventSourceClient* client : clients) {
+        client->close();
+    }
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect)
+{
+    for (AsyncEventSourceClient* client : clients) {
+        client->send(message, event, id, reconnect);
+    }
+}
+
+size_t AsyncEventSource::count() const
+{
+    size_t connected = 0;
+    for (const AsyncEventSourceClient* client : clients) {
+        connected += client->connected() ? 1 : 0;
+    }
+    return connected;
+}
+
+bool AsyncEventSource::canHandle(AsyncWebServerRequest* request)
+{
+    return request->method() == HTTP_GET && request->url() == url;
+}
+
+void AsyncEventSource::handleRequest(AsyncWebServerRequest* request)
+{
+    uint32_t lastId = request->hasHeader("Last-Event-ID") ? (uint32_t)request->header("Last-Event-ID").toInt() : 0;
+    // a closed client leaves, like its connection on the board
+    for (size_t i = 0; i < clients.size(); ) {
+        if (!clients[i]->connected()) {
+            delete clients[i];
+            clients.erase(clients.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    AsyncEventSourceClient* client = new AsyncEventSourceClient(lastId);
+    clients.push_back(client);
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/event-stream",
+        [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t { return 0; });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+    if (connectHandler) {
+        connectHandler(client);
+    }
+}
@@ -0,0 +1,178 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <AudioFileSourceFS.h>
+#include <AudioGeneratorMP3.h>
+#include <AudioOutputI2S.h>
+#include <stdlib.h>
+#include <mutex>
+
+bool AudioFileSourceFS::open(const char* filename)
+{
+    file = fileSystem->open(filename, "r");
+    return file;
+}
+
+uint32_t AudioFileSourceFS::read(void* data, uint32_t len)
+{
+    return (uint32_t)file.read((uint8_t*)data, len);
+}
+
+bool AudioFileSourceFS::seek(int32_t pos, int dir)
+{
+    if (dir == SEEK_CUR) {
+        pos += (int32_t)file.position();
+    } else if (dir == SEEK_END) {
+        pos += (int32_t)file.size();
+    }
+    return pos >= 0 && file.seek((uint32_t)pos);
+}
+
+bool AudioFileSourceFS::close()
+{
+    file.close();
+    return true;
+}
+
+bool AudioFileSourceFS::isOpen()
+{
+    return file;
+}
+
+uint32_t AudioFileSourceFS::getSize()
+{
+    return (uint32_t)file.size();
+}
+
+uint32_t AudioFileSourceFS::getPos()
+{
+    return (uint32_t)file.position();
+}
+
+bool AudioGeneratorMP3::begin(AudioFileSource* source, AudioOutput* output)
+{
+    static std::once_flag notice;
+    std::call_once(notice, [] {
+        fprintf(stderr, "[NativeBoard] No MP3 decoder, only clips transcoded by transcode-audio.py play\n");
+    });
+    return false;
+}
+
+bool AudioGeneratorMP3::loop()
+{
+    return false;
+}
+
+bool AudioGeneratorMP3::stop()
+{
+    running = false;
+    return true;
+}
+
+bool AudioGeneratorMP3::isRunning()
+{
+    return running;
+}
+
+uint16_t AudioOutput::ConsumeSamples(int16_t* samples, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        if (!ConsumeSample(samples + i * 2)) {
+            return i;
+        }
+    }
+    return count;
+}
+
+int16_t AudioOutput::Amplify(int16_t sample)
+{
+    int32_t amplified = ((int32_t)sample * gainF2P6) >> 6;
+    return (int16_t)constrain(amplified, -32768, 32767);
+}
+
+AudioOutputI2S::AudioOutputI2S(int port, int outputMode, int dmaBufferCount, int useApll) :
+    started(false), readIndex(0), count(0), playedUs(0), playedRemainder(0), pcm(nullptr)
+{
+}
+
+AudioOutputI2S::~AudioOutputI2S()
+{
+    stop();
+}
+
+bool AudioOutputI2S::begin()
+{
+    if (!started) {
+        const char* path = getenv("GOALFINDER_I2S_OUT");
+        pcm = path != nullptr && *path != '\0' ? fopen(path, "ab") : nullptr;
+        readIndex = 0;
+        count = 0;
+        playedUs = micros();
+        playedRemainder = 0;
+        started = true;
+    }
+    return true;
+}
+
+bool AudioOutputI2S::ConsumeSample(int16_t sample[2])
+{
+    if (!started) {
+        return false;
+    }
+    Drain();
+    const uint32_t capacity = dmaBufferCount * dmaBufferFrames;
+    if (count == capacity) {
+        return false;
+    }
+    int16_t* frame = frames[(readIndex + count) % capacity];
+    frame[LEFTCHANNEL] = Amplify(sample[LEFTCHANNEL]);
+    frame[RIGHTCHANNEL] = channels == 1 ? frame[LEFTCHANNEL] : Amplify(sample[RIGHTCHANNEL]);
+    count++;
+    return true;
+}
+
+bool AudioOutputI2S::stop()
+{
+    if (pcm != nullptr) {
+        fclose(pcm);
+        pcm = nullptr;
+    }
+    started = false;
+    count = 0;
+    return true;
+}
+
+void AudioOutputI2S::Drain()
+{
+    const uint32_t capacity = dmaBufferCount * dmaBufferFrames;
+    unsigned long now = micros();
+    uint64_t elapsed = (uint64_t)(now - playedUs) * (uint64_t)hertz + playedRemainder;
+    playedUs = now;
+    uint64_t played = elapsed / 1000000ULL;
+    playedRemainder = elapsed % 1000000ULL;
+    if (played >= count) {
+        // the buffers ran empty, the driver plays silence until the next frame
+        played = count;
+        playedRemainder = 0;
+    }
+    for (uint32_t i = 0; i < (uint32_t)played; i++) {
+        if (pcm != nullptr) {
+            fwrite(frames[(readIndex + i) % capacity], sizeof(int16_t), 2, pcm);
+        }
+    }
+    readIndex = (readIndex + (uint32_t)played) % capacity;
+    count -= (uint32_t)played;
+}
@@ -0,0 +1,166 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <esp_partition.h>
+#include <NativeBoard.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <mutex>
+
+/** The layout of partitions.csv */
+static const esp_partition_t partitions[] = {
+    { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x9000, 0x5000, "nvs", false },
+    { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_OTA, 0xe000, 0x2000, "otadata", false },
+    { ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, 0x140000, "app0", false },
+    { ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x150000, 0x140000, "app1", false },
+    { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, 0xE0000, "spiffs", false },
+    { ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x40, 0x370000, 0x80000, "assets", false },
+    { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, 0x3F0000, 0x10000, "coredump", false },
+};
+static const size_t partitionCount = sizeof(partitions) / sizeof(partitions[0]);
+
+static std::mutex mapMutex;
+/** The partition files, mapped on first use until the process ends */
+static uint8_t* mappings[partitionCount];
+
+/**
+ * Maps the file of a partition, created or extended with erased flash to the
+ * size of the partition. Returns nullptr if it cannot be mapped.
+ */
+static uint8_t* GetMapping(const esp_partition_t* partition)
+{
+    size_t index = (size_t)(partition - partitions);
+    if (index >= partitionCount) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mapMutex);
+    if (mappings[index] != nullptr) {
+        return mappings[index];
+    }
+    std::string path = NativeBoard::GetDirectory("GOALFINDER_FLASH_DIR", ".flash") + "/" + partition->label + ".bin";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[NativeBoard] Could not open %s\n", path.c_str());
+        return nullptr;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && (size_t)status.st_size < partition->size) {
+        // a shorter file is an image written to the start of the partition
+        uint8_t erased[SPI_FLASH_SEC_SIZE];
+        memset(erased, 0xFF, sizeof(erased));
+        for (size_t offset = (size_t)status.st_size; offset < partition->size; offset += sizeof(erased)) {
+            size_t length = partition->size - offset < sizeof(erased) ? partition->size - offset : sizeof(erased);
+            if (pwrite(fd, erased, length, (off_t)offset) != (ssize_t)length) {
+                break;
+            }
+        }
+    }
+    void* mapped = mmap(nullptr, partition->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "[NativeBoard] Could not map %s\n", path.c_str());
+        return nullptr;
+    }
+    mappings[index] = (uint8_t*)mapped;
+    return mappings[index];
+}
+
+static bool IsInside(const esp_partition_t* partition, size_t offset, size_t size)
+{
+    return offset <= partition->size && size <= partition->size - offset;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label)
+{
+    for (size_t i = 0; i < partitionCount; i++) {
+        const esp_partition_t* partition = &partitions[i];
+        if ((type == ESP_PARTITION_TYPE_ANY || partition->type == type) &&
+            (subtype == ESP_PARTITION_SUBTYPE_ANY || partition->subtype == subtype) &&
+            (label == nullptr || strcmp(partition->label, label) == 0)) {
+            return partition;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* destination, size_t size)
+{
+    if (partition == nullptr || !IsInside(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t* flash = GetMapping(partition);
+    if (flash == nullptr) {
+        return ESP_FAIL;
+    }
+    memcpy(destination, flash + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* source, size_t size)
+{
+    if (partition == nullptr || !IsInside(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t* flash = GetMapping(partition);
+    if (flash == nullptr) {
+        return ESP_FAIL;
+    }
+    const uint8_t* bytes = (const uint8_t*)source;
+    for (size_t i = 0; i < size; i++) {
+        flash[offset + i] &= bytes[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size)
+{
+    if (partition == nullptr || !IsInside(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (offset % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t* flash = GetMapping(partition);
+    if (flash == nullptr) {
+        return ESP_FAIL;
+    }
+    memset(flash + offset, 0xFF, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory,
+    const void** pointer, spi_flash_mmap_handle_t* handle)
+{
+    if (partition == nullptr || !IsInside(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t* flash = GetMapping(partition);
+    if (flash == nullptr) {
+        return ESP_FAIL;
+    }
+    *pointer = flash + offset;
+    *handle = (spi_flash_mmap_handle_t)(partition - partitions) + 1;
+    return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle)
+{
+    // the partition stays mapped for later calls
+}
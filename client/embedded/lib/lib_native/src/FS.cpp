@@ -0,0 +1,322 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <FS.h>
+#include <LittleFS.h>
+#include <NativeBoard.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** The files uploadfs writes to the board, relative to the working directory */
+static const char* dataDir = "data";
+
+fs::LittleFSFS LittleFS;
+
+namespace fs
+{
+
+struct FileImpl
+{
+    FILE* file;
+    DIR* dir;
+    std::string path;
+    std::string hostPath;
+
+    FileImpl() : file(nullptr), dir(nullptr) {}
+    ~FileImpl() { Close(); }
+
+    void Close()
+    {
+        if (file != nullptr) {
+            fclose(file);
+            file = nullptr;
+        }
+        if (dir != nullptr) {
+            closedir(dir);
+            dir = nullptr;
+        }
+    }
+};
+
+/** Opens a file or directory given by its path in the file system and on the host. */
+static File OpenEntry(const std::string& path, const std::string& hostPath, const char* mode)
+{
+    FileImplPtr impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPath;
+    struct stat status;
+    if (stat(hostPath.c_str(), &status) == 0 && S_ISDIR(status.st_mode)) {
+        impl->dir = opendir(hostPath.c_str());
+    } else {
+        impl->file = fopen(hostPath.c_str(), mode);
+    }
+    return impl->file != nullptr || impl->dir != nullptr ? File(impl) : File();
+}
+
+/** Creates the missing directories of a host path, the last element is the file. */
+static void CreateParents(const std::string& hostPath, size_t rootLength)
+{
+    for (size_t slash = hostPath.find('/', rootLength + 1); slash != std::string::npos; slash = hostPath.find('/', slash + 1)) {
+        ::mkdir(hostPath.substr(0, slash).c_str(), 0755);
+    }
+}
+
+/** Copies the files of a host directory and its subdirectories into another one. */
+static void CopyDirectory(const std::string& from, const std::string& to)
+{
+    DIR* dir = opendir(from.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    for (struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        std::string source = from + "/" + entry->d_name;
+        std::string destination = to + "/" + entry->d_name;
+        struct stat status;
+        if (stat(source.c_str(), &status) != 0) {
+            continue;
+        }
+        if (S_ISDIR(status.st_mode)) {
+            ::mkdir(destination.c_str(), 0755);
+            CopyDirectory(source, destination);
+            continue;
+        }
+        FILE* in = fopen(source.c_str(), "r");
+        FILE* out = in != nullptr ? fopen(destination.c_str(), "w") : nullptr;
+        char buffer[4096];
+        size_t length;
+        while (out != nullptr && (length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            fwrite(buffer, 1, length, out);
+        }
+        if (out != nullptr) {
+            fclose(out);
+        }
+        if (in != nullptr) {
+            fclose(in);
+        }
+    }
+    closedir(dir);
+}
+
+static bool IsEmptyDirectory(const std::string& hostPath)
+{
+    DIR* dir = opendir(hostPath.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+    bool empty = true;
+    for (struct dirent* entry = readdir(dir); entry != nullptr && empty; entry = readdir(dir)) {
+        empty = strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0;
+    }
+    closedir(dir);
+    return empty;
+}
+
+size_t File::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size)
+{
+    return impl && impl->file != nullptr ? fwrite(buffer, 1, size, impl->file) : 0;
+}
+
+void File::flush()
+{
+    if (impl && impl->file != nullptr) {
+        fflush(impl->file);
+    }
+}
+
+int File::available()
+{
+    return impl && impl->file != nullptr ? (int)(size() - position()) : 0;
+}
+
+int File::read()
+{
+    return impl && impl->file != nullptr ? fgetc(impl->file) : -1;
+}
+
+int File::peek()
+{
+    if (!impl || impl->file == nullptr) {
+        return -1;
+    }
+    int c = fgetc(impl->file);
+    if (c != EOF) {
+        ungetc(c, impl->file);
+    }
+    return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size)
+{
+    return impl && impl->file != nullptr ? fread(buffer, 1, size, impl->file) : 0;
+}
+
+bool File::seek(uint32_t position, SeekMode mode)
+{
+    static const int origins[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return impl && impl->file != nullptr && fseek(impl->file, (long)position, origins[mode]) == 0;
+}
+
+size_t File::position() const
+{
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    long position = ftell(impl->file);
+    return position >= 0 ? (size_t)position : 0;
+}
+
+size_t File::size() const
+{
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    // includes the bytes still buffered for writing
+    fflush(impl->file);
+    struct stat status;
+    return fstat(fileno(impl->file), &status) == 0 ? (size_t)status.st_size : 0;
+}
+
+time_t File::getLastWrite()
+{
+    struct stat status;
+    return impl && stat(impl->hostPath.c_str(), &status) == 0 ? status.st_mtime : 0;
+}
+
+void File::close()
+{
+    if (impl) {
+        impl->Close();
+        impl.reset();
+    }
+}
+
+File::operator bool() const
+{
+    return impl && (impl->file != nullptr || impl->dir != nullptr);
+}
+
+const char* File::path() const
+{
+    return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const
+{
+    if (!impl) {
+        return nullptr;
+    }
+    const char* slash = strrchr(impl->path.c_str(), '/');
+    return slash != nullptr ? slash + 1 : impl->path.c_str();
+}
+
+bool File::isDirectory()
+{
+    return impl && impl->dir != nullptr;
+}
+
+File File::openNextFile(const char* mode)
+{
+    if (!impl || impl->dir == nullptr) {
+        return File();
+    }
+    for (struct dirent* entry = readdir(impl->dir); entry != nullptr; entry = readdir(impl->dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        std::string separator = impl->path.empty() || impl->path.back() != '/' ? "/" : "";
+        return OpenEntry(impl->path + separator + entry->d_name, impl->hostPath + "/" + entry->d_name, mode);
+    }
+    return File();
+}
+
+void File::rewindDirectory()
+{
+    if (impl && impl->dir != nullptr) {
+        rewinddir(impl->dir);
+    }
+}
+
+File FS::open(const char* path, const char* mode, const bool create)
+{
+    if (root.empty() || path == nullptr || path[0] != '/') {
+        return File();
+    }
+    std::string hostPath = GetHostPath(path);
+    if (create && mode[0] != 'r') {
+        CreateParents(hostPath, root.length());
+    }
+    return OpenEntry(path, hostPath, mode);
+}
+
+bool FS::exists(const char* path)
+{
+    struct stat status;
+    return !root.empty() && stat(GetHostPath(path).c_str(), &status) == 0;
+}
+
+bool FS::remove(const char* path)
+{
+    return !root.empty() && unlink(GetHostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo)
+{
+    return !root.empty() && ::rename(GetHostPath(pathFrom).c_str(), GetHostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path)
+{
+    return !root.empty() && ::mkdir(GetHostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path)
+{
+    return !root.empty() && ::rmdir(GetHostPath(path).c_str()) == 0;
+}
+
+std::string FS::GetHostPath(const char* path) const
+{
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel)
+{
+    if (root.empty()) {
+        root = NativeBoard::GetDirectory("GOALFINDER_FS_DIR", ".littlefs");
+        if (IsEmptyDirectory(root)) {
+            CopyDirectory(dataDir, root);
+        }
+    }
+    return true;
+}
+
+void LittleFSFS::end()
+{
+    root.clear();
+}
+
+}
@@ -0,0 +1,439 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include <pthread.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Tasks are detached threads, semaphores and queues a mutex and a condition
+ * variable each. A handle stays valid for the life of the process, nothing
+ * the firmware creates is ever deleted while it runs.
+ */
+
+struct NativeTask
+{
+    std::string name;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t value;
+    /** A notification arrived since the last wait */
+    bool pending;
+};
+
+struct NativeSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable released;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    bool isMutex;
+    std::thread::id holder;
+    /** Takes of a recursive mutex by its holder */
+    UBaseType_t depth;
+};
+
+struct NativeQueue
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+};
+
+static thread_local NativeTask* currentTask = nullptr;
+
+/** Waits until the predicate holds, at most the given ticks of 1 ms. Returns the predicate. */
+template<typename Predicate>
+static bool WaitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& condition, TickType_t ticks, Predicate predicate)
+{
+    if (ticks == portMAX_DELAY) {
+        condition.wait(lock, predicate);
+        return true;
+    }
+    return condition.wait_for(lock, std::chrono::milliseconds(ticks), predicate);
+}
+
+static NativeTask* CreateTask(const char* name)
+{
+    NativeTask* task = new NativeTask();
+    task->name = name != nullptr ? name : "";
+    task->value = 0;
+    task->pending = false;
+    return task;
+}
+
+/** Provides the task of the calling thread, a thread not started by xTaskCreate gets one on its first call. */
+static NativeTask* GetCurrentTask()
+{
+    if (currentTask == nullptr) {
+        currentTask = CreateTask("thread");
+    }
+    return currentTask;
+}
+
+void NativeTaskYield()
+{
+    std::this_thread::yield();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameters,
+    UBaseType_t priority, TaskHandle_t* createdTask, BaseType_t coreId)
+{
+    NativeTask* task = CreateTask(name);
+    // known before the task runs, it may notify tasks created after it
+    if (createdTask != nullptr) {
+        *createdTask = task;
+    }
+    std::thread([task, function, parameters]() {
+        currentTask = task;
+#ifdef __linux__
+        // shown by top and gdb, at most 15 characters
+        pthread_setname_np(pthread_self(), task->name.substr(0, 15).c_str());
+#endif
+        function(parameters);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameters,
+    UBaseType_t priority, TaskHandle_t* createdTask)
+{
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == currentTask) {
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return GetCurrentTask();
+}
+
+const char* pcTaskGetName(TaskHandle_t task)
+{
+    return (task != nullptr ? task : GetCurrentTask())->name.c_str();
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        switch (action) {
+            case eSetBits:
+                task->value |= value;
+                break;
+            case eIncrement:
+                task->value++;
+                break;
+            case eSetValueWithOverwrite:
+                task->value = value;
+                break;
+            case eSetValueWithoutOverwrite:
+                if (task->pending) {
+                    return pdFAIL;
+                }
+                task->value = value;
+                break;
+            default:
+                break;
+        }
+        task->pending = true;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken)
+{
+    xTaskNotifyFromISR(task, 0, eIncrement, higherPriorityTaskWoken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    NativeTask* task = GetCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    WaitFor(lock, task->notified, ticksToWait, [task] { return task->value != 0; });
+    uint32_t value = task->value;
+    if (value != 0) {
+        task->value = clearCountOnExit ? 0 : value - 1;
+    }
+    task->pending = false;
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t bitsToClearOnEntry, uint32_t bitsToClearOnExit, uint32_t* notificationValue,
+    TickType_t ticksToWait)
+{
+    NativeTask* task = GetCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    if (!task->pending) {
+        task->value &= ~bitsToClearOnEntry;
+    }
+    bool received = WaitFor(lock, task->notified, ticksToWait, [task] { return task->pending; });
+    if (notificationValue != nullptr) {
+        *notificationValue = task->value;
+    }
+    if (received) {
+        task->value &= ~bitsToClearOnExit;
+        task->pending = false;
+    }
+    return received ? pdTRUE : pdFALSE;
+}
+
+static SemaphoreHandle_t CreateSemaphore(UBaseType_t maxCount, UBaseType_t initialCount, bool isMutex)
+{
+    NativeSemaphore* semaphore = new NativeSemaphore();
+    semaphore->count = initialCount;
+    semaphore->maxCount = maxCount;
+    semaphore->isMutex = isMutex;
+    semaphore->depth = 0;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return CreateSemaphore(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    return CreateSemaphore(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return CreateSemaphore(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    return CreateSemaphore(maxCount, initialCount, false);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!WaitFor(lock, semaphore->released, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    if (semaphore->isMutex) {
+        semaphore->holder = std::this_thread::get_id();
+        semaphore->depth = 1;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->count >= semaphore->maxCount) {
+            return pdFALSE;
+        }
+        semaphore->count++;
+        semaphore->holder = std::thread::id();
+        semaphore->depth = 0;
+    }
+    semaphore->released.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticksToWait)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex->mutex);
+        if (mutex->count == 0 && mutex->holder == std::this_thread::get_id()) {
+            mutex->depth++;
+            return pdTRUE;
+        }
+    }
+    return xSemaphoreTake(mutex, ticksToWait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex->mutex);
+        if (mutex->holder != std::this_thread::get_id()) {
+            return pdFALSE;
+        }
+        if (--mutex->depth > 0) {
+            return pdTRUE;
+        }
+    }
+    return xSemaphoreGive(mutex);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    return semaphore->count;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    NativeQueue* queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+static BaseType_t Send(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool front)
+{
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!WaitFor(lock, queue->changed, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+            return pdFAIL;
+        }
+        const uint8_t* bytes = (const uint8_t*)item;
+        std::vector<uint8_t> copy(bytes, bytes + queue->itemSize);
+        if (front) {
+            queue->items.push_front(std::move(copy));
+        } else {
+            queue->items.push_back(std::move(copy));
+        }
+    }
+    // senders and receivers wait on the same condition
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait)
+{
+    return Send(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait)
+{
+    return Send(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait)
+{
+    return Send(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return Send(queue, item, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait)
+{
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!WaitFor(lock, queue->changed, ticksToWait, [queue] { return !queue->items.empty(); })) {
+            return pdFALSE;
+        }
+        memcpy(item, queue->items.front().data(), queue->itemSize);
+        queue->items.pop_front();
+    }
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!WaitFor(lock, queue->changed, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->items.clear();
+    }
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - (UBaseType_t)queue->items.size();
+}
@@ -0,0 +1,256 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <NativeBoard.h>
+#include <Arduino.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+
+static const uint8_t pinCount = 40;
+static const uint8_t ledcChannelCount = 16;
+
+struct Interrupt
+{
+    void (*handler)(void*);
+    void* arg;
+    int mode;
+};
+
+static std::atomic<int> pinLevels[pinCount];
+static std::mutex interruptMutex;
+static Interrupt interrupts[pinCount];
+static std::atomic<uint32_t> ledDuties[ledcChannelCount];
+static std::atomic<int> distanceMm(NativeBoard::idleDistanceMm);
+static char** arguments = nullptr;
+
+/** Reads a number from the environment, the default if it is not set. */
+static long GetSetting(const char* variable, long defaultValue)
+{
+    const char* value = getenv(variable);
+    return value != nullptr && *value != '\0' ? strtol(value, nullptr, 10) : defaultValue;
+}
+
+void NativeBoard::Init(int argc, char** argv)
+{
+    arguments = argv;
+}
+
+void NativeBoard::Begin()
+{
+    std::thread(PlayShots).detach();
+}
+
+void NativeBoard::Restart()
+{
+    fflush(stdout);
+    fflush(stderr);
+    if (arguments != nullptr) {
+        execv("/proc/self/exe", arguments);
+    }
+    fprintf(stderr, "[NativeBoard] Restart failed (%d), exiting\n", errno);
+    exit(1);
+}
+
+void NativeBoard::SetPin(uint8_t pin, int level)
+{
+    if (pin >= pinCount) {
+        return;
+    }
+    level = level != LOW ? HIGH : LOW;
+    int previous = pinLevels[pin].exchange(level);
+    if (previous == level) {
+        return;
+    }
+    Interrupt interrupt;
+    {
+        std::lock_guard<std::mutex> lock(interruptMutex);
+        interrupt = interrupts[pin];
+    }
+    bool rising = level == HIGH;
+    if (interrupt.handler != nullptr && (interrupt.mode == CHANGE || (interrupt.mode == RISING) == rising)) {
+        interrupt.handler(interrupt.arg);
+    }
+}
+
+int NativeBoard::GetPin(uint8_t pin)
+{
+    return pin < pinCount ? pinLevels[pin].load() : LOW;
+}
+
+void NativeBoard::AttachInterrupt(uint8_t pin, void (*handler)(void*), void* arg, int mode)
+{
+    if (pin < pinCount) {
+        std::lock_guard<std::mutex> lock(interruptMutex);
+        interrupts[pin] = { handler, arg, mode };
+    }
+}
+
+void NativeBoard::DetachInterrupt(uint8_t pin)
+{
+    AttachInterrupt(pin, nullptr, nullptr, 0);
+}
+
+void NativeBoard::SetLedDuty(uint8_t channel, uint32_t duty)
+{
+    if (channel < ledcChannelCount) {
+        ledDuties[channel] = duty;
+    }
+}
+
+uint32_t NativeBoard::GetLedDuty(uint8_t channel)
+{
+    return channel < ledcChannelCount ? ledDuties[channel].load() : 0;
+}
+
+void NativeBoard::SetDistance(int millimeters)
+{
+    distanceMm = millimeters;
+}
+
+int NativeBoard::GetDistance()
+{
+    return distanceMm;
+}
+
+std::string NativeBoard::GetDirectory(const char* variable, const char* defaultPath)
+{
+    const char* path = getenv(variable);
+    std::string directory = path != nullptr && *path != '\0' ? path : defaultPath;
+    mkdir(directory.c_str(), 0755);
+    return directory;
+}
+
+void NativeBoard::PlayShots()
+{
+    unsigned long intervalMs = (unsigned long)GetSetting("GOALFINDER_SHOT_INTERVAL_MS", 8000);
+    long hitPercent = GetSetting("GOALFINDER_HIT_PERCENT", 50);
+    if (intervalMs == 0) {
+        return;
+    }
+    std::minstd_rand random((unsigned)micros());
+    for (unsigned long shot = 1; ; shot++) {
+        delay(intervalMs);
+        bool hit = (long)(random() % 100) < hitPercent;
+        fprintf(stderr, "[NativeBoard] Shot %lu, %s\n", shot, hit ? "hit" : "miss");
+        SetPin(vibrationPin, HIGH);
+        delayMicroseconds(shotPulseUs);
+        SetPin(vibrationPin, LOW);
+        if (hit) {
+            delay(ballDelayMs);
+            SetDistance(ballDistanceMm);
+            delay(ballPassMs);
+            SetDistance(idleDistanceMm);
+        }
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    NativeBoard::SetPin(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return NativeBoard::GetPin(pin);
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    // a floating pin, the firmware seeds its random numbers with it
+    static std::random_device noise;
+    return (uint16_t)(noise() & 0xFFF);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeoutUs)
+{
+    unsigned long start = micros();
+    // a pulse already in progress does not count
+    while (digitalRead(pin) == state) {
+        if (micros() - start >= timeoutUs) {
+            return 0;
+        }
+        delayMicroseconds(10);
+    }
+    while (digitalRead(pin) != state) {
+        if (micros() - start >= timeoutUs) {
+            return 0;
+        }
+        delayMicroseconds(10);
+    }
+    unsigned long pulseStart = micros();
+    while (digitalRead(pin) == state) {
+        if (micros() - start >= timeoutUs) {
+            return 0;
+        }
+        delayMicroseconds(10);
+    }
+    return micros() - pulseStart;
+}
+
+/** Runs a handler without argument, attachInterrupt() passes it as the argument of this one */
+static void CallHandler(void* handler)
+{
+    ((void (*)(void))handler)();
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+    NativeBoard::AttachInterrupt(pin, CallHandler, (void*)handler, mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode)
+{
+    NativeBoard::AttachInterrupt(pin, handler, arg, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    NativeBoard::DetachInterrupt(pin);
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolutionBits)
+{
+    return channel < ledcChannelCount ? frequency : 0;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel)
+{
+}
+
+void ledcDetachPin(uint8_t pin)
+{
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    NativeBoard::SetLedDuty(channel, duty);
+}
+
+uint32_t ledcRead(uint8_t channel)
+{
+    return NativeBoard::GetLedDuty(channel);
+}
@@ -0,0 +1,140 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <Update.h>
+
+/** The first byte of an ESP32 application image */
+static const uint8_t imageMagic = 0xE9;
+
+UpdateClass Update;
+
+UpdateClass::UpdateClass() : partition(nullptr), updateSize(0), written(0), erased(0), command(U_FLASH), error(UPDATE_ERROR_OK)
+{
+}
+
+bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, const char* label)
+{
+    if (partition != nullptr) {
+        error = UPDATE_ERROR_BAD_ARGUMENT;
+        return false;
+    }
+    Reset();
+    error = UPDATE_ERROR_OK;
+    if (size == 0) {
+        error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+    const esp_partition_t* target = nullptr;
+    if (command == U_FLASH) {
+        target = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, label);
+    } else if (command == U_SPIFFS) {
+        target = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, label);
+    }
+    if (target == nullptr) {
+        error = UPDATE_ERROR_NO_PARTITION;
+        return false;
+    }
+    if (size == UPDATE_SIZE_UNKNOWN) {
+        size = target->size;
+    } else if (size > target->size) {
+        error = UPDATE_ERROR_SIZE;
+        return false;
+    }
+    partition = target;
+    updateSize = size;
+    this->command = command;
+    return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t length)
+{
+    if (partition == nullptr || hasError()) {
+        return 0;
+    }
+    if (length > remaining()) {
+        error = UPDATE_ERROR_SPACE;
+        return 0;
+    }
+    if (command == U_FLASH && written == 0 && length > 0 && data[0] != imageMagic) {
+        error = UPDATE_ERROR_MAGIC_BYTE;
+        return 0;
+    }
+    // erases the sectors just before they are written, like the ESP32
+    size_t end = written + length;
+    if (end > erased) {
+        size_t eraseEnd = (end + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE;
+        if (esp_partition_erase_range(partition, erased, eraseEnd - erased) != ESP_OK) {
+            error = UPDATE_ERROR_ERASE;
+            return 0;
+        }
+        erased = eraseEnd;
+    }
+    if (esp_partition_write(partition, written, data, length) != ESP_OK) {
+        error = UPDATE_ERROR_WRITE;
+        return 0;
+    }
+    written = end;
+    return length;
+}
+
+bool UpdateClass::end(bool evenIfRemaining)
+{
+    if (partition == nullptr || hasError()) {
+        return false;
+    }
+    if (remaining() > 0 && !evenIfRemaining) {
+        error = UPDATE_ERROR_ABORT;
+        Reset();
+        return false;
+    }
+    Reset();
+    return true;
+}
+
+void UpdateClass::abort()
+{
+    Reset();
+    error = UPDATE_ERROR_ABORT;
+}
+
+void UpdateClass::printError(Print& out)
+{
+    out.println(errorString());
+}
+
+const char* UpdateClass::errorString()
+{
+    switch (error) {
+        case UPDATE_ERROR_OK: return "No Error";
+        case UPDATE_ERROR_WRITE: return "Flash Write Failed";
+        case UPDATE_ERROR_ERASE: return "Flash Erase Failed";
+        case UPDATE_ERROR_SPACE: return "Not Enough Space";
+        case UPDATE_ERROR_SIZE: return "Bad Size Given";
+        case UPDATE_ERROR_MAGIC_BYTE: return "Wrong Magic Byte";
+        case UPDATE_ERROR_NO_PARTITION: return "Partition Could Not be Found";
+        case UPDATE_ERROR_BAD_ARGUMENT: return "Bad Argument";
+        case UPDATE_ERROR_ABORT: return "Aborted";
+        default: return "UNKNOWN";
+    }
+}
+
+void UpdateClass::Reset()
+{
+    partition = nullptr;
+    updateSize = 0;
+    written = 0;
+    erased = 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <WString.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+const String emptyString;
+
+/** Formats an integer in a base of 2 to 36, like utoa() of the Arduino core */
+static std::string FormatInteger(unsigned long long value, bool negative, unsigned char base)
+{
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char digits[66];
+    char* end = digits + sizeof(digits);
+    char* position = end;
+    do {
+        unsigned digit = (unsigned)(value % base);
+        *--position = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        *--position = '-';
+    }
+    return std::string(position, end);
+}
+
+static std::string FormatSigned(long long value, unsigned char base)
+{
+    // only decimal numbers carry a sign, like on the ESP32
+    if (base == 10 && value < 0) {
+        return FormatInteger(0ULL - (unsigned long long)value, true, base);
+    }
+    return FormatInteger((unsigned long long)value, false, base);
+}
+
+static std::string FormatReal(double value, unsigned int decimalPlaces)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimalPlaces, value);
+    return buffer;
+}
+
+String::String(const char* text) : text(text != nullptr ? text : "") {}
+String::String(const char* text, size_t length) : text(text != nullptr ? std::string(text, length) : "") {}
+String::String(const std::string& text) : text(text) {}
+String::String(char c) : text(1, c) {}
+String::String(unsigned char value, unsigned char base) : text(FormatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : text(FormatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : text(FormatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) : text(FormatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : text(FormatInteger(value, false, base)) {}
+String::String(long long value, unsigned char base) : text(FormatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : text(FormatInteger(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces) : text(FormatReal(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : text(FormatReal(value, decimalPlaces)) {}
+
+String& String::operator=(const char* text)
+{
+    this->text = text != nullptr ? text : "";
+    return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+    text.reserve(size);
+    return true;
+}
+
+bool String::concat(const String& other)
+{
+    text += other.text;
+    return true;
+}
+
+bool String::concat(const char* other)
+{
+    if (other == nullptr) {
+        return false;
+    }
+    text += other;
+    return true;
+}
+
+bool String::concat(const char* other, unsigned int length)
+{
+    if (other == nullptr) {
+        return false;
+    }
+    text.append(other, length);
+    return true;
+}
+
+bool String::concat(char c)
+{
+    text += c;
+    return true;
+}
+
+bool String::concat(int value)
+{
+    text += FormatSigned(value, 10);
+    return true;
+}
+
+bool String::concat(unsigned int value)
+{
+    text += FormatInteger(value, false, 10);
+    return true;
+}
+
+bool String::concat(long value)
+{
+    text += FormatSigned(value, 10);
+    return true;
+}
+
+bool String::concat(unsigned long value)
+{
+    text += FormatInteger(value, false, 10);
+    return true;
+}
+
+bool String::concat(double value)
+{
+    text += FormatReal(value, 2);
+    return true;
+}
+
+bool String::equalsIgnoreCase(const String& other) const
+{
+    return text.length() == other.text.length() && strcasecmp(text.c_str(), other.text.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const
+{
+    return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const
+{
+    return offset <= text.length() && text.compare(offset, prefix.text.length(), prefix.text) == 0;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+    return suffix.text.length() <= text.length() &&
+        text.compare(text.length() - suffix.text.length(), suffix.text.length(), suffix.text) == 0;
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+    if (index < text.length()) {
+        text[index] = c;
+    }
+}
+
+char& String::operator[](unsigned int index)
+{
+    static char dummy;
+    if (index >= text.length()) {
+        dummy = 0;
+        return dummy;
+    }
+    return text[index];
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const
+{
+    size_t index = text.find(c, fromIndex);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::indexOf(const String& other, unsigned int fromIndex) const
+{
+    size_t index = text.find(other.text, fromIndex);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::indexOf(const char* other, unsigned int fromIndex) const
+{
+    return other != nullptr ? indexOf(String(other), fromIndex) : -1;
+}
+
+int String::lastIndexOf(char c) const
+{
+    size_t index = text.rfind(c);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::lastIndexOf(const String& other) const
+{
+    size_t index = text.rfind(other.text);
+    return index == std::string::npos ? -1 : (int)index;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+    return substring(beginIndex, length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    // the indices may be swapped, like in the Arduino core
+    if (beginIndex > endIndex) {
+        unsigned int swap = beginIndex;
+        beginIndex = endIndex;
+        endIndex = swap;
+    }
+    if (beginIndex >= text.length()) {
+        return String();
+    }
+    return String(text.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(const String& find, const String& replacement)
+{
+    if (find.text.empty()) {
+        return;
+    }
+    size_t index = 0;
+    while ((index = text.find(find.text, index)) != std::string::npos) {
+        text.replace(index, find.text.length(), replacement.text);
+        index += replacement.text.length();
+    }
+}
+
+void String::remove(unsigned int index)
+{
+    if (index < text.length()) {
+        text.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index < text.length()) {
+        text.erase(index, count);
+    }
+}
+
+void String::toLowerCase()
+{
+    for (char& c : text) {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase()
+{
+    for (char& c : text) {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+void String::trim()
+{
+    size_t begin = 0;
+    size_t end = text.length();
+    while (begin < end && isspace((unsigned char)text[begin])) {
+        begin++;
+    }
+    while (end > begin && isspace((unsigned char)text[end - 1])) {
+        end--;
+    }
+    text = text.substr(begin, end - begin);
+}
+
+long String::toInt() const
+{
+    return atol(text.c_str());
+}
+
+float String::toFloat() const
+{
+    return (float)atof(text.c_str());
+}
+
+double String::toDouble() const
+{
+    return atof(text.c_str());
+}
+
+bool operator==(const String& left, const String& right) { return left.equals(right); }
+bool operator==(const String& left, const char* right) { return left.equals(right); }
+bool operator==(const char* left, const String& right) { return right.equals(left); }
+bool operator!=(const String& left, const String& right) { return !left.equals(right); }
+bool operator!=(const String& left, const char* right) { return !left.equals(right); }
+bool operator!=(const char* left, const String& right) { return !right.equals(left); }
+bool operator<(const String& left, const String& right) { return left.compareTo(right) < 0; }
+
+String operator+(const String& left, const String& right)
+{
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const String& left, const char* right)
+{
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const char* left, const String& right)
+{
+    String result(left);
+    result.concat(right);
+    return result;
+}
+
+String operator+(const String& left, char right)
+{
+    String result(left);
+    result.concat(right);
+    return result;
+}
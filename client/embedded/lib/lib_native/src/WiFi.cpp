@@ -0,0 +1,104 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <WiFi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+WiFiClass WiFi;
+
+/** The MAC address of the simulated board, a locally administered one */
+static const uint8_t boardMac[6] = { 0x02, 0x47, 0x46, 0x00, 0x00, 0x01 };
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(text);
+}
+
+WiFiClass::WiFiClass() : currentMode(WIFI_OFF), scanCount(0)
+{
+}
+
+bool WiFiClass::mode(wifi_mode_t mode)
+{
+    currentMode = mode;
+    return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int hidden, int maxConnections)
+{
+    apSsid = ssid;
+    fprintf(stderr, "[NativeBoard] Soft AP '%s' started\n", ssid);
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff)
+{
+    apSsid = "";
+    return true;
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden)
+{
+    const char* networks = getenv("GOALFINDER_WIFI_NETWORKS");
+    scanResult = networks != nullptr ? networks : "";
+    scanCount = 0;
+    if (!scanResult.isEmpty()) {
+        scanCount = 1;
+        for (int i = scanResult.indexOf(','); i >= 0; i = scanResult.indexOf(',', i + 1)) {
+            scanCount++;
+        }
+    }
+    return scanCount;
+}
+
+String WiFiClass::SSID(uint8_t index)
+{
+    int start = 0;
+    for (uint8_t i = 0; i < index && start >= 0; i++) {
+        start = scanResult.indexOf(',', start);
+        start = start >= 0 ? start + 1 : -1;
+    }
+    if (index >= scanCount || start < 0) {
+        return String();
+    }
+    int end = scanResult.indexOf(',', start);
+    return scanResult.substring(start, end >= 0 ? end : scanResult.length());
+}
+
+void WiFiClass::scanDelete()
+{
+    scanResult = "";
+    scanCount = 0;
+}
+
+String WiFiClass::macAddress()
+{
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+        boardMac[0], boardMac[1], boardMac[2], boardMac[3], boardMac[4], boardMac[5]);
+    return String(text);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac)
+{
+    for (int i = 0; i < 6; i++) {
+        mac[i] = boardMac[i];
+    }
+    return mac;
+}
@@ -0,0 +1,80 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <Wire.h>
+#include <Adafruit_VL53L0X.h>
+#include <Arduino.h>
+#include <NativeBoard.h>
+
+TwoWire Wire(0);
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    started = true;
+    return true;
+}
+
+bool TwoWire::end()
+{
+    started = false;
+    return true;
+}
+
+bool Adafruit_VL53L0X::begin(uint8_t address, bool debug, TwoWire* i2c)
+{
+    wire = i2c;
+    return wire != nullptr && wire->isStarted();
+}
+
+void Adafruit_VL53L0X::rangingTest(VL53L0X_RangingMeasurementData_t* data, bool debug)
+{
+    memset(data, 0, sizeof(*data));
+    delayMicroseconds(timingBudgetUs);
+    int distance = NativeBoard::GetDistance();
+    data->MeasurementTimeUsec = timingBudgetUs;
+    data->TimeStamp = millis();
+    // a phase failure (4) is what the sensor reports without a target
+    data->RangeStatus = distance < 0 ? 4 : 0;
+    data->RangeMilliMeter = distance < 0 ? 0 : (uint16_t)distance;
+}
+
+bool Adafruit_VL53L0X::startRangeContinuous(uint16_t periodMs)
+{
+    if (wire == nullptr) {
+        return false;
+    }
+    periodUs = max((unsigned long)periodMs * 1000UL, timingBudgetUs);
+    startUs = micros();
+    continuous = true;
+    return true;
+}
+
+void Adafruit_VL53L0X::stopRangeContinuous()
+{
+    continuous = false;
+}
+
+bool Adafruit_VL53L0X::isRangeComplete()
+{
+    return continuous && micros() - startUs >= periodUs;
+}
+
+uint16_t Adafruit_VL53L0X::readRangeResult()
+{
+    int distance = NativeBoard::GetDistance();
+    startUs = micros();
+    return distance < 0 ? outOfRange : (uint16_t)distance;
+}
@@ -0,0 +1,34 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include <Arduino.h>
+#include <NativeBoard.h>
+
+// the tests of pio test have their own main()
+#ifndef PIO_UNIT_TESTING
+
+/** Runs the sketch like the loop task of the Arduino core, on the main thread. */
+int main(int argc, char** argv)
+{
+    NativeBoard::Init(argc, argv);
+    setup();
+    NativeBoard::Begin();
+    while (true) {
+        loop();
+    }
+}
+
+#endif
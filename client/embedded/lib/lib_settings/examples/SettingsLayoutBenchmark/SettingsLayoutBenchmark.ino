@@ -0,0 +1,97 @@
+/*
+ * Compares loading and saving the settings of the app as separate keys with
+ * loading and saving them as one blob (see SettingsBlob.h).
+ *
+ * Flash this sketch and open the serial monitor (115200 baud). The settings
+ * are written to a namespace of their own, which is cleared at the end. The
+ * average time of a load and a save of all settings is printed per layout.
+ */
+#include <Arduino.h>
+#include <system/Settings.h>
+#include <system/SettingsBlob.h>
+
+/** The layout of the settings of the app */
+struct SampleSettings
+{
+    int32_t values[13];
+    char deviceName[33];
+    char devicePassword[65];
+    char wifiPassword[64];
+    bool flags[4];
+};
+
+static const char* intKeys[] = { "volume", "metronomeSound", "metronomeBpm", "hitSound", "missSound", "shotSensitivity", 
+    "ballHitDetDist", "ledBrightness", "ledMode", "afterHitTimeout", "distOnlyHitDet", "firstRun", "extraLog" };
+static const int runs = 50;
+
+static void LoadKeys(System::Settings& store, SampleSettings& settings)
+{
+    for (int i = 0; i < 13; i++) {
+        settings.values[i] = store.GetInt(intKeys[i], 0);
+    }
+    store.GetString("deviceName", settings.deviceName, sizeof(settings.deviceName));
+    store.GetString("devicePassword", settings.devicePassword, sizeof(settings.devicePassword));
+    store.GetString("wifiPassword", settings.wifiPassword, sizeof(settings.wifiPassword));
+    settings.flags[0] = store.GetInt("updateSuccess", 0);
+}
+
+static void SaveKeys(System::Settings& store, const SampleSettings& settings)
+{
+    for (int i = 0; i < 13; i++) {
+        store.PutInt(intKeys[i], settings.values[i]);
+    }
+    store.PutString("deviceName", settings.deviceName);
+    store.PutString("devicePassword", settings.devicePassword);
+    store.PutString("wifiPassword", settings.wifiPassword);
+    store.PutInt("updateSuccess", settings.flags[0]);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    System::Settings store;
+    if (!store.Begin("layoutbench")) {
+        Serial.println("NVS not available");
+        return;
+    }
+    store.Clear();
+    System::SettingsBlob<SampleSettings> blob(store, "settings", 1);
+
+    SampleSettings settings;
+    memset(&settings, 0, sizeof(settings));
+    strcpy(settings.deviceName, "GoalFinder 01");
+    strcpy(settings.wifiPassword, "goalfinder");
+
+    unsigned long keysSaveUs = 0, keysLoadUs = 0, blobSaveUs = 0, blobLoadUs = 0;
+    for (int run = 0; run < runs; run++) {
+        // one changed value per save, like a change in the web app
+        settings.values[0] = run;
+
+        unsigned long start = micros();
+        SaveKeys(store, settings);
+        keysSaveUs += micros() - start;
+        start = micros();
+        LoadKeys(store, settings);
+        keysLoadUs += micros() - start;
+
+        start = micros();
+        blob.Save(settings);
+        blobSaveUs += micros() - start;
+        start = micros();
+        if (!blob.Load(settings)) {
+            Serial.println("Blob could not be loaded");
+        }
+        blobLoadUs += micros() - start;
+    }
+    store.Clear();
+
+    Serial.printf("%u bytes of settings, %d runs\n", (unsigned)sizeof(SampleSettings), runs);
+    Serial.println("layout        load us    save us");
+    Serial.printf("keys       %10lu %10lu\n", keysLoadUs / runs, keysSaveUs / runs);
+    Serial.printf("blob       %10lu %10lu\n", blobLoadUs / runs, blobSaveUs / runs);
+}
+
+void loop()
+{
+    delay(1000);
+}
@@ -0,0 +1,96 @@
+/*
+ * Compares the put throughput and the flash bytes written per update of the
+ * ESP8266 Settings HAL, an append-only log of records, with the JSON file it
+ * replaced, which serialized the whole document on every put.
+ *
+ * Flash this sketch to an ESP8266 and open the serial monitor (115200 baud).
+ * Both stores are filled with the keys of the app, then one value is changed
+ * per update, like a change in the web app. Their files are removed at the
+ * end. The bytes written count what reaches the file system, the log
+ * includes its compactions.
+ */
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <system/Settings.h>
+
+static const char* intKeys[] = { "volume", "metronomeSound", "metronomeBpm", "hitSound", "missSound", "shotSensitivity",
+    "ballHitDetDist", "ledBrightness", "ledMode", "afterHitTimeout", "distOnlyHitDet", "firstRun", "extraLog" };
+static const int intKeyCount = sizeof(intKeys) / sizeof(intKeys[0]);
+static const char* jsonPath = "/nvs/jsonbench.pref";
+static const char* logPath = "/nvs/logbench.log";
+static const int updates = 200;
+
+/** The previous backend: the document in RAM, rewritten into a truncated file per put */
+static size_t PutJson(JsonDocument& doc, const char* key, int32_t value)
+{
+    JsonObject entry = doc[key].to<JsonObject>();
+    entry["t"] = (int)System::PT_I32;
+    entry["v"] = value;
+    File file = LittleFS.open(jsonPath, "w");
+    size_t written = serializeJson(doc, file);
+    file.close();
+    return written;
+}
+
+static size_t GetFileSize(const char* path)
+{
+    File file = LittleFS.open(path, "r");
+    size_t size = file ? file.size() : 0;
+    file.close();
+    return size;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    if (!LittleFS.begin()) {
+        Serial.println("LittleFS not available");
+        return;
+    }
+    LittleFS.mkdir("/nvs");
+
+    JsonDocument doc;
+    for (int i = 0; i < intKeyCount; i++) {
+        PutJson(doc, intKeys[i], 0);
+    }
+    unsigned long jsonUs = 0;
+    size_t jsonBytes = 0;
+    for (int run = 0; run < updates; run++) {
+        unsigned long start = micros();
+        jsonBytes += PutJson(doc, intKeys[run % intKeyCount], run + 1);
+        jsonUs += micros() - start;
+    }
+    LittleFS.remove(jsonPath);
+
+    System::Settings store;
+    store.Begin("logbench");
+    store.Clear();
+    for (int i = 0; i < intKeyCount; i++) {
+        store.PutInt(intKeys[i], 0);
+    }
+    unsigned long logUs = 0;
+    size_t logBytes = 0;
+    size_t logSize = GetFileSize(logPath);
+    for (int run = 0; run < updates; run++) {
+        unsigned long start = micros();
+        store.PutInt(intKeys[run % intKeyCount], run + 1);
+        logUs += micros() - start;
+        // a smaller file was compacted, all of it was written
+        size_t size = GetFileSize(logPath);
+        logBytes += size > logSize ? size - logSize : size;
+        logSize = size;
+    }
+    store.End();
+    LittleFS.remove(logPath);
+
+    Serial.printf("%d keys, %d updates\n", intKeyCount, updates);
+    Serial.println("backend     puts/s   B/update");
+    Serial.printf("json     %9lu %10u\n", updates * 1000000UL / max(jsonUs, 1UL), (unsigned)(jsonBytes / updates));
+    Serial.printf("log      %9lu %10u\n", updates * 1000000UL / max(logUs, 1UL), (unsigned)(logBytes / updates));
+}
+
+void loop()
+{
+    delay(1000);
+}
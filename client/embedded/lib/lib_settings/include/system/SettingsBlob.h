@@ -0,0 +1,85 @@
+/*
+ * ===============================================================================
+ * (c) HTL Leonding
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "system/Settings.h"
+
+namespace System {
+
+/** Provides the CRC-32 (IEEE 802.3) of a block of bytes. */
+uint32_t SettingsCrc32(const void* data, size_t size);
+
+/**
+ * Keeps a struct of settings as a single blob under one key, so that it is
+ * read with one GetBytes() and written with one PutBytes() instead of one
+ * lookup per value.
+ *
+ * The blob starts with a version and the size of the struct and ends with a
+ * CRC of it. Load() fails for a missing or corrupt blob and for one of
+ * another layout, so a change of the struct needs a new version and a
+ * conversion of the previous one by the caller.
+ */
+template <typename T>
+class SettingsBlob {
+	static_assert(std::is_trivially_copyable<T>::value, "The settings are stored as their bytes");
+
+	public:
+		SettingsBlob(Settings& store, const char* key, uint16_t version) :
+				mStore(store), mKey(key), mVersion(version) {
+		}
+
+		/** Reads the struct, returns false if there is no valid blob of this version. */
+		bool Load(T& data) {
+			Record record;
+			if (mStore.GetBytes(mKey, &record, sizeof(record)) != sizeof(record)
+					|| record.version != mVersion || record.size != sizeof(T)
+					|| record.crc != SettingsCrc32(&record.data, sizeof(T))) {
+				return false;
+			}
+			data = record.data;
+			return true;
+		}
+
+		bool Save(const T& data) {
+			Record record;
+			memset(&record, 0, sizeof(record));
+			record.version = mVersion;
+			record.size = sizeof(T);
+			record.data = data;
+			record.crc = SettingsCrc32(&record.data, sizeof(T));
+			return mStore.PutBytes(mKey, &record, sizeof(record)) == sizeof(record);
+		}
+
+	private:
+		struct Record {
+			uint16_t version;
+			uint16_t size;
+			uint32_t crc;
+			T data;
+		};
+
+		Settings& mStore;
+		const char* mKey;
+		uint16_t mVersion;
+};
+
+} // namespace System
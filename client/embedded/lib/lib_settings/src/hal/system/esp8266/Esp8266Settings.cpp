@@ -1,186 +1,342 @@
-
 // #ifdef ESP8266
 #pragma message("ESP8266: Preferences HAL")
 
-#include <rfs/RootFileSystem.h>
-#include <utils/StringUtils.h>
+#include <system/Settings.h>
+#include <system/SettingsBlob.h>
+#include <LittleFS.h>
+#include <vector>
 #include "util/Logger.h"
 
 namespace System {
-// using namespace Rfs;
-
 
+/*
+ * The settings of a namespace are an append-only log of records in a file on
+ * LittleFS. A put appends one record of the key and its value and flushes the
+ * file, a remove appends a record without a value. The latest record of a key
+ * wins, the values are kept in RAM, so a get never reads the file.
+ *
+ * Once the log exceeds mMaxLogSize and at least half of it are replaced
+ * records, it is compacted: the live records are written to a new file, which
+ * is renamed over the log. A record torn by a power loss fails its CRC and
+ * ends the log when it is read, the records before it are kept.
+ *
+ * Record (8-byte header + key + value):
+ *   Bytes 0-3:  CRC-32 of the following bytes of the record
+ *   Byte  4:    SettingsType of the value, PT_INVALID for a removed key
+ *   Byte  5:    Key length
+ *   Bytes 6-7:  Value length (uint16_t, little-endian)
+ */
 struct Settings::SettingsInstanceData {
+	struct RecordHeader {
+		uint32_t crc;
+		uint8_t type;
+		uint8_t keyLength;
+		uint16_t valueLength;
+	};
+
+	struct Entry {
+		String key;
+		SettingsType type;
+		std::vector<uint8_t> value;
+
+		size_t RecordSize() const {
+			return sizeof(RecordHeader) + key.length() + value.size();
+		}
+	};
+
 	const char* mNvsPath = "/nvs";
 	const char* mDefaultFileName = "unnamed";
-	const char* mFileNameExtension = ".pref";
+	const char* mFileNameExtension = ".log";
+	const char* mCompactExtension = ".tmp";
+	/** The key length limit of NVS */
+	static const size_t mMaxKeyLength = 15;
+	static const size_t mMaxValueLength = 4000;
+	static const size_t mMaxLogSize = 4096;
+
+	String mPath;
+	String mCompactPath;
+	File mFile;
+	std::vector<Entry> mEntries;
+	/** The bytes of all records in the log and of the latest record of each key */
+	size_t mLogSize = 0;
+	size_t mLiveSize = 0;
+
+	bool Open(const char* name, bool readOnly) {
+		if (!LittleFS.begin()) {
+			LOG(Settings, ERROR, "Failed mounting LittleFS");
+			return false;
+		}
+		if (!LittleFS.exists(mNvsPath) && !LittleFS.mkdir(mNvsPath)) {
+			LOG(Settings, ERROR, "Failed accessing NVS directory '%s'", mNvsPath);
+			return false;
+		}
+		mPath = String(mNvsPath) + '/' + (name != 0 ? name : mDefaultFileName);
+		mCompactPath = mPath + mCompactExtension;
+		mPath += mFileNameExtension;
+
+		// a compaction interrupted before its rename leaves the log intact, after it only the new file
+		if (LittleFS.exists(mCompactPath)) {
+			if (LittleFS.exists(mPath)) {
+				LittleFS.remove(mCompactPath);
+			} else {
+				LittleFS.rename(mCompactPath, mPath);
+			}
+		}
+
+		bool complete = Replay();
+		LOG(Settings, DEBUG, "Read %u keys from '%s', %u of %u B live", (unsigned)mEntries.size(), mPath.c_str(),
+			(unsigned)mLiveSize, (unsigned)mLogSize);
+		if (readOnly) {
+			return true;
+		}
+		if (!complete) {
+			LOG(Settings, WARN, "Dropping the torn end of '%s'", mPath.c_str());
+			return Compact();
+		}
+		mFile = LittleFS.open(mPath, "a");
+		if (!mFile) {
+			LOG(Settings, ERROR, "Failed opening preferences file '%s'.", mPath.c_str());
+		}
+		return (bool)mFile;
+	}
 
-	// File mFile;
-	JsonDocument  mDoc(512);
+	void Close() {
+		if (mFile) {
+			mFile.close();
+		}
+		mEntries.clear();
+		mLogSize = 0;
+		mLiveSize = 0;
+	}
 
-	bool PutValue(const char* key, SettingsType type, ::std::function<void(JsonVariant& valueNode)> valueSupplier) {
-		bool rc = false;
-		if (mInitialized && key != 0 && !mReadOnly && mFile) {
-			JsonObject valObj = mDoc[key];
-			if (valObj == 0) {
-				valObj = mDoc.createNestedObject(key);
+	/** Reads the log into the entries, returns false if it ends with an invalid record. */
+	bool Replay() {
+		File file = LittleFS.open(mPath, "r");
+		if (!file) {
+			return true;
+		}
+		size_t fileSize = file.size();
+		std::vector<uint8_t> record;
+		RecordHeader header;
+		while (mLogSize < fileSize) {
+			if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)
+					|| header.keyLength == 0 || header.keyLength > mMaxKeyLength || header.valueLength > mMaxValueLength) {
+				break;
+			}
+			size_t size = sizeof(header) + header.keyLength + header.valueLength;
+			record.resize(size);
+			memcpy(record.data(), &header, sizeof(header));
+			if (file.read(record.data() + sizeof(header), size - sizeof(header)) != size - sizeof(header)
+					|| header.crc != SettingsCrc32(record.data() + sizeof(header.crc), size - sizeof(header.crc))) {
+				break;
 			}
-			valObj["t"] = type;
-			JsonVariant val = valObj["v"].to<JsonVariant>();
-			valueSupplier(val);
-			rc = (serializeJson(mDoc, mFile) > 0);
-			mFile.flush();
+			String key;
+			key.concat((const char*)record.data() + sizeof(header), header.keyLength);
+			Apply(key.c_str(), (SettingsType)header.type, record.data() + sizeof(header) + header.keyLength, header.valueLength);
+			mLogSize += size;
 		}
-		return rc;
+		file.close();
+		return mLogSize == fileSize;
 	}
 
-	JsonVariant GetValue(const char* key, SettingsType type) {
-		JsonVariant value;
-		if (mInitialized && key != 0) {
-			JsonObject valObj = mDoc[key];
-			if (valObj != 0 && (SettingsType)valObj["t"] == type) {
-				value = valObj["v"].as<JsonVariant>();
+	Entry* Find(const char* key) {
+		for (Entry& entry : mEntries) {
+			if (entry.key == key) {
+				return &entry;
 			}
 		}
-		return value;
+		return nullptr;
 	}
 
-	size_t GetBlob(const char* key, void* buf, size_t maxLen, bool asCStr) {
-		size_t len = 0;
-		JsonVariant value = GetValue(key, SettingsType::PT_STR);
-		if (value.is<String>()) {
-			String strVal = value.as<String>();
-			if (strVal.length() <= maxLen) {
-				len = strVal.length();
-				memcpy(buf, strVal.c_str(), len + (asCStr ? 1 : 0));
+	/** Updates the entries with a record. */
+	void Apply(const char* key, SettingsType type, const void* value, size_t length) {
+		Entry* entry = Find(key);
+		if (entry != nullptr) {
+			mLiveSize -= entry->RecordSize();
+			if (type == SettingsType::PT_INVALID) {
+				*entry = mEntries.back();
+				mEntries.pop_back();
+				return;
 			}
+		} else if (type == SettingsType::PT_INVALID) {
+			return;
+		} else {
+			mEntries.push_back(Entry());
+			entry = &mEntries.back();
+			entry->key = key;
+		}
+		entry->type = type;
+		entry->value.assign((const uint8_t*)value, (const uint8_t*)value + length);
+		mLiveSize += entry->RecordSize();
+	}
+
+	bool Put(const char* key, SettingsType type, const void* value, size_t length) {
+		size_t keyLength = strlen(key);
+		if (keyLength == 0 || keyLength > mMaxKeyLength || length > mMaxValueLength) {
+			LOG(Settings, ERROR, "Invalid key '%s' or value of %u B", key, (unsigned)length);
+			return false;
+		}
+		Entry* entry = Find(key);
+		if (entry != nullptr && entry->type == type && entry->value.size() == length
+				&& memcmp(entry->value.data(), value, length) == 0) {
+			// an unchanged value is not written again
+			return true;
+		}
+		size_t size = sizeof(RecordHeader) + keyLength + length;
+		if (mLogSize + size > mMaxLogSize && (mLogSize - mLiveSize) * 2 >= mLogSize) {
+			Apply(key, type, value, length);
+			return Compact();
+		}
+		if (!Append(mFile, key, type, value, length)) {
+			return false;
+		}
+		Apply(key, type, value, length);
+		mLogSize += size;
+		return true;
+	}
+
+	bool Remove(const char* key) {
+		if (Find(key) == nullptr) {
+			return true;
+		}
+		if (!Append(mFile, key, SettingsType::PT_INVALID, nullptr, 0)) {
+			return false;
+		}
+		Apply(key, SettingsType::PT_INVALID, nullptr, 0);
+		mLogSize += sizeof(RecordHeader) + strlen(key);
+		return true;
+	}
+
+	bool Clear() {
+		mEntries.clear();
+		mLiveSize = 0;
+		return Compact();
+	}
+
+	/** Writes one record with a single write and flushes it. */
+	static bool Append(File& file, const char* key, SettingsType type, const void* value, size_t length) {
+		if (!file) {
+			return false;
+		}
+		RecordHeader header;
+		header.type = (uint8_t)type;
+		header.keyLength = (uint8_t)strlen(key);
+		header.valueLength = (uint16_t)length;
+		size_t size = sizeof(header) + header.keyLength + length;
+		std::vector<uint8_t> record(size);
+		memcpy(record.data(), &header, sizeof(header));
+		memcpy(record.data() + sizeof(header), key, header.keyLength);
+		if (length > 0) {
+			memcpy(record.data() + sizeof(header) + header.keyLength, value, length);
+		}
+		header.crc = SettingsCrc32(record.data() + sizeof(header.crc), size - sizeof(header.crc));
+		memcpy(record.data(), &header.crc, sizeof(header.crc));
+		bool written = file.write(record.data(), size) == size;
+		file.flush();
+		return written;
+	}
+
+	/** Writes the entries to a new log, which replaces the current one. */
+	bool Compact() {
+		if (mFile) {
+			mFile.close();
+		}
+		File file = LittleFS.open(mCompactPath, "w");
+		bool rc = (bool)file;
+		for (const Entry& entry : mEntries) {
+			rc = rc && Append(file, entry.key.c_str(), entry.type, entry.value.data(), entry.value.size());
+		}
+		if (file) {
+			file.close();
+		}
+		if (rc && !LittleFS.rename(mCompactPath, mPath)) {
+			// Open() completes the rename if it is interrupted here
+			rc = LittleFS.remove(mPath) && LittleFS.rename(mCompactPath, mPath);
+		}
+		if (rc) {
+			LOG(Settings, DEBUG, "Compacted '%s' from %u to %u B", mPath.c_str(), (unsigned)mLogSize, (unsigned)mLiveSize);
+			mLogSize = mLiveSize;
+		} else {
+			LOG(Settings, ERROR, "Failed compacting preferences file '%s'.", mPath.c_str());
+		}
+		mFile = LittleFS.open(mPath, "a");
+		return rc && mFile;
+	}
+
+	template <typename T>
+	size_t PutValue(const char* key, SettingsType type, T value) {
+		return Put(key, type, &value, sizeof(T)) ? sizeof(T) : 0;
+	}
+
+	template <typename T>
+	T GetValue(const char* key, SettingsType type, T defaultValue) {
+		Entry* entry = Find(key);
+		if (entry == nullptr || entry->type != type || entry->value.size() != sizeof(T)) {
+			return defaultValue;
 		}
-		return len;
+		T value;
+		memcpy(&value, entry->value.data(), sizeof(T));
+		return value;
 	}
 };
 
 Settings::Settings() :
         mInitialized(false), mReadOnly(false), mInstanceData(0) {
-			SettingsInstanceData* instanceData = new SettingsInstanceData();
-			mInstanceData = instanceData;
+	mInstanceData = new SettingsInstanceData();
 }
 
 Settings::~Settings() {
 	End();
+	delete mInstanceData;
 }
 
-bool Settings::Begin(const char* name, bool readOnly, const char* partition_label) { 
+bool Settings::Begin(const char* name, bool readOnly, const char* partition_label) {
 	(void)partition_label; // partition_label is not used by this implementation
-	bool rc = mInitialized;
 	if (!mInitialized) {
 		mReadOnly = readOnly;
-		RootFileSystem* rfs = RootFileSystem::GetInstance();
-		if (rfs != 0) {
-			const char* filenNameCStr = name != 0 ? name : mDefaultFileName;
-			Logger::log("Settings", Logger::LogLevel::DEBUG, "pref. file: '%s'", filenNameCStr);
-			String prefFilePath(mNvsPath);
-			prefFilePath.reserve(1 + strlen(filenNameCStr) + strlen(mFileNameExtension) + 1);
-			prefFilePath.concat('/');
-			prefFilePath.concat(filenNameCStr);
-			prefFilePath.concat(mFileNameExtension);
-			Logger::log("Settings", Logger::LogLevel::DEBUG, "Opening preferences file '%s', RO: %c", prefFilePath.c_str(), readOnly ? 'Y' : 'N');
-			if (rfs->Exists(mNvsPath) || rfs->MkDir(mNvsPath)) {
-				mFile = rfs->Open(prefFilePath,
-				        (mReadOnly ? RootFileSystem::FileMode::Read : RootFileSystem::FileMode::WriteTruncate));
-				rc = (bool)mFile;
-				if (!rc) Logger::log("Settings", Logger::LogLevel::ERROR, "Failed opening preferences file '%s'.", prefFilePath.c_str());
-				if (rc) {
-					size_t bufferLen = mFile.size() + 1;
-					Logger::log("Settings", Logger::LogLevel::DEBUG, "Opened preferences file '%s', %d B", prefFilePath.c_str(), mFile.size());
-					uint8_t buffer[bufferLen];
-					size_t readLen = 0;
-					if (mFile.size() > 0) {
-						mFile.read(buffer, bufferLen);
-						buffer[readLen] = '\0';
-						Logger::log("Settings", Logger::LogLevel::DEBUG, "Deserializing JSON: '%s'", buffer);
-						DeserializationError res = deserializeJson(mDoc, buffer);
-						Logger::log("Settings", Logger::LogLevel::DEBUG, "Deserialized JSON");
-						rc = (res == DeserializationError::Ok);
-						if (!rc) Logger::log("Settings", Logger::LogLevel::ERROR, "Failed reading preferences from file '%s': %s", prefFilePath.c_str(), res.c_str());
-					}
-				}
-				if (mReadOnly && mFile) {
-					// the file can be closed immediately if preferences cannot be written
-					Logger::log("Settings", Logger::LogLevel::DEBUG, "closing file");
-					mFile.close();
-				}
-			} else {
-				Logger::log("Settings", Logger::LogLevel::ERROR, "Failed accessing NVS directory '%s'", mNvsPath);
-			}
-		} else {
-			Logger::log("Settings", Logger::LogLevel::ERROR, "Failed accessing RFS");
-		}
-		mInitialized = rc;
+		mInitialized = GetInstanceData()->Open(name, readOnly);
 	}
-	return rc;
+	return mInitialized;
 }
 
 void Settings::End() {
-	if (mFile) {
-		mFile.close();
-	}
+	GetInstanceData()->Close();
 	mInitialized = false;
 }
 
 /* Clear all keys in opened preferences */
 bool Settings::Clear() {
-	bool rc = !mReadOnly && mFile;
-	if (rc) {
-		mDoc.clear();
-		serializeJson(mDoc, mFile);
-	}
-	return rc;
+	return mInitialized && !mReadOnly && GetInstanceData()->Clear();
 }
 
 /* Remove a key */
 bool Settings::Remove(const char* key) {
-	bool rc = key != 0 && !mReadOnly && mFile;
-	if (rc) {
-		mDoc.remove(key);
-	}
-	return rc;
+	return mInitialized && key != 0 && !mReadOnly && GetInstanceData()->Remove(key);
 }
 
 /* Put a key value */
 size_t Settings::PutChar(const char* key, int8_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_I8, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 1 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I8, value) : 0;
 }
 
 size_t Settings::PutUChar(const char* key, uint8_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_U8, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 1 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U8, value) : 0;
 }
 
 size_t Settings::PutShort(const char* key, int16_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_I16, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 2 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I16, value) : 0;
 }
 
 size_t Settings::PutUShort(const char* key, uint16_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_U16, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 2 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U16, value) : 0;
 }
 
 size_t Settings::PutInt(const char* key, int32_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_I32, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 4 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I32, value) : 0;
 }
 
 size_t Settings::PutUInt(const char* key, uint32_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_U32, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 4 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U32, value) : 0;
 }
 
 size_t Settings::PutLong(const char* key, int32_t value) {
@@ -192,39 +348,31 @@ size_t Settings::PutULong(const char* key, uint32_t value) {
 }
 
 size_t Settings::PutLong64(const char* key, int64_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_I64, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 8 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I64, value) : 0;
 }
 
 size_t Settings::PutULong64(const char* key, uint64_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_U64, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? 8 : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U64, value) : 0;
 }
 
 size_t Settings::PutFloat(const char* key, const float_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_FLOAT, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? sizeof(float_t) : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_FLOAT, value) : 0;
 }
 
 size_t Settings::PutDouble(const char* key, const double_t value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_DOUBLE, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? sizeof(double_t) : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_DOUBLE, value) : 0;
 }
 
 size_t Settings::PutBool(const char* key, const bool value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_BOOL, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? sizeof(bool) : 0;
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_BOOL, value) : 0;
 }
 
 size_t Settings::PutString(const char* key, const char* value) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_STR, [value](JsonVariant& valueNode) {
-		valueNode.set(value);
-	}) ? strlen(value) : 0;
+	if (!mInitialized || key == 0 || value == 0 || mReadOnly) {
+		return 0;
+	}
+	size_t len = strlen(value);
+	return GetInstanceData()->Put(key, SettingsType::PT_STR, value, len) ? len : 0;
 }
 
 size_t Settings::PutString(const char* key, const String value) {
@@ -232,56 +380,44 @@ size_t Settings::PutString(const char* key, const String value) {
 }
 
 size_t Settings::PutBytes(const char* key, const void* value, size_t len) {
-	return GetInstanceData()->PutValue(key, SettingsType::PT_BLOB, [value, len](JsonVariant& valueNode) {
-		String byteStr = StringUtils::Of((const uint8_t*)value, len);
-		valueNode.set(byteStr.c_str());
-	}) ? len : 0;
+	if (!mInitialized || key == 0 || (value == 0 && len > 0) || mReadOnly) {
+		return 0;
+	}
+	return GetInstanceData()->Put(key, SettingsType::PT_BLOB, value, len) ? len : 0;
 }
 
 SettingsType Settings::GetType(const char* key) {
-	SettingsType type = SettingsType::PT_INVALID;
-	if (mInitialized && key != 0) {
-		JsonObject valObj = mDoc[key];
-		if (valObj != 0) {
-			type = (SettingsType)valObj["t"];
-		}
-	}
-	return type;
+	SettingsInstanceData::Entry* entry = mInitialized && key != 0 ? GetInstanceData()->Find(key) : nullptr;
+	return entry != nullptr ? entry->type : SettingsType::PT_INVALID;
 }
 
 bool Settings::IsKey(const char* key) {
-	return (mInitialized && key != 0 && mDoc[key]);
+	return mInitialized && key != 0 && GetInstanceData()->Find(key) != nullptr;
 }
 
 /* Get a key value */
 int8_t Settings::GetChar(const char* key, const int8_t defaultValue) {
-	JsonVariant value = GetValue(key, SettingsType::PT_I8);
-	return (value.is<signed char>()) ? value.as<signed char>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_I8, defaultValue) : defaultValue;
 }
 
 uint8_t Settings::GetUChar(const char* key, const uint8_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_U8);
-	return (value.is<unsigned char>()) ? value.as<unsigned char>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_U8, defaultValue) : defaultValue;
 }
 
 int16_t Settings::GetShort(const char* key, const int16_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_I16);
-	return (value.is<signed short>()) ? value.as<signed short>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_I16, defaultValue) : defaultValue;
 }
 
 uint16_t Settings::GetUShort(const char* key, const uint16_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_U16);
-	return (value.is<unsigned short>()) ? value.as<unsigned short>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_U16, defaultValue) : defaultValue;
 }
 
 int32_t Settings::GetInt(const char* key, const int32_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_I32);
-	return (value.is<signed int>()) ? value.as<signed int>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_I32, defaultValue) : defaultValue;
 }
 
 uint32_t Settings::GetUInt(const char* key, const uint32_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_U32);
-	return (value.is<unsigned int>()) ? value.as<unsigned int>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_U32, defaultValue) : defaultValue;
 }
 
 int32_t Settings::GetLong(const char* key, const int32_t defaultValue) {
@@ -293,50 +429,64 @@ uint32_t Settings::GetULong(const char* key, const uint32_t defaultValue) {
 }
 
 int64_t Settings::GetLong64(const char* key, const int64_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_I64);
-	return (value.is<signed long long>()) ? value.as<signed long long>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_I64, defaultValue) : defaultValue;
 }
 
 uint64_t Settings::GetULong64(const char* key, const uint64_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_U64);
-	return (value.is<unsigned long long>()) ? value.as<unsigned long long>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_U64, defaultValue) : defaultValue;
 }
 
 float_t Settings::GetFloat(const char* key, const float_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_FLOAT);
-	return (value.is<float>()) ? value.as<float>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_FLOAT, defaultValue) : defaultValue;
 }
 
 double_t Settings::GetDouble(const char* key, const double_t defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_DOUBLE);
-	return (value.is<double>()) ? value.as<double>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_DOUBLE, defaultValue) : defaultValue;
 }
 
 bool Settings::GetBool(const char* key, const bool defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_BOOL);
-	return (value.is<bool>()) ? value.as<bool>() : defaultValue;
+	return mInitialized && key != 0 ? GetInstanceData()->GetValue(key, SettingsType::PT_BOOL, defaultValue) : defaultValue;
 }
 
+/* Copies a string with its terminator, returns the bytes copied like Preferences or 0 if it does not fit */
 size_t Settings::GetString(const char* key, char* value, const size_t maxLen) {
-	return GetInstanceData()->GetBlob(key, value, maxLen, true);
+	SettingsInstanceData::Entry* entry = mInitialized && key != 0 ? GetInstanceData()->Find(key) : nullptr;
+	if (entry == nullptr || entry->type != SettingsType::PT_STR || value == 0 || entry->value.size() + 1 > maxLen) {
+		return 0;
+	}
+	memcpy(value, entry->value.data(), entry->value.size());
+	value[entry->value.size()] = '\0';
+	return entry->value.size() + 1;
 }
 
 String Settings::GetString(const char* key, const String defaultValue) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_STR);
-	return (value.is<String>()) ? value.as<String>() : defaultValue;
+	SettingsInstanceData::Entry* entry = mInitialized && key != 0 ? GetInstanceData()->Find(key) : nullptr;
+	if (entry == nullptr || entry->type != SettingsType::PT_STR) {
+		return defaultValue;
+	}
+	String value;
+	value.concat((const char*)entry->value.data(), entry->value.size());
+	return value;
 }
 
 size_t Settings::GetBytesLength(const char* key) {
-	JsonVariant value = GetInstanceData()->GetValue(key, SettingsType::PT_STR);
-	return (value.is<String>()) ? value.as<String>().length() : 0;
+	SettingsInstanceData::Entry* entry = mInitialized && key != 0 ? GetInstanceData()->Find(key) : nullptr;
+	return entry != nullptr && entry->type == SettingsType::PT_BLOB ? entry->value.size() : 0;
 }
 
 size_t Settings::GetBytes(const char* key, void* buf, size_t maxLen) {
-	return GetInstanceData()->GetBlob(key, buf, maxLen, false);
+	SettingsInstanceData::Entry* entry = mInitialized && key != 0 ? GetInstanceData()->Find(key) : nullptr;
+	if (entry == nullptr || entry->type != SettingsType::PT_BLOB || buf == 0 || entry->value.size() > maxLen) {
+		return 0;
+	}
+	memcpy(buf, entry->value.data(), entry->value.size());
+	return entry->value.size();
 }
 
+/* The entries of 32 B NVS would provide in the rest of the log before it is compacted */
 size_t Settings::FreeEntries() {
-	return 2048;
+	size_t liveSize = GetInstanceData()->mLiveSize;
+	return liveSize < SettingsInstanceData::mMaxLogSize ? (SettingsInstanceData::mMaxLogSize - liveSize) / 32 : 0;
 }
 
 Settings::SettingsInstanceData* Settings::GetInstanceData() {
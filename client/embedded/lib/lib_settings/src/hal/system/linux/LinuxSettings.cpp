@@ -0,0 +1,521 @@
+// #ifdef LINUX
+#pragma message("LINUX: Preferences HAL")
+
+#include <system/Settings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "util/Logger.h"
+
+namespace System {
+
+/*
+ * The settings of a namespace are a memory-mapped file of the size of the NVS
+ * partition, so that the firmware can run as a Linux process with the
+ * settings of the previous run, and reads and writes cost no system call.
+ * The files are in $GOALFINDER_NVS_DIR, or .nvs in the working directory.
+ *
+ * The file holds a header and the records of all keys one after another. A
+ * put of a value of the same size overwrites it, any other put removes the
+ * record and appends a new one. Like NVS, a key has up to 15 characters, a
+ * get of another type than the one put fails, and a put fails once the file
+ * is full. Every access searches the records with a flock() of the file,
+ * shared to read and exclusive to write, so any number of instances, also in
+ * other processes, may map the same namespace. Values are copied while the
+ * file is locked. A record that does not fit the used bytes ends the search,
+ * so a damaged file never makes an access leave the mapping.
+ *
+ * File (16-byte header + records):
+ *   Bytes 0-3:   GFNV Magic
+ *   Bytes 4-7:   Format version (1)
+ *   Bytes 8-11:  Bytes of the records
+ *   Bytes 12-15: Reserved (0x00)
+ * Record (24-byte header + value, padded to 4 bytes):
+ *   Bytes 0-15:  Key, zero-padded
+ *   Byte  16:    SettingsType
+ *   Bytes 17-19: Reserved (0x00)
+ *   Bytes 20-23: Value length
+ */
+struct Settings::SettingsInstanceData {
+	struct FileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t used;
+		uint32_t reserved;
+	};
+
+	struct RecordHeader {
+		char key[16];
+		uint8_t type;
+		uint8_t reserved[3];
+		uint32_t length;
+	};
+
+	const char* mDefaultDirectory = ".nvs";
+	const char* mDefaultFileName = "unnamed";
+	const char* mFileNameExtension = ".nvs";
+	/** The size of the NVS partition in partitions.csv */
+	static const size_t mFileSize = 0x5000;
+	static const size_t mMaxKeyLength = 15;
+	static const uint32_t mVersion = 1;
+
+	uint8_t* mData = nullptr;
+	/** Kept open for the locks */
+	int mFd = -1;
+
+	/** Holds a flock() of the file while in scope */
+	class Lock {
+	public:
+		Lock(int fd, int operation) : mFd(fd) {
+			while (flock(mFd, operation) != 0 && errno == EINTR) {
+			}
+		}
+		~Lock() {
+			flock(mFd, LOCK_UN);
+		}
+
+	private:
+		int mFd;
+	};
+
+	bool Open(const char* name, bool readOnly) {
+		const char* directory = getenv("GOALFINDER_NVS_DIR");
+		if (directory == nullptr || directory[0] == '\0') {
+			directory = mDefaultDirectory;
+		}
+		if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+			LOG(Settings, ERROR, "Failed accessing NVS directory '%s'", directory);
+			return false;
+		}
+		String path(directory);
+		path += '/';
+		path += name != 0 ? name : mDefaultFileName;
+		path += mFileNameExtension;
+
+		int fd = open(path.c_str(), readOnly ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+		struct stat info;
+		if (fd < 0 || fstat(fd, &info) != 0 || (!readOnly && (size_t)info.st_size < mFileSize && ftruncate(fd, mFileSize) != 0)
+				|| (readOnly && (size_t)info.st_size < mFileSize)) {
+			LOG(Settings, ERROR, "Failed opening preferences file '%s'.", path.c_str());
+			if (fd >= 0) {
+				close(fd);
+			}
+			return false;
+		}
+		void* data = mmap(nullptr, mFileSize, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (data == MAP_FAILED) {
+			LOG(Settings, ERROR, "Failed mapping preferences file '%s'.", path.c_str());
+			close(fd);
+			return false;
+		}
+		mData = (uint8_t*)data;
+		mFd = fd;
+
+		bool valid;
+		uint32_t used;
+		{
+			// another instance may be creating the file
+			Lock lock(mFd, readOnly ? LOCK_SH : LOCK_EX);
+			FileHeader* header = Header();
+			valid = memcmp(header->magic, "GFNV", 4) == 0 && header->version == mVersion;
+			if (!valid && !readOnly) {
+				// a new file, or one of another format
+				memset(mData, 0, mFileSize);
+				memcpy(header->magic, "GFNV", 4);
+				header->version = mVersion;
+			}
+			used = header->used;
+		}
+		if (!valid && readOnly) {
+			LOG(Settings, ERROR, "Invalid preferences file '%s'.", path.c_str());
+			Close();
+			return false;
+		}
+		LOG(Settings, DEBUG, "Mapped '%s', %u B used", path.c_str(), (unsigned)used);
+		return true;
+	}
+
+	void Close() {
+		if (mData != nullptr) {
+			munmap(mData, mFileSize);
+			mData = nullptr;
+		}
+		if (mFd >= 0) {
+			close(mFd);
+			mFd = -1;
+		}
+	}
+
+	FileHeader* Header() {
+		return (FileHeader*)mData;
+	}
+
+	uint8_t* Records() {
+		return mData + sizeof(FileHeader);
+	}
+
+	static size_t RecordSize(size_t length) {
+		return sizeof(RecordHeader) + (length + 3) / 4 * 4;
+	}
+
+	/** Bytes of the records, the file must be locked */
+	uint32_t Used() {
+		uint32_t used = Header()->used;
+		return used < mFileSize - sizeof(FileHeader) ? used : mFileSize - sizeof(FileHeader);
+	}
+
+	/** Searches the record of a key, the file must be locked. Without one, intact gets the bytes of the records before any damaged one. */
+	RecordHeader* Find(const char* key, uint32_t* intact = nullptr) {
+		if (mData == nullptr || key == 0) {
+			return nullptr;
+		}
+		uint32_t used = Used();
+		uint32_t offset = 0;
+		while (offset < used) {
+			RecordHeader* record = (RecordHeader*)(Records() + offset);
+			if (used - offset < sizeof(RecordHeader) || record->length > used - offset - sizeof(RecordHeader)
+					|| RecordSize(record->length) > used - offset) {
+				LOG(Settings, ERROR, "Damaged record at %u", (unsigned)offset);
+				break;
+			}
+			if (strncmp(record->key, key, sizeof(record->key)) == 0) {
+				return record;
+			}
+			offset += RecordSize(record->length);
+		}
+		if (intact != nullptr) {
+			*intact = offset;
+		}
+		return nullptr;
+	}
+
+	/** Calls read with the record of a key or nullptr, while the file is read-locked. */
+	template <typename F>
+	auto Read(const char* key, F read) -> decltype(read(nullptr)) {
+		if (mData == nullptr) {
+			return read(nullptr);
+		}
+		Lock lock(mFd, LOCK_SH);
+		return read(Find(key));
+	}
+
+	/** Copies the value of a key of a type if it has up to maxLength bytes, returns its length or 0. */
+	size_t Get(const char* key, SettingsType type, void* value, size_t maxLength) {
+		return Read(key, [type, value, maxLength](const RecordHeader* record) -> size_t {
+			if (record == nullptr || record->type != (uint8_t)type || record->length > maxLength) {
+				return 0;
+			}
+			if (value != nullptr) {
+				memcpy(value, record + 1, record->length);
+			}
+			return record->length;
+		});
+	}
+
+	String GetString(const char* key, const String& defaultValue) {
+		return Read(key, [&defaultValue](const RecordHeader* record) -> String {
+			if (record == nullptr || record->type != (uint8_t)SettingsType::PT_STR) {
+				return defaultValue;
+			}
+			// the terminator may be missing in a damaged file
+			String value;
+			value.concat((const char*)(record + 1), record->length > 0 ? record->length - 1 : 0);
+			return value;
+		});
+	}
+
+	bool Put(const char* key, SettingsType type, const void* value, size_t length) {
+		if (strlen(key) == 0 || strlen(key) > mMaxKeyLength) {
+			LOG(Settings, ERROR, "Invalid key '%s'", key);
+			return false;
+		}
+		Lock lock(mFd, LOCK_EX);
+		uint32_t intact = Used();
+		RecordHeader* record = Find(key, &intact);
+		if (record == nullptr && intact < Used()) {
+			// the records following a damaged one cannot be found anymore, the new one would not be either
+			LOG(Settings, WARN, "Dropping %u B of damaged records", (unsigned)(Used() - intact));
+			memset(Records() + intact, 0, Used() - intact);
+			Header()->used = intact;
+		}
+		if (record != nullptr && record->length == length) {
+			record->type = (uint8_t)type;
+			memcpy(record + 1, value, length);
+			return true;
+		}
+		size_t free = mFileSize - sizeof(FileHeader) - Used() + (record != nullptr ? RecordSize(record->length) : 0);
+		if (RecordSize(length) > free) {
+			LOG(Settings, ERROR, "No space left for '%s'", key);
+			return false;
+		}
+		if (record != nullptr) {
+			Remove(record);
+		}
+		record = (RecordHeader*)(Records() + Used());
+		memset(record, 0, RecordSize(length));
+		memcpy(record->key, key, strlen(key));
+		record->type = (uint8_t)type;
+		record->length = length;
+		memcpy(record + 1, value, length);
+		Header()->used = Used() + RecordSize(length);
+		return true;
+	}
+
+	bool Remove(const char* key) {
+		Lock lock(mFd, LOCK_EX);
+		RecordHeader* record = Find(key);
+		if (record != nullptr) {
+			Remove(record);
+		}
+		return record != nullptr;
+	}
+
+	/** Closes the gap of a record found with the records following it, the file must be write-locked. */
+	void Remove(RecordHeader* record) {
+		uint8_t* start = (uint8_t*)record;
+		size_t size = RecordSize(record->length);
+		uint8_t* end = Records() + Used();
+		memmove(start, start + size, end - start - size);
+		Header()->used = Used() - size;
+		memset(end - size, 0, size);
+	}
+
+	void Clear() {
+		Lock lock(mFd, LOCK_EX);
+		memset(Records(), 0, Used());
+		Header()->used = 0;
+	}
+
+	size_t GetFree() {
+		Lock lock(mFd, LOCK_SH);
+		return mFileSize - sizeof(FileHeader) - Used();
+	}
+
+	template <typename T>
+	size_t PutValue(const char* key, SettingsType type, T value) {
+		return Put(key, type, &value, sizeof(T)) ? sizeof(T) : 0;
+	}
+
+	template <typename T>
+	T GetValue(const char* key, SettingsType type, T defaultValue) {
+		T value;
+		return Get(key, type, &value, sizeof(T)) == sizeof(T) ? value : defaultValue;
+	}
+};
+
+Settings::Settings() :
+        mInitialized(false), mReadOnly(false), mInstanceData(0) {
+	mInstanceData = new SettingsInstanceData();
+}
+
+Settings::~Settings() {
+	End();
+	delete mInstanceData;
+	mInstanceData = 0;
+}
+
+bool Settings::Begin(const char* name, bool readOnly, const char* partition_label) {
+	(void)partition_label; // partition_label is not used by this implementation
+	if (!mInitialized) {
+		mReadOnly = readOnly;
+		mInitialized = GetInstanceData()->Open(name, readOnly);
+	}
+	return mInitialized;
+}
+
+void Settings::End() {
+	GetInstanceData()->Close();
+	mInitialized = false;
+}
+
+/* Clear all keys in opened preferences */
+bool Settings::Clear() {
+	if (!mInitialized || mReadOnly) {
+		return false;
+	}
+	GetInstanceData()->Clear();
+	return true;
+}
+
+/* Remove a key */
+bool Settings::Remove(const char* key) {
+	return mInitialized && !mReadOnly && key != 0 && GetInstanceData()->Remove(key);
+}
+
+/* Put a key value */
+size_t Settings::PutChar(const char* key, int8_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I8, value) : 0;
+}
+
+size_t Settings::PutUChar(const char* key, uint8_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U8, value) : 0;
+}
+
+size_t Settings::PutShort(const char* key, int16_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I16, value) : 0;
+}
+
+size_t Settings::PutUShort(const char* key, uint16_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U16, value) : 0;
+}
+
+size_t Settings::PutInt(const char* key, int32_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I32, value) : 0;
+}
+
+size_t Settings::PutUInt(const char* key, uint32_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U32, value) : 0;
+}
+
+size_t Settings::PutLong(const char* key, int32_t value) {
+	return PutInt(key, value);
+}
+
+size_t Settings::PutULong(const char* key, uint32_t value) {
+	return PutUInt(key, value);
+}
+
+size_t Settings::PutLong64(const char* key, int64_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_I64, value) : 0;
+}
+
+size_t Settings::PutULong64(const char* key, uint64_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_U64, value) : 0;
+}
+
+size_t Settings::PutFloat(const char* key, const float_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_FLOAT, value) : 0;
+}
+
+size_t Settings::PutDouble(const char* key, const double_t value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_DOUBLE, value) : 0;
+}
+
+size_t Settings::PutBool(const char* key, const bool value) {
+	return mInitialized && key != 0 && !mReadOnly ? GetInstanceData()->PutValue(key, SettingsType::PT_BOOL, value) : 0;
+}
+
+size_t Settings::PutString(const char* key, const char* value) {
+	if (!mInitialized || key == 0 || value == 0 || mReadOnly) {
+		return 0;
+	}
+	// stored with its terminator, like NVS
+	size_t len = strlen(value) + 1;
+	return GetInstanceData()->Put(key, SettingsType::PT_STR, value, len) ? len - 1 : 0;
+}
+
+size_t Settings::PutString(const char* key, const String value) {
+	return PutString(key, value.c_str());
+}
+
+size_t Settings::PutBytes(const char* key, const void* value, size_t len) {
+	if (!mInitialized || key == 0 || value == 0 || len == 0 || mReadOnly) {
+		return 0;
+	}
+	return GetInstanceData()->Put(key, SettingsType::PT_BLOB, value, len) ? len : 0;
+}
+
+SettingsType Settings::GetType(const char* key) {
+	if (!mInitialized) {
+		return SettingsType::PT_INVALID;
+	}
+	return GetInstanceData()->Read(key, [](const SettingsInstanceData::RecordHeader* record) {
+		return record != nullptr ? (SettingsType)record->type : SettingsType::PT_INVALID;
+	});
+}
+
+bool Settings::IsKey(const char* key) {
+	return mInitialized && GetInstanceData()->Read(key, [](const SettingsInstanceData::RecordHeader* record) {
+		return record != nullptr;
+	});
+}
+
+/* Get a key value */
+int8_t Settings::GetChar(const char* key, const int8_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_I8, defaultValue) : defaultValue;
+}
+
+uint8_t Settings::GetUChar(const char* key, const uint8_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_U8, defaultValue) : defaultValue;
+}
+
+int16_t Settings::GetShort(const char* key, const int16_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_I16, defaultValue) : defaultValue;
+}
+
+uint16_t Settings::GetUShort(const char* key, const uint16_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_U16, defaultValue) : defaultValue;
+}
+
+int32_t Settings::GetInt(const char* key, const int32_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_I32, defaultValue) : defaultValue;
+}
+
+uint32_t Settings::GetUInt(const char* key, const uint32_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_U32, defaultValue) : defaultValue;
+}
+
+int32_t Settings::GetLong(const char* key, const int32_t defaultValue) {
+	return GetInt(key, defaultValue);
+}
+
+uint32_t Settings::GetULong(const char* key, const uint32_t defaultValue) {
+	return GetUInt(key, defaultValue);
+}
+
+int64_t Settings::GetLong64(const char* key, const int64_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_I64, defaultValue) : defaultValue;
+}
+
+uint64_t Settings::GetULong64(const char* key, const uint64_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_U64, defaultValue) : defaultValue;
+}
+
+float_t Settings::GetFloat(const char* key, const float_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_FLOAT, defaultValue) : defaultValue;
+}
+
+double_t Settings::GetDouble(const char* key, const double_t defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_DOUBLE, defaultValue) : defaultValue;
+}
+
+bool Settings::GetBool(const char* key, const bool defaultValue) {
+	return mInitialized ? GetInstanceData()->GetValue(key, SettingsType::PT_BOOL, defaultValue) : defaultValue;
+}
+
+/* Copies a string with its terminator, returns the bytes copied like Preferences or 0 if it does not fit */
+size_t Settings::GetString(const char* key, char* value, const size_t maxLen) {
+	return mInitialized && value != 0 ? GetInstanceData()->Get(key, SettingsType::PT_STR, value, maxLen) : 0;
+}
+
+String Settings::GetString(const char* key, const String defaultValue) {
+	return mInitialized ? GetInstanceData()->GetString(key, defaultValue) : defaultValue;
+}
+
+size_t Settings::GetBytesLength(const char* key) {
+	return mInitialized ? GetInstanceData()->Get(key, SettingsType::PT_BLOB, nullptr, SIZE_MAX) : 0;
+}
+
+size_t Settings::GetBytes(const char* key, void* buf, size_t maxLen) {
+	return mInitialized && buf != 0 ? GetInstanceData()->Get(key, SettingsType::PT_BLOB, buf, maxLen) : 0;
+}
+
+/* The entries of 32 B NVS would provide in the rest of the file */
+size_t Settings::FreeEntries() {
+	if (!mInitialized) {
+		return 0;
+	}
+	return GetInstanceData()->GetFree() / 32;
+}
+
+Settings::SettingsInstanceData* Settings::GetInstanceData() {
+	return (SettingsInstanceData*)mInstanceData;
+}
+
+} // namespace System
+
+// #endif
@@ -2,19 +2,68 @@
 
 #include <Adafruit_VL53L0X.h>
 
+/** A single distance measurement of the ToF sensor. */
+struct ToFSample
+{
+    /** The measured distance in millimeters, -1 if the measurement was out of range. */
+    int millimeters;
+    /** The time (micros()) at which the measurement has been fetched from the sensor. */
+    unsigned long timestampUs;
+    /** Increments with every fetched measurement, 0 if no measurement has been fetched yet. */
+    uint32_t sequence;
+};
+
 class ToFSensor 
 {
     public: 
         virtual ~ToFSensor();
         
-        ToFSensor() : wireConfig(0) 
+        ToFSensor() : wireConfig(0), continuous(false), periodUs(0), latestSample({-1, 0, 0})
         {
             
         }
 
         void Init(int sclPin, int sdaPin);
+
+        /** Performs a blocking single-shot measurement (~30 ms). */
         int ReadSingleMillimeters();
+
+        /** 
+         * Starts continuous ranging. The sensor measures autonomously with the
+         * given inter-measurement period; 0 runs measurements back-to-back.
+         */
+        bool StartContinuous(uint16_t periodMs = 0);
+
+        /** Stops continuous ranging. */
+        void StopContinuous();
+
+        bool IsContinuous() const;
+
+        /** 
+         * Checks without blocking whether the sensor has finished a measurement.
+         * The bus is not accessed before the next measurement can be due.
+         */
+        bool Poll();
+
+        /** Reads the finished measurement from the sensor and stores it as latest sample. */
+        void Fetch();
+
+        /** Polls the sensor and fetches a finished measurement. Returns true if a new sample is available. */
+        bool Update();
+
+        /** Provides the time until the next measurement can be finished, 0 if it is due. */
+        unsigned long GetTimeUntilNextSampleUs() const;
+
+        /** Provides the latest fetched sample. */
+        ToFSample GetLatestSample() const;
+
     private: 
+        /** The minimum time a single measurement takes with the default timing budget. */
+        static const unsigned long minMeasurementTimeUs;
+
         Adafruit_VL53L0X sensor; 
         TwoWire wireConfig;
-};
\ No newline at end of file
+        bool continuous;
+        unsigned long periodUs;
+        ToFSample latestSample;
+};
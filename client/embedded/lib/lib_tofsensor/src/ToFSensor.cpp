@@ -1,13 +1,15 @@
 #include <ToFSensor.h>
 #include "util/Logger.h"
 
+const unsigned long ToFSensor::minMeasurementTimeUs = 30000;
+
 void ToFSensor::Init(int sclPin, int sdaPin) 
 {
     wireConfig.begin(sdaPin, sclPin);
 
     if(!sensor.begin(41U, false, &wireConfig))
     {
-        Logger::log("ToFSensor", Logger::LogLevel::ERROR, "Failed to boot VL53L0X");
+        LOG(ToFSensor, ERROR, "Failed to boot VL53L0X");
     }
 }
 
@@ -24,11 +26,78 @@ int ToFSensor::ReadSingleMillimeters()
     {
         return -1;
     }
-    
-    delay(100);
+}
+
+bool ToFSensor::StartContinuous(uint16_t periodMs)
+{
+    continuous = sensor.startRangeContinuous(periodMs);
+    if (continuous)
+    {
+        periodUs = max((unsigned long)periodMs * 1000UL, minMeasurementTimeUs);
+        latestSample.timestampUs = micros();
+        LOG(ToFSensor, INFO, "Continuous ranging started (period %u ms)", periodMs);
+    }
+    else
+    {
+        LOG(ToFSensor, ERROR, "Failed to start continuous ranging");
+    }
+    return continuous;
+}
+
+void ToFSensor::StopContinuous()
+{
+    if (continuous)
+    {
+        sensor.stopRangeContinuous();
+        continuous = false;
+    }
+}
+
+bool ToFSensor::IsContinuous() const
+{
+    return continuous;
+}
+
+bool ToFSensor::Poll()
+{
+    if (!continuous || (micros() - latestSample.timestampUs) < periodUs)
+    {
+        return false;
+    }
+    return sensor.isRangeComplete();
+}
+
+void ToFSensor::Fetch()
+{
+    uint16_t range = sensor.readRangeResult();
+
+    latestSample.millimeters = (range == 0xffff) ? -1 : range;
+    latestSample.timestampUs = micros();
+    latestSample.sequence++;
+}
+
+bool ToFSensor::Update()
+{
+    if (Poll())
+    {
+        Fetch();
+        return true;
+    }
+    return false;
+}
+
+unsigned long ToFSensor::GetTimeUntilNextSampleUs() const
+{
+    unsigned long elapsedUs = micros() - latestSample.timestampUs;
+    return elapsedUs < periodUs ? periodUs - elapsedUs : 0;
+}
+
+ToFSample ToFSensor::GetLatestSample() const
+{
+    return latestSample;
 }
 
 ToFSensor::~ToFSensor()
 {
-    
-}
\ No newline at end of file
+    StopContinuous();
+}
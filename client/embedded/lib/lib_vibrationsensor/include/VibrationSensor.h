@@ -1,13 +1,48 @@
 #pragma once
 
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "util/SpscRing.h"
 
 class VibrationSensor {
     public: 
+        /** How the sensor pulses are measured. */
+        enum class Mode {
+            /** Busy-waits for a pulse with pulseIn() */
+            PulseIn,
+            /** Timestamps pin edges in an interrupt handler */
+            EdgeCapture
+        };
+
+        VibrationSensor();
         virtual ~VibrationSensor();
-        void Init();
+        void Init(Mode mode = Mode::EdgeCapture);
+
+        /** Measures a single pulse by busy-waiting up to measureTimeUs (PulseIn mode). */
         long Vibration(uint64_t measureTimeUs);
 
+        /** 
+         * Consumes the next completed pulse captured by the interrupt handler (EdgeCapture mode).
+         * Returns false without waiting if no pulse is complete.
+         */
+        bool ReadPulse(long& widthUs);
+
+        /** Consumes all completed pulses and provides the width of the longest one, 0 if none. */
+        long LongestPulse();
+
+        /** Provides the time (esp_timer) of the falling edge of the last consumed pulse. */
+        int64_t GetLastPulseEndUs() const;
+
+        /** 
+         * Notifies the given task with the given bits from the interrupt handler
+         * whenever a pulse completes (EdgeCapture mode).
+         */
+        void SetPulseListener(TaskHandle_t task, uint32_t notifyBits);
+
+        /** Provides the number of edges lost because the edge buffer was full. */
+        uint32_t GetDroppedEdges() const;
+
         /** 
          * Sets the sensitivity of the sensor in the range of 0 to 100%.
          * The value is clipped.
@@ -15,6 +50,19 @@ class VibrationSensor {
         void SetSensitivity(int sensitivity);
         
     private:
+        struct Edge {
+            int64_t timeUs;
+            bool rising;
+        };
+
+        static void HandleEdge(void* arg);
+
         int vs;
+        Mode mode;
+        SpscRing<Edge, 64> edges;
+        /** Start of the pulse whose falling edge has not been consumed yet, -1 if none */
+        int64_t pulseStartUs;
+        int64_t lastPulseEndUs;
+        TaskHandle_t listener;
+        uint32_t listenerBits;
 };
-
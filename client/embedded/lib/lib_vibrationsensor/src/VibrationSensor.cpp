@@ -1,17 +1,49 @@
+
 #include <VibrationSensor.h>
 #include <Arduino.h>
+#include <esp_timer.h>
 #include "util/Logger.h"
 
 
+VibrationSensor::VibrationSensor() : 
+    vs(-1), mode(Mode::PulseIn), pulseStartUs(-1), lastPulseEndUs(0), listener(nullptr), listenerBits(0)
+{
+}
+
 VibrationSensor::~VibrationSensor()
 {
+    if (mode == Mode::EdgeCapture && vs >= 0) {
+        detachInterrupt(digitalPinToInterrupt(vs));
+    }
 }
 
-void VibrationSensor::Init() 
+void VibrationSensor::Init(Mode mode) 
 {
     // TODO: Make pins configurable
     vs = 13;
+    this->mode = mode;
     pinMode(vs, INPUT);
+
+    if (mode == Mode::EdgeCapture) {
+        attachInterruptArg(digitalPinToInterrupt(vs), HandleEdge, this, CHANGE);
+        LOG(VibrationSensor, INFO, "Capturing edges on pin %d", vs);
+    }
+}
+
+void IRAM_ATTR VibrationSensor::HandleEdge(void* arg)
+{
+    VibrationSensor* sensor = (VibrationSensor*)arg;
+    Edge edge = { esp_timer_get_time(), digitalRead(sensor->vs) == HIGH };
+    sensor->edges.Push(edge);
+
+    TaskHandle_t listener = sensor->listener;
+    if (!edge.rising && listener != nullptr) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        xTaskNotifyFromISR(listener, sensor->listenerBits, eSetBits, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken) {
+            portYIELD_FROM_ISR();
+        }
+    }
 }
 
 long VibrationSensor::Vibration(uint64_t measureTimeUs) 
@@ -23,6 +55,50 @@ long VibrationSensor::Vibration(uint64_t measureTimeUs)
    
 }
 
+bool VibrationSensor::ReadPulse(long& widthUs)
+{
+    Edge edge;
+    while (edges.Pop(edge)) {
+        if (edge.rising) {
+            pulseStartUs = edge.timeUs;
+        } else if (pulseStartUs >= 0) {
+            widthUs = (long)(edge.timeUs - pulseStartUs);
+            pulseStartUs = -1;
+            lastPulseEndUs = edge.timeUs;
+            return true;
+        }
+    }
+    return false;
+}
+
+long VibrationSensor::LongestPulse()
+{
+    long longest = 0;
+    long widthUs;
+    while (ReadPulse(widthUs)) {
+        if (widthUs > longest) {
+            longest = widthUs;
+        }
+    }
+    return longest;
+}
+
+int64_t VibrationSensor::GetLastPulseEndUs() const
+{
+    return lastPulseEndUs;
+}
+
+void VibrationSensor::SetPulseListener(TaskHandle_t task, uint32_t notifyBits)
+{
+    listenerBits = notifyBits;
+    listener = task;
+}
+
+uint32_t VibrationSensor::GetDroppedEdges() const
+{
+    return edges.GetDropped();
+}
+
 // TODO Add a method which detects vibration (boolean result)
 // based on sensitivity and measured pulse
 
@@ -34,4 +110,4 @@ void VibrationSensor::SetSensitivity(int sensitivity)
         sensitivity = 100;
     }
 
-}
\ No newline at end of file
+}
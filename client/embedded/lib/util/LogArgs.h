@@ -0,0 +1,145 @@
+#pragma once
+
+/*
+ * The raw arguments of a deferred log message.
+ *
+ * Instead of formatting a message on the calling task, Logger::logDeferred()
+ * packs its arguments into this buffer and enqueues it together with the
+ * pointer to the format string. The arguments are formatted later on the
+ * logger task, or on the host by decode-log.py when the logger sends binary
+ * frames.
+ *
+ * Every argument is stored as a type tag followed by its value in native byte
+ * order (little-endian on the ESP32), so that it is formatted correctly even if
+ * its type does not exactly match the conversion:
+ * - 'i', 'u': signed or unsigned integer up to 32 bits, 4 bytes
+ * - 'q', 'Q': signed or unsigned 64 bit integer, 8 bytes
+ * - 'd':      float or double, 8 bytes (double)
+ * - 's':      string including the terminator, copied as it may not outlive the call
+ * Pointers are stored as unsigned integers.
+ *
+ * Arguments which do not fit anymore are dropped, a string is truncated.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+class LogArgs
+{
+    public:
+        static const size_t capacity = 96;
+
+        LogArgs() : length(0), truncated(false)
+        {
+        }
+
+        void Add()
+        {
+        }
+
+        template<typename T, typename... Rest>
+        void Add(T first, Rest... rest)
+        {
+            Put(first);
+            Add(rest...);
+        }
+
+        const uint8_t* GetData() const
+        {
+            return data;
+        }
+
+        size_t GetLength() const
+        {
+            return length;
+        }
+
+        /** Indicates whether arguments were dropped or truncated. */
+        bool IsTruncated() const
+        {
+            return truncated;
+        }
+
+    private:
+        void Put(bool value) { PutInteger((uint32_t)value); }
+        void Put(char value) { PutInteger((int32_t)value); }
+        void Put(signed char value) { PutInteger(value); }
+        void Put(unsigned char value) { PutInteger(value); }
+        void Put(short value) { PutInteger(value); }
+        void Put(unsigned short value) { PutInteger(value); }
+        void Put(int value) { PutInteger(value); }
+        void Put(unsigned int value) { PutInteger(value); }
+        void Put(long value) { PutInteger(value); }
+        void Put(unsigned long value) { PutInteger(value); }
+        void Put(long long value) { PutInteger(value); }
+        void Put(unsigned long long value) { PutInteger(value); }
+        void Put(float value) { Put((double)value); }
+        void Put(const void* value) { PutInteger((uintptr_t)value); }
+
+        void Put(double value)
+        {
+            PutTagged('d', &value, sizeof(value));
+        }
+
+        void Put(const char* value)
+        {
+            if (value == nullptr)
+            {
+                value = "(null)";
+            }
+            size_t stringLength = strlen(value);
+            // the tag, at least one character and the terminator
+            if (truncated || capacity - length < 3)
+            {
+                truncated = true;
+                return;
+            }
+            if (stringLength > capacity - length - 2)
+            {
+                stringLength = capacity - length - 2;
+                truncated = true;
+            }
+            data[length++] = 's';
+            memcpy(data + length, value, stringLength);
+            length += stringLength;
+            data[length++] = '\0';
+        }
+
+        void Put(char* value)
+        {
+            Put((const char*)value);
+        }
+
+        template<typename T>
+        void PutInteger(T value)
+        {
+            if (sizeof(T) <= sizeof(uint32_t))
+            {
+                uint32_t word = (uint32_t)value;
+                PutTagged(std::is_signed<T>::value ? 'i' : 'u', &word, sizeof(word));
+            }
+            else
+            {
+                uint64_t word = (uint64_t)value;
+                PutTagged(std::is_signed<T>::value ? 'q' : 'Q', &word, sizeof(word));
+            }
+        }
+
+        void PutTagged(char tag, const void* value, size_t size)
+        {
+            if (truncated || size + 1 > capacity - length)
+            {
+                truncated = true;
+                return;
+            }
+            data[length++] = (uint8_t)tag;
+            memcpy(data + length, value, size);
+            length += size;
+        }
+
+        uint8_t data[capacity];
+        size_t length;
+        bool truncated;
+};
@@ -1,45 +1,259 @@
-#pragma once
-
-/* Lightweight declaration of Logger API for library builds.
- * This header mirrors the public interface of the real
- * `src/util/Logger.h` so files under `lib/` can include
- * "util/Logger.h" without requiring access to the `src/`
- * include path during library compilation.
+/* ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
  *
- * Keep this in sync with src/util/Logger.h.
- */
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * =============================================================================== */
+
+#pragma once
 
 #include <WString.h>
+#include <stdarg.h>
+#include <atomic>
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "util/MpscRing.h"
+#include "util/LogArgs.h"
+
+/** Compile-time floors of LOG() and LOG_EXTRA(), in order of severity */
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+/*
+ * Messages below the floor of their module are compiled out, including the
+ * evaluation of their arguments. LOG_FLOOR sets the floor of all modules,
+ * e.g. -DLOG_FLOOR=LOG_LEVEL_INFO, LOG_FLOOR_<module> the floor of one module,
+ * e.g. -DLOG_FLOOR_LedController=LOG_LEVEL_WARN.
+ */
+#ifndef LOG_FLOOR
+#define LOG_FLOOR LOG_LEVEL_DEBUG
+#endif
+#ifndef LOG_FLOOR_GoalfinderApp
+#define LOG_FLOOR_GoalfinderApp LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_WebServer
+#define LOG_FLOOR_WebServer LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_LedController
+#define LOG_FLOOR_LedController LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_AudioPlayer
+#define LOG_FLOOR_AudioPlayer LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_SoftwareUpdater
+#define LOG_FLOOR_SoftwareUpdater LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_ToFSensor
+#define LOG_FLOOR_ToFSensor LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_VibrationSensor
+#define LOG_FLOOR_VibrationSensor LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_FileSystem
+#define LOG_FLOOR_FileSystem LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_Settings
+#define LOG_FLOOR_Settings LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_AudioClipCache
+#define LOG_FLOOR_AudioClipCache LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_AudioMetronome
+#define LOG_FLOOR_AudioMetronome LOG_FLOOR
+#endif
+#ifndef LOG_FLOOR_AudioMixer
+#define LOG_FLOOR_AudioMixer LOG_FLOOR
+#endif
+
+/** The modules logging via LOG(), each with its own runtime level */
+enum class LogModule : uint8_t
+{
+    GoalfinderApp,
+    WebServer,
+    LedController,
+    AudioPlayer,
+    SoftwareUpdater,
+    ToFSensor,
+    VibrationSensor,
+    FileSystem,
+    Settings,
+    AudioClipCache,
+    AudioMetronome,
+    AudioMixer,
+    Count
+};
+
+/**
+ * Logs a message of a module, e.g. LOG(WebServer, INFO, "Received %u bytes", length).
+ * The message is formatted on the logger task, so the format must be a literal.
+ */
+#define LOG(module, level, ...) \
+    do { \
+        if (Logger::IsCompiled(LOG_FLOOR_##module, Logger::LogLevel::level) \
+            && Logger::IsEnabled(LogModule::module, Logger::LogLevel::level)) { \
+            Logger::logDeferred(#module, Logger::LogLevel::level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+/** Logs a message of a module like LOG(), but only while extra logging is enabled in the settings. */
+#define LOG_EXTRA(module, level, ...) \
+    do { \
+        if (Logger::IsCompiled(LOG_FLOOR_##module, Logger::LogLevel::level) \
+            && Logger::IsExtraLog() && Logger::IsEnabled(LogModule::module, Logger::LogLevel::level)) { \
+            Logger::logDeferred(#module, Logger::LogLevel::level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+class LogFile;
 
 class Logger
 {
 public:
-	enum class LogLevel
-	{
-		OK,
-		DEBUG,
-		INFO,
-		WARN,
-		ERROR
-	};
-
-	struct LogEntry {
-		String message;
-		String file;
-		LogLevel level;
-	};
-
-	static void begin(unsigned long baudRate = 115200);
-
-	static void log(const String &message);
-	static void log(const String &message, LogLevel level);
-	static void log(const String &message, const String &file, LogLevel level);
-	static void logExtra(const String &message, const String &file, LogLevel level);
-
-	static void log(const char *file, LogLevel level, const char *fmt, ...);
-	static void logExtra(const char *file, LogLevel level, const char *fmt, ...);
-
-	static void Loop();
+    enum class LogLevel
+    {
+        OK,
+        DEBUG,
+        INFO,
+        WARN,
+        ERROR
+    };
+
+    /** Provides the severity of a level as LOG_LEVEL_*, OK messages are as severe as INFO messages. */
+    static constexpr int Severity(LogLevel level)
+    {
+        return level == LogLevel::DEBUG ? LOG_LEVEL_DEBUG
+             : level == LogLevel::WARN ? LOG_LEVEL_WARN
+             : level == LogLevel::ERROR ? LOG_LEVEL_ERROR
+             : LOG_LEVEL_INFO;
+    }
+
+    /** Indicates whether a message of the level is compiled in with the given floor. */
+    static constexpr bool IsCompiled(int floor, LogLevel level)
+    {
+        return Severity(level) >= floor;
+    }
+
+    /** Indicates whether a message of the module and level passes the runtime level of the module. */
+    static inline bool IsEnabled(LogModule module, LogLevel level)
+    {
+        return Severity(level) >= moduleLevels[(uint8_t)module].load(std::memory_order_relaxed);
+    }
+
+    /** Sets the runtime level of a module, messages below it are discarded. */
+    static void SetLevel(LogModule module, LogLevel level);
+    static LogLevel GetLevel(LogModule module);
+    static const char* GetModuleName(LogModule module);
+    /** Provides the module with the given name, returns false if there is none. */
+    static bool FindModule(const char *name, LogModule &module);
+    static const char* GetLevelName(LogLevel level);
+    /** Provides the level with the given name, returns false if there is none. */
+    static bool FindLevel(const char *name, LogLevel &level);
+
+    /** Indicates whether extra logging is enabled, cached from the settings. */
+    static inline bool IsExtraLog()
+    {
+        return extraLog.load(std::memory_order_relaxed);
+    }
+    static void SetExtraLog(bool enabled);
+
+    /** Messages are truncated to this length including the terminator */
+    static const size_t maxMessageLength = 96;
+
+    static void begin(unsigned long baudRate = 115200);
+
+    static void log(const String &message);
+    static void log(const String &message, LogLevel level);
+    static void log(const String &message, const String &file, LogLevel level);
+    static void logExtra(const String &message, const String &file, LogLevel level);
+
+    static void log(const char *file, LogLevel level, const char *fmt, ...);
+    static void logExtra(const char *file, LogLevel level, const char *fmt, ...);
+
+    /**
+     * Logs a message formatted later on the logger task, so that the caller only copies the arguments.
+     * The format string must be a literal, as only its address is stored.
+     */
+    template<typename... Args>
+    static void logDeferred(const char *file, LogLevel level, const char *fmt, Args... args)
+    {
+        LogArgs packed;
+        packed.Add(args...);
+        logPacked(file, level, fmt, packed);
+    }
+    static void logPacked(const char *file, LogLevel level, const char *fmt, const LogArgs &args);
+
+    /** Prints all queued entries, waiting up to waitTicks for the first one. */
+    static void Loop(TickType_t waitTicks = 0);
+
+    /** Sets the file the log lines are persisted in, its Begin() must have succeeded. */
+    static void SetFile(LogFile *logFile);
+    static LogFile* GetFile();
+
+    /** Provides the number of messages dropped because the log ring was full. */
+    static uint32_t GetDropped();
+
+private:
+    /** A log message, written in place into the ring */
+    struct LogRecord {
+        /** The format string of a deferred message, whose arguments are stored in message, else nullptr */
+        const char *format;
+        uint32_t timestampMs;
+        LogLevel level;
+        uint8_t moduleId;
+        uint16_t length;
+        char message[maxMessageLength];
+    };
+
+    /** Holds the messages logged while the logger task is busy, e.g. writing the log file */
+    static const size_t recordCount = 64;
+    static const uint8_t maxModules = 24;
+    static const size_t maxModuleNameLength = 24;
+
+    struct Module {
+        /** 0 if free, 1 while being written, 2 once the name is valid */
+        std::atomic<uint8_t> state;
+        char name[maxModuleNameLength];
+    };
+
+    static std::atomic<uint8_t> moduleLevels[(uint8_t)LogModule::Count];
+    static std::atomic<bool> extraLog;
+    static std::atomic<LogFile*> file;
+    static MpscRing<LogRecord, recordCount> records;
+    static Module modules[maxModules];
+    /** The task draining the ring, notified on every new record */
+    static std::atomic<TaskHandle_t> drainTask;
+    /** Set while a task drains the ring, which has a single consumer */
+    static std::atomic_flag draining;
+    /** Drops already reported by the drain task */
+    static uint32_t reportedDrops;
+    /** Modules whose name has been sent in a binary frame, by id */
+    static uint32_t announcedModules;
+
+    static uint8_t internModule(const char *name);
+    static LogRecord* beginRecord(const char *file, LogLevel level, uint32_t &ticket);
+    static void endRecord(LogRecord *record, int length, uint32_t ticket);
+    static void publishRecord(uint32_t ticket);
+    static void enqueue(const char *file, LogLevel level, const char *fmt, va_list args);
+    static void enqueueText(const char *file, LogLevel level, const char *text);
+    static size_t drain(char *buffer, size_t size);
+    /** Prints the ring on the calling task, as long as there is no logger task to do it. */
+    static void drainWithoutTask();
+    /** Formats a deferred message from its format string and packed arguments. */
+    static size_t formatDeferred(char *out, size_t size, const char *fmt, const uint8_t *args, size_t argLength);
+    /** Formats a record as text line, returns 0 if it does not fit. */
+    static size_t formatLine(char *out, size_t size, const LogRecord &record);
+    /** Encodes a record as binary frame, returns 0 if it does not fit. */
+    static size_t frameRecord(char *out, size_t size, const LogRecord &record);
+    static size_t beginFrame(char *out, size_t size, char type, size_t payloadLength);
+    static size_t endFrame(char *out, size_t length);
 };
@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * Lock-free multi-producer/single-consumer ring buffer of fixed slots.
+ *
+ * Any number of tasks may push while exactly one task pops. Items are written
+ * and read in place: a producer claims a slot, fills it and publishes it, so
+ * large records are never copied. Every slot carries a sequence number which
+ * tells whether it is free for the producer of a given position or holds a
+ * published item (bounded queue after Dmitry Vyukov).
+ *
+ * A producer preempted between claiming and publishing delays the consumer,
+ * but never blocks the other producers.
+ *
+ * The capacity N must be a power of two.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+template<typename T, size_t N>
+class MpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing capacity must be a power of two");
+
+    public:
+        MpscRing() : head(0), tail(0), dropped(0)
+        {
+            for (uint32_t i = 0; i < N; i++)
+            {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Claims the slot for the next item (any producer). Returns nullptr and counts a drop
+         * if the ring is full, else the slot has to be handed to EndPush() with the ticket.
+         */
+        T* BeginPush(uint32_t& ticket)
+        {
+            uint32_t h = head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Slot& slot = slots[h & (N - 1)];
+                int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - h);
+                if (diff == 0)
+                {
+                    if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed))
+                    {
+                        ticket = h;
+                        return &slot.item;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // the slot still holds the item written one lap ago
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                else
+                {
+                    // another producer claimed the position
+                    h = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Publishes the item claimed by BeginPush(). */
+        void EndPush(uint32_t ticket)
+        {
+            slots[ticket & (N - 1)].sequence.store(ticket + 1, std::memory_order_release);
+        }
+
+        /** Provides the oldest published item (consumer only), or nullptr if there is none. */
+        const T* Front() const
+        {
+            const Slot& slot = slots[tail & (N - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+            {
+                return nullptr;
+            }
+            return &slot.item;
+        }
+
+        /** Releases the item provided by Front() to the producers (consumer only). */
+        void Pop()
+        {
+            slots[tail & (N - 1)].sequence.store(tail + N, std::memory_order_release);
+            tail++;
+        }
+
+        /** Provides the number of items rejected because the ring was full. */
+        uint32_t GetDropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        static constexpr size_t Capacity()
+        {
+            return N;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint32_t> sequence;
+            T item;
+        };
+
+        Slot slots[N];
+        /** Next position to claim, shared by the producers */
+        std::atomic<uint32_t> head;
+        /** Next position to read, only used by the consumer */
+        uint32_t tail;
+        std::atomic<uint32_t> dropped;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+ * Lock-free single-producer/single-consumer ring buffer.
+ *
+ * Exactly one context (task or ISR) may push and exactly one other
+ * context may pop. Neither side ever blocks or takes a lock, which makes
+ * the ring usable between an interrupt handler and a task. All members are
+ * forced inline so that producers running from IRAM do not call into flash.
+ *
+ * The capacity N must be a power of two.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define SPSC_RING_INLINE inline __attribute__((always_inline))
+
+template<typename T, size_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    public:
+        SpscRing() : head(0), tail(0), dropped(0)
+        {
+        }
+
+        /** Appends an item (producer only). Returns false and counts a drop if the ring is full. */
+        SPSC_RING_INLINE bool Push(const T& item)
+        {
+            uint32_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= N)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            items[h & (N - 1)] = item;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** Removes the oldest item (consumer only). Returns false if the ring is empty. */
+        SPSC_RING_INLINE bool Pop(T& item)
+        {
+            uint32_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = items[t & (N - 1)];
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        SPSC_RING_INLINE bool IsEmpty() const
+        {
+            return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+        }
+
+        SPSC_RING_INLINE size_t Size() const
+        {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+        /** Provides the number of items rejected because the ring was full. */
+        SPSC_RING_INLINE uint32_t GetDropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        static constexpr size_t Capacity()
+        {
+            return N;
+        }
+
+    private:
+        T items[N];
+        /** Next position to write, only modified by the producer */
+        std::atomic<uint32_t> head;
+        /** Next position to read, only modified by the consumer */
+        std::atomic<uint32_t> tail;
+        std::atomic<uint32_t> dropped;
+};
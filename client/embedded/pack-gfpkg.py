@@ -1,33 +1,39 @@
 #!/usr/bin/python3
 
-# Packs firmware.bin and littlefs.bin into a single .gfpkg combined update package.
+# Packs firmware.bin, littlefs.bin and assets.bin (the web app image, see
+# gen-asset-manifest.py) into a single .gfpkg combined update package.
 #
-# Package format (16-byte header + payload):
+# Package format (32-byte header + payload):
 #   Bytes  0-3:   GFPK Magic
-#   Byte   4:     Format version (1)
+#   Byte   4:     Format version (2)
 #   Bytes  5-8:   Firmware size  (uint32_t, little-endian)
 #   Bytes  9-12:  Filesystem size (uint32_t, little-endian)
-#   Bytes  13-15: Reserved (0x00)
+#   Bytes  13-16: Asset image size (uint32_t, little-endian)
+#   Bytes  17-31: Reserved (0x00)
 #   --- payload ---
 #   [firmware.bin bytes]
 #   [littlefs.bin bytes]
+#   [assets.bin bytes]
+#
+# Version 1 packages have a 16-byte header without the asset image size and
+# carry no asset image. Devices still accept them.
 #
 # Usage:
 #   PlatformIO custom target:  pio run -t package
-#   Standalone:                python pack-gfpkg.py <firmware.bin> <littlefs.bin> <output.gfpkg>
+#   Standalone:                python pack-gfpkg.py <firmware.bin> <littlefs.bin> <assets.bin> <output.gfpkg>
 
 import os
 import struct
 import subprocess
 import sys
 
-HEADER_SIZE = 16
+HEADER_SIZE = 32
 MAGIC = b"GFPK"
-FORMAT_VERSION = 1
+FORMAT_VERSION = 2
 
 
-def pack(firmware_path, filesystem_path, output_path):
-    """Create a .gfpkg combined update package from firmware and filesystem images."""
+def pack(firmware_path, filesystem_path, assets_path, output_path):
+    """Create a .gfpkg combined update package from firmware, filesystem and asset images."""
 
     if not os.path.isfile(firmware_path):
         raise FileNotFoundError(f"Firmware binary not found: {firmware_path}")
@@ -38,18 +44,28 @@ def pack(firmware_path, filesystem_path, output_path):
             "  Build it first with:  pio run -t buildfs"
         )
 
+    if not os.path.isfile(assets_path):
+        raise FileNotFoundError(
+            f"Asset image not found: {assets_path}\n"
+            "  It is generated by gen-asset-manifest.py when the firmware is built"
+        )
+
     with open(firmware_path, "rb") as f:
         firmware_data = f.read()
 
     with open(filesystem_path, "rb") as f:
         filesystem_data = f.read()
 
-    # Build 16-byte header
+    with open(assets_path, "rb") as f:
+        assets_data = f.read()
+
+    # Build 32-byte header
     header = MAGIC                                          # 4 bytes
     header += struct.pack("<B", FORMAT_VERSION)             # 1 byte
     header += struct.pack("<I", len(firmware_data))         # 4 bytes
     header += struct.pack("<I", len(filesystem_data))       # 4 bytes
-    header += b"\x00" * 3                                   # 3 bytes reserved
+    header += struct.pack("<I", len(assets_data))           # 4 bytes
+    header += b"\x00" * 15                                  # 15 bytes reserved
 
     assert len(header) == HEADER_SIZE
 
@@ -57,12 +73,14 @@ def pack(firmware_path, filesystem_path, output_path):
         f.write(header)
         f.write(firmware_data)
         f.write(filesystem_data)
+        f.write(assets_data)
 
-    total = HEADER_SIZE + len(firmware_data) + len(filesystem_data)
+    total = HEADER_SIZE + len(firmware_data) + len(filesystem_data) + len(assets_data)
     print(
         f"[GFPKG] Created {output_path}\n"
         f"        Firmware  : {len(firmware_data):>10,} bytes\n"
         f"        Filesystem: {len(filesystem_data):>10,} bytes\n"
+        f"        Assets    : {len(assets_data):>10,} bytes\n"
         f"        Total     : {total:>10,} bytes"
     )
 
@@ -76,6 +94,7 @@ try:
     build_dir = env.subst("${BUILD_DIR}")
     firmware_bin = os.path.join(build_dir, "firmware.bin")
     filesystem_bin = os.path.join(build_dir, "littlefs.bin")
+    assets_bin = os.path.join(build_dir, "assets.bin")
     output_gfpkg = os.path.join(build_dir, "system.gfpkg")
 
     # Path to the web client project (relative to the embedded project root)
@@ -89,19 +108,23 @@ try:
         if result.returncode != 0:
             raise RuntimeError("Web app build failed")
 
-        # 2. Build the LittleFS filesystem image
+        # 2. Rebuild the firmware, its asset manifest and image are generated from the new web app
+        print("[GFPKG] Rebuilding firmware with the asset manifest...")
+        env.Execute("pio run -e " + env.subst("${PIOENV}"))
+
+        # 3. Build the LittleFS filesystem image
         print("[GFPKG] Building filesystem image...")
         env.Execute("pio run -t buildfs -e " + env.subst("${PIOENV}"))
 
-        # 3. Pack firmware + filesystem into .gfpkg
-        pack(firmware_bin, filesystem_bin, output_gfpkg)
+        # 4. Pack firmware + filesystem + assets into .gfpkg
+        pack(firmware_bin, filesystem_bin, assets_bin, output_gfpkg)
 
     env.AddCustomTarget(
         name="package",
         dependencies=firmware_bin,
         actions=package_action,
         title="Package GFPKG",
-        description="Pack firmware + filesystem into a single .gfpkg update file",
+        description="Pack firmware + filesystem + web app into a single .gfpkg update file",
         always_build=True,
     )
 except Exception:
@@ -111,16 +134,17 @@ except Exception:
 # Standalone CLI usage
 # ---------------------------------------------------------------------------
 if __name__ == "__main__":
-    if len(sys.argv) == 4:
-        pack(sys.argv[1], sys.argv[2], sys.argv[3])
+    if len(sys.argv) == 5:
+        pack(sys.argv[1], sys.argv[2], sys.argv[3], sys.argv[4])
     elif len(sys.argv) == 1:
         # Default paths when run from the embedded directory
         build_dir = os.path.join(".pio", "build", "wemos_d1_mini32")
         pack(
             os.path.join(build_dir, "firmware.bin"),
             os.path.join(build_dir, "littlefs.bin"),
+            os.path.join(build_dir, "assets.bin"),
             os.path.join(build_dir, "system.gfpkg"),
         )
     else:
-        print("Usage: python pack-gfpkg.py [<firmware.bin> <littlefs.bin> <output.gfpkg>]")
+        print("Usage: python pack-gfpkg.py [<firmware.bin> <littlefs.bin> <assets.bin> <output.gfpkg>]")
         sys.exit(1)
@@ -18,6 +18,8 @@
 #include <HardwareSerial.h>
 #include <Settings.h>
 #include "util/Logger.h"
+#include <esp_timer.h>
+#include <limits.h>
 
 // Hardware pins and constants
 const int GoalfinderApp::pinTofSda = 22;
@@ -32,6 +34,15 @@ const int GoalfinderApp::ledPwmChannel = 0;
 
 const int GoalfinderApp::shotVibrationThreshold = 2000;
 const int GoalfinderApp::maxShotDurationMs = 5000;
+const int GoalfinderApp::tofRangingPeriodMs = 0;
+const unsigned long GoalfinderApp::audioBufferPeriodMs = 2;
+const size_t GoalfinderApp::audioCacheBudgetBytes = 48 * 1024;
+const uint16_t GoalfinderApp::audioCacheHeadMs = 150;
+const size_t GoalfinderApp::metronomeBudgetBytes = 32 * 1024;
+
+const uint32_t GoalfinderApp::detectionEventVibration = (1 << 0);
+const uint32_t GoalfinderApp::detectionEventAudioDone = (1 << 1);
+const uint32_t GoalfinderApp::detectionEventSettings = (1 << 2);
 
 const char* GoalfinderApp::waitingClip = "/waiting.mp3";
 
@@ -49,34 +60,42 @@ TaskHandle_t GoalfinderApp::TaskAudioHandle = nullptr;
 TaskHandle_t GoalfinderApp::TaskDetectionHandle = nullptr;
 TaskHandle_t GoalfinderApp::TaskLedHandle = nullptr;
 TaskHandle_t GoalfinderApp::TaskLoggerHandle = nullptr;
-SemaphoreHandle_t GoalfinderApp::xMutex = nullptr;
 
 // Constructor
 GoalfinderApp::GoalfinderApp() :
     Singleton<GoalfinderApp>(),
+    audioPlayer(&fileSystem, pinI2sBclk, pinI2sWclk, pinI2sDataOut, audioCacheBudgetBytes, audioCacheHeadMs, metronomeBudgetBytes),
+    ledController(pinLedPwm, ledPwmChannel),
     fileSystem(true),
-    webServer(&fileSystem),
+    logFile(&fileSystem),
+    shotJournal(),
+    webServer(&fileSystem, &shotJournal),
     sntp(),
-    audioPlayer(&fileSystem, pinI2sBclk, pinI2sWclk, pinI2sDataOut),
     tofSensor(),
     vibrationSensor(),
-    ledController(pinLedPwm, ledPwmChannel),
+    isSoundEnabled(true),
     announcing(false),
     announcingUntilMs(0),
-    metronomeIntervalMs(2000),
-    lastMetronomeTickTime(0),
-    announcement(Announcement::None),
+    distanceOnlyHitDetection(false),
     lastShockTime(0),
     lastHitTime(0),
     afterHitTimeoutMs(5000),
-    isSoundEnabled(true),
-    distanceOnlyHitDetection(false)
+    ballHitDetectionDistance(0),
+    metronomeSound(0),
+    metronomeBpm(0),
+    hitSound(0),
+    missSound(0),
+    settingsGeneration(0),
+    announcement(Announcement::None)
 {}
 
 GoalfinderApp::~GoalfinderApp() {}
 
 void GoalfinderApp::SetIsSoundEnabled(bool value) {
     isSoundEnabled = value;
+    if (TaskAudioHandle != nullptr) {
+        xTaskNotifyGive(TaskAudioHandle);
+    }
 }
 
 bool GoalfinderApp::IsSoundEnabled() {
@@ -93,38 +112,43 @@ void GoalfinderApp::Init() {
     randomSeed(analogRead(pinRandomSeed));
 
     if (fileSystem.Begin()) {
+        if (logFile.Begin()) {
+            Logger::SetFile(&logFile);
+        }
         WiFiSetup();
         delay(200); // Allow SoftAP setup
 
         dnsServer.stop();
         dnsServer.start(53, "*", WiFi.softAPIP());
-        Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "DNS server started for captive portal");
+        LOG(GoalfinderApp, INFO, "DNS server started for captive portal");
 
         webServer.Begin();
         sntp.Init();
         vibrationSensor.Init();
         tofSensor.Init(pinTofScl, pinTofSda);
+        tofSensor.StartContinuous(tofRangingPeriodMs);
         ledController.SetMode(LedMode::Flash);
 
         UpdateSettings(true);
 
-        xMutex = xSemaphoreCreateMutex();    
-
         xTaskCreatePinnedToCore(TaskAudio, "Audio", 8192, this, 2, &TaskAudioHandle, 1);
         xTaskCreatePinnedToCore(TaskDetection, "Detection", 8192, this, 2, &TaskDetectionHandle, 0);
         xTaskCreatePinnedToCore(TaskLed, "LED", 8192, this, 2, &TaskLedHandle, 0);
         xTaskCreatePinnedToCore(TaskLogger, "Logger", 4096, this, 1, &TaskLoggerHandle, 0);
 
-        Logger::log("GoalfinderApp", Logger::LogLevel::OK, "All tasks started");
+        vibrationSensor.SetPulseListener(TaskDetectionHandle, detectionEventVibration);
+        Settings::GetInstance()->Subscribe(TaskDetectionHandle, detectionEventSettings);
+
+        LOG(GoalfinderApp, OK, "All tasks started");
     } else {
-        Logger::log("GoalfinderApp", Logger::LogLevel::ERROR, "FS initialization failed");
+        LOG(GoalfinderApp, ERROR, "FS initialization failed");
     }
 }
 
 void GoalfinderApp::WiFiSetup() {
     Settings* settings = Settings::GetInstance();
 
-    if (settings->IsFirstRun()) {
+    if (settings->GetFirstRun()) {
         ApplyDeviceNameByScan();
     }
 
@@ -139,7 +163,7 @@ void GoalfinderApp::WiFiSetup() {
         WiFi.softAP(ssid, wifiPassword.c_str());
     }
     WiFi.setSleep(false);
-    Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "SoftAP IP: %s", WiFi.softAPIP().toString().c_str());
+    LOG(GoalfinderApp, INFO, "SoftAP IP: %s", WiFi.softAPIP().toString().c_str());
 }
 
 void GoalfinderApp::ApplyDeviceNameByScan() {
@@ -150,7 +174,7 @@ void GoalfinderApp::ApplyDeviceNameByScan() {
     delay(100);
 
     int n = WiFi.scanNetworks();
-    Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "First run found %d networks", n);
+    LOG(GoalfinderApp, INFO, "First run found %d networks", n);
 
     bool usedNumbers[100] = { false };
 
@@ -161,7 +185,7 @@ void GoalfinderApp::ApplyDeviceNameByScan() {
             int num = numStr.toInt();
             if (num > 0 && num < 100) {
                 usedNumbers[num] = true;
-                Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "Found existing device: %s (number %d)", ssid.c_str(), num);
+                LOG(GoalfinderApp, INFO, "Found existing device: %s (number %d)", ssid.c_str(), num);
             }
         }
     }
@@ -181,35 +205,61 @@ void GoalfinderApp::ApplyDeviceNameByScan() {
     
     settings->SetDeviceName(deviceName);
     settings->SetFirstRun(false);
-    Logger::log("GoalfinderApp", Logger::LogLevel::OK, "First run assigned device name '%s'", deviceName.c_str());
+    LOG(GoalfinderApp, OK, "First run assigned device name '%s'", deviceName.c_str());
 }
 
 void GoalfinderApp::UpdateSettings(bool force) {
     Settings* settings = Settings::GetInstance();
-    if (force || settings->IsModified()) {
-        audioPlayer.SetVolume(settings->GetVolume());
-        ledController.SetMode(settings->GetLedMode());
-        vibrationSensor.SetSensitivity(settings->GetVibrationSensorSensitivity());
-        distanceOnlyHitDetection = settings->GetDistanceOnlyHitDetection();
-        afterHitTimeoutMs = settings->GetAfterHitTimeout() * 1000UL;
+    if (force || settings->GetGeneration() != settingsGeneration) {
+        SettingsSnapshot snapshot = settings->GetSnapshot();
+        settingsGeneration = snapshot.generation;
+
+        audioPlayer.RequestVolume(snapshot.volume);
+        ledController.SetMode(snapshot.ledMode);
+        ledController.SetBrightness(snapshot.ledBrightness);
+        vibrationSensor.SetSensitivity(snapshot.vibrationSensorSensitivity);
+        distanceOnlyHitDetection = snapshot.distanceOnlyHitDetection;
+        afterHitTimeoutMs = snapshot.afterHitTimeout * 1000UL;
+        ballHitDetectionDistance = snapshot.ballHitDetectionDistance;
+        metronomeSound = snapshot.metronomeSound;
+        metronomeBpm = snapshot.metronomeBpm;
+        hitSound = snapshot.hitSound;
+        missSound = snapshot.missSound;
+        // decode the heads of the selected clips into RAM for an instant start
+        audioPlayer.RequestPreload(hitClips[hitSound]);
+        audioPlayer.RequestPreload(missClips[missSound]);
+        if (TaskAudioHandle != nullptr) {
+            xTaskNotifyGive(TaskAudioHandle);
+        }
+        if (TaskLedHandle != nullptr) {
+            // mode or brightness may have changed
+            xTaskNotifyGive(TaskLedHandle);
+        }
     }
 }
 
 // Tasks
+// Each task blocks on its task notification until it is notified or its next deadline is due.
 void GoalfinderApp::TaskAudio(void *pvParameters) {
     GoalfinderApp* app = (GoalfinderApp*)pvParameters;
     while (app->loop) {
-        if (app->IsSoundEnabled()) {
-            if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
-                app->audioPlayer.Loop();
-                bool isPlaying = app->audioPlayer.IsPlaying();
-                xSemaphoreGive(xMutex);
-                if (!isPlaying) {
-                    app->TickMetronome();
-                }
-            }
+        TickType_t waitTicks = portMAX_DELAY;
+        // this task is the only owner of the audio player, other tasks post commands
+        bool wasPlaying = app->audioPlayer.IsPlaying();
+        if (!app->IsSoundEnabled()) {
+            app->audioPlayer.Stop();
+        }
+        app->UpdateMetronome();
+        app->audioPlayer.Loop();
+        bool isPlaying = app->audioPlayer.IsPlaying();
+        if (wasPlaying && !isPlaying && TaskDetectionHandle != nullptr) {
+            xTaskNotify(TaskDetectionHandle, detectionEventAudioDone, eSetBits);
+        }
+        if (app->audioPlayer.IsStreaming()) {
+            // refill the I2S DMA buffers before they run empty
+            waitTicks = ToTicks(audioBufferPeriodMs);
         }
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        ulTaskNotifyTake(pdTRUE, waitTicks);
     }
 }
 
@@ -219,34 +269,65 @@ void GoalfinderApp::TaskDetection(void *pvParameters) {
         app->UpdateSettings();
         app->DetectShot();
         app->ProcessAnnouncement();
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        // wakes up immediately on vibration pulses, playback end and settings changes
+        xTaskNotifyWait(0, UINT32_MAX, nullptr, ToTicks(app->GetDetectionWaitMs()));
     }
 }
 
 void GoalfinderApp::TaskLed(void *pvParameters) {
     GoalfinderApp* app = (GoalfinderApp*)pvParameters;
     while (app->loop) {
-        app->ledController.Loop();
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        unsigned long nextStepMs = app->ledController.Loop();
+        ulTaskNotifyTake(pdTRUE, nextStepMs == LedController::noDeadline ? portMAX_DELAY : ToTicks(nextStepMs));
     }
 }
 
 void GoalfinderApp::TaskLogger(void *pvParameters) {
     GoalfinderApp* app = (GoalfinderApp*)pvParameters;
     while (app->loop) {
-        Logger::Loop();
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        // wakes up as soon as an entry is enqueued
+        Logger::Loop(portMAX_DELAY);
     }
 }
 
-// Play metronome sound
-void GoalfinderApp::TickMetronome() {
-    unsigned long currentTime = millis();
-    if ((currentTime - lastMetronomeTickTime) > metronomeIntervalMs) {
-        lastMetronomeTickTime = currentTime;
-        const char* clipName = (lastShockTime > 0) ? waitingClip : tickClips[Settings::GetInstance()->GetMetronomeSound()];
-        PlaySound(clipName);
+TickType_t GoalfinderApp::ToTicks(unsigned long ms) {
+    if (ms == ULONG_MAX) {
+        return portMAX_DELAY;
     }
+    // round up and wait at least one tick, so that a deadline is never missed by busy looping
+    TickType_t ticks = (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    return ticks > 0 ? ticks : 1;
+}
+
+unsigned long GoalfinderApp::GetDetectionWaitMs() {
+    unsigned long now = millis();
+    unsigned long waitMs = ULONG_MAX;
+
+    if (announcing && announcingUntilMs > now) {
+        waitMs = min(waitMs, announcingUntilMs - now);
+    }
+    if (lastHitTime > 0 && (now - lastHitTime) < afterHitTimeoutMs) {
+        // nothing is detected until the timeout after a hit expired
+        return min(waitMs, afterHitTimeoutMs - (now - lastHitTime));
+    }
+    if (distanceOnlyHitDetection || lastShockTime > 0) {
+        waitMs = min(waitMs, (tofSensor.GetTimeUntilNextSampleUs() + 999UL) / 1000UL);
+    }
+    if (lastShockTime > 0) {
+        unsigned long shotDurationMs = now - lastShockTime;
+        waitMs = min(waitMs, shotDurationMs <= (unsigned long)maxShotDurationMs ? maxShotDurationMs - shotDurationMs + 1 : 0UL);
+    }
+    return waitMs;
+}
+
+// Called by the audio task, which owns the player
+void GoalfinderApp::UpdateMetronome() {
+    if (!isSoundEnabled) {
+        audioPlayer.StopMetronome();
+        return;
+    }
+    const char* clipName = (lastShockTime > 0) ? waitingClip : tickClips[metronomeSound];
+    audioPlayer.StartMetronome(clipName, metronomeBpm);
 }
 
 void GoalfinderApp::DetectShot() {
@@ -254,12 +335,17 @@ void GoalfinderApp::DetectShot() {
         announcing = false;
     }
 
+    // fetch a finished ToF measurement without waiting for the next one
+    bool isNewDistance = tofSensor.Update();
+    int distance = tofSensor.GetLatestSample().millimeters;
+    // always consume captured pulses, so that vibrations while not listening are discarded
+    long vibration = vibrationSensor.LongestPulse();
+
     if (!(lastHitTime > 0 && (millis() - lastHitTime) < afterHitTimeoutMs)) {
-        int distance = tofSensor.ReadSingleMillimeters();
         if (distanceOnlyHitDetection) {
             if (!(announcing && audioPlayer.IsPlaying())) {
                 announcing = false;
-                if (distance > 20 && distance < Settings::GetInstance()->GetBallHitDetectionDistance()) {
+                if (isNewDistance && distance > 20 && distance < ballHitDetectionDistance) {
                     AnnounceHit();
                     lastHitTime = millis();
                 }
@@ -268,10 +354,11 @@ void GoalfinderApp::DetectShot() {
             if (lastShockTime == 0) {
                 if (!(announcing && audioPlayer.IsPlaying())) {
                     announcing = false;
-                    long vibration = vibrationSensor.Vibration(10000);
                     if (vibration > shotVibrationThreshold) {
                         lastShockTime = millis();
-                        Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "Shot detected");
+                        long latencyUs = (long)(esp_timer_get_time() - vibrationSensor.GetLastPulseEndUs());
+                        LOG(GoalfinderApp, INFO, "Shot detected (%ld us after pulse end)", latencyUs);
+                        shotJournal.Append(ShotEventType::Shot);
                     }
                 }
             }
@@ -279,8 +366,7 @@ void GoalfinderApp::DetectShot() {
             unsigned long currentTime = millis();
 
             if (lastShockTime > 0 && (currentTime - lastShockTime) < maxShotDurationMs) {
-                int distance = tofSensor.ReadSingleMillimeters();
-                if (distance > 20 && distance < Settings::GetInstance()->GetBallHitDetectionDistance()) {
+                if (isNewDistance && distance > 20 && distance < ballHitDetectionDistance) {
                     AnnounceHit();
                     lastShockTime = 0;
                     lastHitTime = millis();
@@ -304,10 +390,10 @@ void GoalfinderApp::ProcessAnnouncement() {
             break;
         case Announcement::Hit:
             // play hit sound and set a short timeout
-            AnnounceEvent("hit", hitClips[Settings::GetInstance()->GetHitSound()], 2500UL);
+            AnnounceEvent("hit", hitClips[hitSound], 2500UL);
             break;
         case Announcement::Miss:
-            AnnounceEvent("miss", missClips[Settings::GetInstance()->GetHitSound()], 3500UL);
+            AnnounceEvent("miss", missClips[missSound], 3500UL);
             break;
         default:
             break;
@@ -316,19 +402,19 @@ void GoalfinderApp::ProcessAnnouncement() {
 }
 
 void GoalfinderApp::AnnounceHit() {
-    detectedHits++;
+    uint32_t sequence = shotJournal.Append(ShotEventType::Hit);
     announcement = Announcement::Hit;
-    Logger::log("GoalfinderApp", Logger::LogLevel::OK, "Hit detected (total hits: %d)", detectedHits);
+    LOG(GoalfinderApp, OK, "Hit %u detected (total hits: %u)", (unsigned)sequence, (unsigned)GetDetectedHits());
 }
 
 void GoalfinderApp::AnnounceMiss() {
-    detectedMisses++;
+    uint32_t sequence = shotJournal.Append(ShotEventType::Miss);
     announcement = Announcement::Miss;
-    Logger::log("GoalfinderApp", Logger::LogLevel::WARN, "Miss detected (total misses: %d)", detectedMisses);
+    LOG(GoalfinderApp, WARN, "Miss %u detected (total misses: %u)", (unsigned)sequence, (unsigned)GetDetectedMisses());
 }
 
 void GoalfinderApp::AnnounceEvent(const char* traceMsg, const char* sound, unsigned long timeoutMs) {
-    Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "Announcing event '%s'", traceMsg);
+    LOG(GoalfinderApp, INFO, "Announcing event '%s'", traceMsg);
     if (sound) {
         announcing = true;
         if (timeoutMs > 0) {
@@ -341,11 +427,14 @@ void GoalfinderApp::AnnounceEvent(const char* traceMsg, const char* sound, unsig
 }
 
 void GoalfinderApp::PlaySound(const char* soundFileName) {
-    if (soundFileName) {
-        Logger::log("GoalfinderApp", Logger::LogLevel::INFO, "Starting playback '%s'", soundFileName);
-        if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
-            audioPlayer.PlayMP3(soundFileName);
-            xSemaphoreGive(xMutex);
+    // posts the clip to the audio task without waiting for it
+    if (soundFileName && isSoundEnabled) {
+        LOG(GoalfinderApp, INFO, "Starting playback '%s'", soundFileName);
+        if (!audioPlayer.RequestPlay(soundFileName)) {
+            LOG(GoalfinderApp, WARN, "Audio command queue full, dropped '%s'", soundFileName);
+        }
+        if (TaskAudioHandle != nullptr) {
+            xTaskNotifyGive(TaskAudioHandle);
         }
     }
 }
@@ -354,25 +443,22 @@ void GoalfinderApp::Process() {
     if (WiFi.softAPgetStationNum() >= 0) {
         dnsServer.processNextRequest();
     }
+    // pushes the detected events to the web clients
+    webServer.Loop();
     delay(1);
 }
 
-int GoalfinderApp::GetDetectedHits()
-{
-    return detectedHits;
-}
-
-int GoalfinderApp::GetDetectedMisses()
+uint32_t GoalfinderApp::GetDetectedHits() const
 {
-    return detectedMisses;
+    return shotJournal.GetCount(ShotEventType::Hit);
 }
 
-void GoalfinderApp::ResetDetectedHits()
+uint32_t GoalfinderApp::GetDetectedMisses() const
 {
-    detectedHits = 0;
+    return shotJournal.GetCount(ShotEventType::Miss);
 }
 
-void GoalfinderApp::ResetDetectedMisses()
+const ShotJournal& GoalfinderApp::GetShotJournal() const
 {
-    detectedMisses = 0;
+    return shotJournal;
 }
\ No newline at end of file
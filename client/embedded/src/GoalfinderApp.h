@@ -28,9 +28,10 @@
 #include <AudioPlayer.h>
 #include <LedController.h>
 #include <util/Logger.h>  // logger task
+#include "util/LogFile.h"
+#include "ShotJournal.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 
 class GoalfinderApp : public Singleton<GoalfinderApp> {
 public:
@@ -38,11 +39,11 @@ public:
     void SetIsSoundEnabled(bool value);
     bool IsSoundEnabled();
 
-    int GetDetectedHits();
-	int GetDetectedMisses();
-
-	void ResetDetectedHits();
-	void ResetDetectedMisses();
+    /** The number of hits and misses since the start of the device */
+    uint32_t GetDetectedHits() const;
+    uint32_t GetDetectedMisses() const;
+    /** The latest detected events, read by the web server */
+    const ShotJournal& GetShotJournal() const;
 
     /** Destructor */
     virtual ~GoalfinderApp();
@@ -53,7 +54,8 @@ public:
     /** Processes one single iteration step (optional, mostly unused with tasks). */
     void Process();
 
-    void TickMetronome();
+    /** Sets the clip and tempo of the metronome, which ticks within the audio stream. */
+    void UpdateMetronome();
     void DetectShot();
     void ProcessAnnouncement();
 
@@ -74,6 +76,21 @@ public:
 
     static const int shotVibrationThreshold;
     static const int maxShotDurationMs;
+    /** Inter-measurement period of the ToF sensor, 0 measures back-to-back */
+    static const int tofRangingPeriodMs;
+    /** Time the audio task sleeps while playing, shorter than one I2S DMA buffer */
+    static const unsigned long audioBufferPeriodMs;
+    /** Internal RAM for decoded clip heads, the board has no PSRAM */
+    static const size_t audioCacheBudgetBytes;
+    /** Length of the decoded head of each cached clip */
+    static const uint16_t audioCacheHeadMs;
+    /** Internal RAM for the metronome tick, 32 KB hold 740 ms of the up to 1.1 s long shipped ticks */
+    static const size_t metronomeBudgetBytes;
+
+    /** Notification bits of the detection task */
+    static const uint32_t detectionEventVibration;
+    static const uint32_t detectionEventAudioDone;
+    static const uint32_t detectionEventSettings;
 
     static const char* waitingClip;
     static const char* hitClips[];
@@ -101,11 +118,17 @@ private:
     void AnnounceEvent(const char* traceMsg, const char* sound, unsigned long timeoutMs = 3000UL);
     void PlaySound(const char* soundFileName);
     void UpdateSettings(bool force = false);
+    unsigned long GetDetectionWaitMs();
+    static TickType_t ToTicks(unsigned long ms);
     void WiFiSetup();
     void ApplyDeviceNameByScan();
 
     // Internal objects
     FileSystem fileSystem;
+    /** Persists the log on the file system */
+    LogFile logFile;
+    /** Written by the detection task only */
+    ShotJournal shotJournal;
     WebServer webServer;
     SNTP sntp;
     DNSServer dnsServer;
@@ -117,11 +140,16 @@ private:
     bool announcing;
     unsigned long announcingUntilMs;
     bool distanceOnlyHitDetection;
-    unsigned long lastMetronomeTickTime;
-    unsigned long metronomeIntervalMs;
     unsigned long lastShockTime;
     unsigned long lastHitTime;
     unsigned long afterHitTimeoutMs;
+    int ballHitDetectionDistance;
+    int metronomeSound;
+    int metronomeBpm;
+    int hitSound;
+    int missSound;
+    /** The generation of the settings applied last */
+    uint32_t settingsGeneration;
 
     // Events
     struct Announcement {
@@ -134,17 +162,11 @@ private:
     };
     Announcement::Enum announcement;
 
-    // Statistics
-    int detectedHits = 0;
-    int detectedMisses = 0;
-    
-
     // FreeRTOS Handles
     static TaskHandle_t TaskAudioHandle;
     static TaskHandle_t TaskDetectionHandle;
     static TaskHandle_t TaskLedHandle;
     static TaskHandle_t TaskLoggerHandle;
-    static SemaphoreHandle_t xMutex;
 
     /** Indicates wether or not to continue looping through tasks */
     bool loop = true;
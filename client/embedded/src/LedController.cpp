@@ -18,14 +18,17 @@
 #include <HardwareSerial.h>
 #include <esp32-hal.h>
 #include <math.h>
+#include <limits.h>
 #include "util/Logger.h"
 
 // TODO Transform to constants
 #define DEFAULT_FREQUENCY 5000
 #define DEFAULT_RESOLUTION 8
 
+const unsigned long LedController::noDeadline = ULONG_MAX;
+
 LedController::LedController(int ledPin, int ledChannel) 
-    : mode(LedMode::Standard), channel(ledChannel), lastStepTimeMs(0)
+    : channel(ledChannel), mode(LedMode::Standard), brightnessPc(100), lastStepTimeMs(0)
 {
     ledcSetup(channel, DEFAULT_FREQUENCY, DEFAULT_RESOLUTION);
     ledcAttachPin(ledPin, channel);
@@ -39,55 +42,60 @@ void LedController::SetMode(LedMode mode)
     if (this->mode != mode) {
         this->mode = mode;
         lastStepTimeMs = 0;
-        Logger::log("LedController", Logger::LogLevel::INFO, "%4.3f: LED mode set to '%d'", millis() / 1000.0, this->mode);
+        LOG(LedController, INFO, "%4.3f: LED mode set to '%d'", millis() / 1000.0, this->mode);
     }
 }
 
+void LedController::SetBrightness(int percent)
+{
+    brightnessPc = max(min(percent, 100), 0);
+}
+
 LedMode LedController::GetMode()
 {
     return mode;
 }
 
-void LedController::Loop() 
+unsigned long LedController::Loop() 
 {
     if(mode == LedMode::Standard)
     {
-        RenderPermanentStep(255);
+        return RenderPermanentStep(255);
     }
     else if(mode == LedMode::Fade)
     {
-        RenderFadeStep();
+        return RenderFadeStep();
     }
     else if(mode == LedMode::Flash) 
     {
-        RenderFlashStep();
+        return RenderFlashStep();
     }
     else if (mode == LedMode::Turbo) 
     {
-        RenderTurboStep();
+        return RenderTurboStep();
     }
     else 
     {
-        RenderPermanentStep(0);
+        return RenderPermanentStep(0);
     }
 }
 
 uint8_t LedController::ScaleBrightness(uint8_t value) {
     if (value == 0) return 0;
-    int ledBrightness = Settings::GetInstance()->GetLedBrightness();
-    return (uint8_t)round(value * ledBrightness / 100.0f);
+    return (uint8_t)round(value * brightnessPc / 100.0f);
 }
 
-void LedController::RenderPermanentStep(uint8_t brightness) {
+unsigned long LedController::RenderPermanentStep(uint8_t brightness) {
     static uint8_t prevBrightness = 0;
     uint8_t scaled = ScaleBrightness(brightness);
     if (scaled != prevBrightness) {
         prevBrightness = scaled;
         ledcWrite(channel, prevBrightness);
     }
+    return noDeadline;
 }
 
-void LedController::RenderFadeStep() {
+unsigned long LedController::RenderFadeStep() {
     const unsigned long stepDurationMs = 3;
     static uint32_t dutyCycle = 1;
     static bool fadeUp = true; // fade direction
@@ -106,9 +114,10 @@ void LedController::RenderFadeStep() {
         dutyCycle += (fadeUp ? 1 : -1);
         ledcWrite(channel, ScaleBrightness(dutyCycle));
     }
+    return TimeUntil(lastStepTimeMs + stepDurationMs, now);
 }
 
-void LedController::RenderFlashStep() {
+unsigned long LedController::RenderFlashStep() {
     const unsigned long stepDurationsMs[] = { 500, 100 };
     const unsigned long dutyCycles[] = { 0, 255 };
     static unsigned char phaseIdx = 0;
@@ -125,9 +134,10 @@ void LedController::RenderFlashStep() {
         phaseIdx = (phaseIdx + 1) % 2;
         ledcWrite(channel, ScaleBrightness(dutyCycles[phaseIdx]));
     }
+    return TimeUntil(lastStepTimeMs + stepDurationsMs[phaseIdx], now);
 }
 
-void LedController::RenderTurboStep() {
+unsigned long LedController::RenderTurboStep() {
     const unsigned long stepInactiveDurationMs = 750;
     const unsigned long stepActiveDurationMs = 100;
     const uint32_t flashAmount = 10; // the number of flashes per period
@@ -142,7 +152,7 @@ void LedController::RenderTurboStep() {
         lastStepTimeMs = now - stepActiveDurationMs;
     }
 
-    Logger::logExtra("LedController", Logger::LogLevel::INFO, "%4.3f: LED turbo step %s '%d'", millis() / 1000.0, activePhase ? "flash" : "dark", flashPhaseCount);
+    LOG_EXTRA(LedController, INFO, "%4.3f: LED turbo step %s '%d'", millis() / 1000.0, activePhase ? "flash" : "dark", flashPhaseCount);
     
     if (!activePhase && lastStepTimeMs + stepInactiveDurationMs <= now) {
         activePhase = true;
@@ -154,7 +164,7 @@ void LedController::RenderTurboStep() {
         lastStepTimeMs += stepActiveDurationMs;
         int dutyCycle = flashPhaseCount % 2 == 0 ? 255 : 0;
 
-        Logger::logExtra("LedController", Logger::LogLevel::INFO, "%4.3f: LED turbo duty cycle '%d'", millis() / 1000.0, dutyCycle);
+        LOG_EXTRA(LedController, INFO, "%4.3f: LED turbo duty cycle '%d'", millis() / 1000.0, dutyCycle);
         
         ledcWrite(channel, ScaleBrightness(dutyCycle));
         flashPhaseCount++;
@@ -163,4 +173,9 @@ void LedController::RenderTurboStep() {
             activePhase = false;
         }
     }
+    return TimeUntil(lastStepTimeMs + (activePhase ? stepActiveDurationMs : stepInactiveDurationMs), now);
+}
+
+unsigned long LedController::TimeUntil(unsigned long dueMs, unsigned long now) {
+    return (long)(dueMs - now) > 0 ? dueMs - now : 0;
 }
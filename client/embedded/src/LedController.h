@@ -23,20 +23,31 @@
 class LedController
 {
     private:    
-        void RenderPermanentStep(uint8_t brightness);
-        void RenderFadeStep();
-        void RenderFlashStep();
-        void RenderTurboStep();
+        unsigned long RenderPermanentStep(uint8_t brightness);
+        unsigned long RenderFadeStep();
+        unsigned long RenderFlashStep();
+        unsigned long RenderTurboStep();
         uint8_t ScaleBrightness(uint8_t value);
+        static unsigned long TimeUntil(unsigned long dueMs, unsigned long now);
 
         int channel;
         LedMode mode;
+        /** The brightness in percent */
+        int brightnessPc;
         uint64_t lastStepTimeMs;
 
     public:
+        /** Returned by Loop() if the LED does not change until the mode or brightness changes */
+        static const unsigned long noDeadline;
+
         LedController(int ledPin, int ledChannel);
         ~LedController();
-        void Loop();
+
+        /** Renders the current step and provides the time in ms until the next step is due. */
+        unsigned long Loop();
         void SetMode(LedMode mode);
+
+        /** Sets the brightness in percent that scales all patterns. */
+        void SetBrightness(int percent);
         LedMode GetMode();
 };
\ No newline at end of file
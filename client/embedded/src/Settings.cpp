@@ -19,253 +19,271 @@
 #include <math.h>
 #include "util/Logger.h"
 
-const char* Settings::keyVolume = "volume";
-const int Settings::defaultVolume = 25;
-
-const char* Settings::keyMetronomeSound = "metronomeSound";
-const int Settings::defaultMetronomeSound = 0;
-
-const char* Settings::keyHitSound = "hitSound";
-const int Settings::defaultHitSound = 0;
-
-const char* Settings::keyMissSound = "missSound";
-const int Settings::defaultMissSound = 0;
-
-const char* Settings::keyDeviceName = "deviceName";
-const String Settings::defaultDeviceName = "GoalFinder 01";
-
-const char* Settings::keyDevicePassword = "devicePassword";
-const String Settings::defaultDevicePassword = emptyString;
-
-const char* Settings::keyWifiPassword = "wifiPassword";
-const String Settings::defaultWifiPassword = emptyString;
-
-const char* Settings::keyVibrationSensorSensitivity = "shotSensitivity";
-const int Settings::defaultVibrationSensorSensitivity = 100;
-
-const char* Settings::keyBallHitDetectionDistance = "ballHitDetDist";
-const int Settings::defaultBallHitDetectionDistance = 180;
-
-const char* Settings::keyDistanceOnlyHitDetection = "distOnlyHitDet";
-const bool Settings::defaultDistanceOnlyHitDetection = false;
-
-const char* Settings::keyLedBrightness = "ledBrightness";
-const int Settings::defaultLedBrightness = 100;
-
-const char* Settings::keyLedMode = "ledMode";
-const LedMode Settings::defaultLedMode = LedMode::Flash;
-
-const char* Settings::keyFirstRun = "firstRun";
-const bool Settings::defaultFirstRun = true;
-
-const char* Settings::keyAfterHitTimeout = "afterHitTimeout";
-const int Settings::defaultAfterHitTimeout = 5;
-
-const char* Settings::keyUpdateSuccess = "updateSuccess";
-const bool Settings::defaultUpdateSuccess = false;
-
-const char* Settings::keyExtraLog = "extraLog";
-const bool Settings::defaultExtraLog = false;
+const char* Settings::keyBlob = "settings";
+const uint16_t Settings::blobVersion = 1;
 	
 Settings::Settings() :
     Singleton<Settings>(),
 	store(),
-	modified(false)
+	blob(store, keyBlob, blobVersion),
+	current(&snapshots[0]),
+	pending(nullptr),
+	generationCounter(0),
+	changeMutex(xSemaphoreCreateRecursiveMutex()),
+	changeDepth(0),
+	pendingChanged(false),
+	subscriberCount(0)
 {
     store.Begin("app_prefs");
+	Load();
 }
 
  Settings::~Settings() {
+	vSemaphoreDelete(changeMutex);
  }
 
-String Settings::GetMacAddress() {
-	return String(WiFi.macAddress());
+void Settings::Load() {
+	SettingsSnapshot* snapshot = &snapshots[0];
+	if (!blob.Load(*snapshot)) {
+		// the first boot after an update, or a blob that cannot be read: the separate keys or their defaults
+		LoadKeys(snapshot);
+		if (blob.Save(*snapshot)) {
+			RemoveKeys();
+			LOG(Settings, INFO, "Moved the settings into one blob");
+		} else {
+			LOG(Settings, ERROR, "Could not store the settings blob");
+		}
+	}
+	snapshot->generation = ++generationCounter;
+	// cached by the logger, which must not access the settings for every message
+	Logger::SetExtraLog(snapshot->extraLog);
 }
 
-int Settings::GetVolume() {
-	return store.GetInt(keyVolume, defaultVolume);
+void Settings::LoadKeys(StoredSettings* settings) {
+	#define SETTING_LOAD_KEY(kind, Name, field, key, api, low, high, def) LoadKey(key, &settings->field, def);
+	SETTINGS_SCHEMA(SETTING_LOAD_KEY)
+	#undef SETTING_LOAD_KEY
 }
 
-void Settings::SetVolume(int volume) {
-	volume = max(min(volume, 100), 0);
-	store.PutInt(keyVolume, volume);
-	SetModified();
+void Settings::LoadKey(const char* key, int* value, int defaultValue) {
+	*value = store.GetInt(key, defaultValue);
 }
 
-void Settings::SetMetronomeSound(int metronomeSound) {
-	metronomeSound = max(min(metronomeSound, 2), 0);
-	store.PutInt(keyMetronomeSound, metronomeSound);
-	SetModified();
+void Settings::LoadKey(const char* key, bool* value, bool defaultValue) {
+	*value = (bool)store.GetInt(key, (int)defaultValue);
 }
 
-int Settings::GetMetronomeSound() {
-	return store.GetInt(keyMetronomeSound, defaultMetronomeSound);
+void Settings::LoadKey(const char* key, LedMode* value, LedMode defaultValue) {
+	*value = (LedMode)store.GetInt(key, (int)defaultValue);
 }
 
-int Settings::GetHitSound() {
-	return store.GetInt(keyHitSound, defaultHitSound);
+template <size_t N>
+void Settings::LoadKey(const char* key, char (*value)[N], const char* defaultValue) {
+	String text = store.IsKey(key) ? store.GetString(key, defaultValue) : String(defaultValue);
+	if (text.length() >= N) {
+		// older firmwares had no length limits, the blob only holds the characters a setter accepts
+		LOG(Settings, WARN, "Cutting %s from %u to %u characters", key, (unsigned)text.length(), (unsigned)(N - 1));
+	}
+	strlcpy(*value, text.c_str(), N);
 }
 
-void Settings::SetHitSound(int hitSound) {
-	hitSound = max(min(hitSound, 2), 0);
-	store.PutInt(keyHitSound, hitSound);
-	SetModified();
+void Settings::RemoveKeys() {
+	#define SETTING_KEY(kind, Name, field, key, api, low, high, def) key,
+	const char* keys[] = { SETTINGS_SCHEMA(SETTING_KEY) };
+	#undef SETTING_KEY
+	for (const char* key : keys) {
+		if (store.IsKey(key)) {
+			store.Remove(key);
+		}
+	}
 }
 
-void Settings::SetMissSound(int missSound) {
-	missSound = max(min(missSound, 2), 0);
-	store.PutInt(keyMissSound, missSound);
-	SetModified();
+const SettingsSnapshot* Settings::Current() const {
+	return current.load(std::memory_order_acquire);
 }
 
-int Settings::GetMissSound() {
-	return store.GetInt(keyMissSound, defaultMissSound);
+SettingsSnapshot Settings::GetSnapshot() const {
+	SettingsSnapshot copy;
+	while (true) {
+		const SettingsSnapshot* snapshot = Current();
+		uint32_t generation = __atomic_load_n(&snapshot->generation, __ATOMIC_ACQUIRE);
+		copy = *snapshot;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		// retry if a writer started reusing the slot while it was copied
+		if (generation != 0 && __atomic_load_n(&snapshot->generation, __ATOMIC_RELAXED) == generation) {
+			copy.generation = generation;
+			return copy;
+		}
+	}
 }
 
-
-bool Settings::IsModified() const {
-	return modified;
+uint32_t Settings::GetGeneration() const {
+	return Current()->generation;
 }
 
-void Settings::SetModified() {
-	modified = true;
+bool Settings::Subscribe(TaskHandle_t task, uint32_t notifyBits) {
+	bool subscribed = false;
+	xSemaphoreTakeRecursive(changeMutex, portMAX_DELAY);
+	if (subscriberCount < maxSubscribers) {
+		subscribers[subscriberCount++] = { task, notifyBits };
+		subscribed = true;
+	}
+	xSemaphoreGiveRecursive(changeMutex);
+	return subscribed;
 }
 
-void Settings::ClearModifiedState() {
-	modified = false;
+bool Settings::BeginChanges(uint32_t expectedGeneration) {
+	BeginChange();
+	if (expectedGeneration != 0 && Current()->generation != expectedGeneration) {
+		// nothing changed, so nothing is published
+		CommitChange();
+		return false;
+	}
+	return true;
 }
 
+void Settings::CommitChanges() {
+	CommitChange();
+}
 
-String Settings::GetDeviceName()
-{
-	return store.GetString(keyDeviceName, defaultDeviceName);
-};
-
-void Settings::SetDeviceName(String deviceName)
-{
-	if(deviceName.isEmpty())
-	{
-		deviceName = defaultDeviceName;
+SettingsSnapshot* Settings::BeginChange() {
+	xSemaphoreTakeRecursive(changeMutex, portMAX_DELAY);
+	if (changeDepth++ > 0) {
+		// a setter within BeginChanges() and CommitChanges() modifies the same copy
+		return pending;
 	}
-	
-	store.PutString(keyDeviceName, deviceName);
-	SetModified(); 
-};
-
-String Settings::GetDevicePassword()
-{
-	return store.IsKey(keyDevicePassword) ? store.GetString(keyDevicePassword, defaultDevicePassword) : defaultDevicePassword;
-};
+	const SettingsSnapshot* snapshot = Current();
+	pending = &snapshots[(snapshot - snapshots + 1) % snapshotSlots];
+	// invalidate the slot first, readers still copying it will retry
+	__atomic_store_n(&pending->generation, 0, __ATOMIC_RELEASE);
+	SettingsSnapshot copy = *snapshot;
+	copy.generation = 0;
+	*pending = copy;
+	pendingChanged = false;
+	return pending;
+}
 
-void Settings::SetDevicePassword(String devicePassword)
-{
-	if(devicePassword.isEmpty())
-	{
-		if (store.IsKey(keyDevicePassword)) {
-			store.Remove(keyDevicePassword);
+void Settings::CommitChange() {
+	if (--changeDepth == 0) {
+		// an unchanged copy is dropped, the slot is not the current one
+		if (pendingChanged) {
+			// a single write of all settings
+			if (!blob.Save(*pending)) {
+				LOG(Settings, ERROR, "Could not store the settings blob");
+			}
+			__atomic_store_n(&pending->generation, ++generationCounter, __ATOMIC_RELEASE);
+			current.store(pending, std::memory_order_release);
+			Logger::SetExtraLog(pending->extraLog);
+			for (int i = 0; i < subscriberCount; i++) {
+				xTaskNotify(subscribers[i].task, subscribers[i].notifyBits, eSetBits);
+			}
 		}
+		pending = nullptr;
 	}
-	else 
-	{
-		store.PutString(keyDevicePassword, devicePassword);
-	}
-	SetModified();
-};
-
-String Settings::GetWifiPassword()
-{
-	return store.IsKey(keyWifiPassword) ? store.GetString(keyWifiPassword, defaultWifiPassword) : defaultWifiPassword;
-};
+	xSemaphoreGiveRecursive(changeMutex);
+}
 
-void Settings::SetWifiPassword(String wifiPassword)
-{
-	wifiPassword.trim();
+template <typename T>
+T Settings::Get(T StoredSettings::* field) const {
+	return Current()->*field;
+}
 
-	if(wifiPassword.isEmpty())
-	{
-		if (store.IsKey(keyWifiPassword)) {
-			store.Remove(keyWifiPassword);
-		}
-	} else {
-		if (wifiPassword.length() < 8 || wifiPassword.length() > 63)
-		{
-			Logger::log("Settings", Logger::LogLevel::WARN, "Ignoring invalid WiFi password length. Expected 8-63 characters.");
-			return;
-		}
+template <size_t N>
+String Settings::Get(char (StoredSettings::* field)[N]) const {
+	// copied from a consistent snapshot, a string cannot be read at once
+	return String(GetSnapshot().*field);
+}
 
-		store.PutString(keyWifiPassword, wifiPassword);
+template <typename T>
+void Settings::Set(const char*, T StoredSettings::* field, T value, T low, T high, T) {
+	value = value < low ? low : (value > high ? high : value);
+	SettingsSnapshot* snapshot = BeginChange();
+	if (snapshot->*field != value) {
+		snapshot->*field = value;
+		pendingChanged = true;
 	}
-
-	SetModified();
-};
-
-int Settings::GetVibrationSensorSensitivity()
-{
-	return store.GetInt(keyVibrationSensorSensitivity, defaultVibrationSensorSensitivity);
+	CommitChange();
 }
 
-void Settings::SetVibrationSensorSensitivity(int vibrationSensorSensitivity)
-{
-	vibrationSensorSensitivity = max(min(vibrationSensorSensitivity, 100), 0);
-	store.PutInt(keyVibrationSensorSensitivity, vibrationSensorSensitivity);
-	SetModified();
-};
-
-int Settings::GetBallHitDetectionDistance() 
-{
-	return store.GetInt(keyBallHitDetectionDistance, defaultBallHitDetectionDistance);
+template <size_t N>
+void Settings::Set(const char* name, char (StoredSettings::* field)[N], String value, int low, int high, const char* defaultValue) {
+	if (!Normalize(value, low, high, defaultValue)) {
+		LOG(Settings, WARN, "Ignoring %s of invalid length. Expected %d-%d characters.", name, low, high);
+		return;
+	}
+	SettingsSnapshot* snapshot = BeginChange();
+	if (strcmp(snapshot->*field, value.c_str()) != 0) {
+		strlcpy(snapshot->*field, value.c_str(), N);
+		pendingChanged = true;
+	}
+	CommitChange();
 }
 
-void Settings::SetBallHitDetectionDistance(int ballHitDetectionDistance)
-{
-	ballHitDetectionDistance = max(min(ballHitDetectionDistance, 600), 100);
-	store.PutInt(keyBallHitDetectionDistance, ballHitDetectionDistance);
-	SetModified();
+template <typename T>
+bool Settings::IsValid(JsonVariantConst, T StoredSettings::*, T, T, T) {
+	return true;
 }
 
-bool Settings::GetDistanceOnlyHitDetection()
-{
-	return (bool)store.GetInt(keyDistanceOnlyHitDetection, (int)defaultDistanceOnlyHitDetection);
+template <size_t N>
+bool Settings::IsValid(JsonVariantConst value, char (StoredSettings::*)[N], int low, int high, const char* defaultValue) {
+	if (!value.is<const char*>()) {
+		return false;
+	}
+	String string = value.as<const char*>();
+	return Normalize(string, low, high, defaultValue);
 }
 
-void Settings::SetDistanceOnlyHitDetection(bool distanceOnlyHitDetection)
-{
-	store.PutInt(keyDistanceOnlyHitDetection, (int)distanceOnlyHitDetection);
-	SetModified();
+bool Settings::Normalize(String& value, int low, int high, const char* defaultValue) {
+	value.trim();
+	if (value.isEmpty()) {
+		value = defaultValue;
+	}
+	return value.isEmpty() || ((int)value.length() >= low && (int)value.length() <= high);
 }
 
-int Settings::GetLedBrightness()
-{
-	return store.GetInt(keyLedBrightness, defaultLedBrightness);
+#define SETTING_ACCESSORS(kind, Name, field, key, api, low, high, def) \
+	SETTING_TYPE_##kind Settings::Get##Name() { \
+		return Get(&StoredSettings::field); \
+	} \
+	void Settings::Set##Name(SETTING_TYPE_##kind value) { \
+		Set(#field, &StoredSettings::field, value, low, high, def); \
+	}
+SETTINGS_SCHEMA(SETTING_ACCESSORS)
+#undef SETTING_ACCESSORS
+
+void Settings::Patch(JsonObjectConst object) {
+	BeginChange();
+	#define SETTING_PATCH(kind, Name, field, key, api, low, high, def) \
+		if (api && !object[#field].isNull()) { \
+			Set##Name((SETTING_TYPE_##kind)object[#field].as<SETTING_JSON_TYPE_##kind>()); \
+		}
+	SETTINGS_SCHEMA(SETTING_PATCH)
+	#undef SETTING_PATCH
+	CommitChange();
 }
 
-void Settings::SetLedBrightness(int ledBrightness)
-{
-	ledBrightness = max(min(ledBrightness, 100), 0);
-	store.PutInt(keyLedBrightness, ledBrightness);
-	SetModified();
+String Settings::Validate(JsonObjectConst object) {
+	String rejected;
+	#define SETTING_VALIDATE(kind, Name, field, key, api, low, high, def) \
+		if (api && !object[#field].isNull() && !IsValid(object[#field], &StoredSettings::field, low, high, def)) { \
+			rejected += rejected.isEmpty() ? #field : ", " #field; \
+		}
+	SETTINGS_SCHEMA(SETTING_VALIDATE)
+	#undef SETTING_VALIDATE
+	return rejected;
 }
 
-LedMode Settings::GetLedMode()
-{
-	return (LedMode)store.GetInt(keyLedMode, (int)defaultLedMode);
-};
-
-void Settings::SetLedMode(LedMode ledMode)
-{
-	store.PutInt(keyLedMode, (int)ledMode);
-	SetModified();
-};
-
-bool Settings::IsFirstRun()
-{
-	return (bool)store.GetInt(keyFirstRun, (int)defaultFirstRun);
+void Settings::ToJson(const StoredSettings& settings, JsonObject object) {
+	#define SETTING_TO_JSON(kind, Name, field, key, api, low, high, def) \
+		if (api) { \
+			object[#field] = (SETTING_JSON_TYPE_##kind)settings.field; \
+		}
+	SETTINGS_SCHEMA(SETTING_TO_JSON)
+	#undef SETTING_TO_JSON
 }
 
-void Settings::SetFirstRun(bool firstRun)
-{
-	store.PutInt(keyFirstRun, (int)firstRun);
-	SetModified();
+String Settings::GetMacAddress() {
+	return String(WiFi.macAddress());
 }
   
 void Settings::ResetToDefaults()
@@ -273,36 +291,3 @@ void Settings::ResetToDefaults()
 	store.Clear();
 	ESP.restart();
 }
-
-int Settings::GetAfterHitTimeout()
-{
-	return store.GetInt(keyAfterHitTimeout, defaultAfterHitTimeout);
-}
-
-void Settings::SetAfterHitTimeout(int timeout) 
-{
-	timeout = max(min(timeout, 60), 0);
-	store.PutInt(keyAfterHitTimeout, timeout);
-	SetModified();
-}
-
-bool Settings::GetUpdateSuccess()
-{
-	return (bool)store.GetInt(keyUpdateSuccess, (int)defaultUpdateSuccess);
-}
-
-void Settings::SetUpdateSuccess(bool success)
-{
-	store.PutInt(keyUpdateSuccess, (int)success);
-}
-
-bool Settings::GetExtraLog()
-{
-	return (bool)store.GetInt(keyExtraLog, (int)defaultExtraLog);
-}
-
-void Settings::SetExtraLog(bool enabled)
-{
-	store.PutInt(keyExtraLog, (int)enabled);
-	SetModified();
-}
@@ -16,143 +16,163 @@
 
 #pragma once
 #include <Arduino.h>
+#include <atomic>
 #include <Singleton.h>
 #include <system/Settings.h>
-#include "LedMode.h"
+#include <system/SettingsBlob.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <ArduinoJson.h>
+#include "SettingsSchema.h"
+
+/** 
+ * The values of all settings, stored in NVS as one blob. The fields are
+ * generated from SETTINGS_SCHEMA, see SettingsSchema.h.
+ */
+struct StoredSettings
+{
+    #define SETTING_STORED_FIELD(kind, Name, field, key, api, low, high, def) SETTING_FIELD_##kind(field, high)
+    SETTINGS_SCHEMA(SETTING_STORED_FIELD)
+    #undef SETTING_STORED_FIELD
+};
+
+/** 
+ * Immutable copy of all settings. A new snapshot with a higher generation
+ * is published on every change, so readers never access NVS.
+ */
+struct SettingsSnapshot : public StoredSettings
+{
+    /** Increments with every published change, 0 marks a snapshot under construction */
+    uint32_t generation;
+};
 
 class Settings : public Singleton<Settings>
 {
     public:
         virtual ~Settings();
 
-        bool IsModified() const;
-
-        void ClearModifiedState();
-
-        /** Provides the MAC address of the WiFi interface. */
-        String GetMacAddress();
-
-        /** Provides the volume as a range from 0 to 100 percent. */
-        int GetVolume();
-
-        /** Sets the volume. The range is clipped to 0 to 100 percent.*/
-        void SetVolume(int volume);
-
-        void SetMetronomeSound(int metronomeSound);
-
-        int GetMetronomeSound();
-
-        void SetHitSound(int hitSound);
-
-        int GetHitSound();
-
-        void SetMissSound(int missSound);
-
-        int GetMissSound();
-
-        String GetDeviceName();
-
-        void SetDeviceName(String deviceName);
-
-        String GetDevicePassword();
-
-        void SetDevicePassword(String devicePassword);
-
-        String GetWifiPassword();
-
-        void SetWifiPassword(String wifiPassword);
-
-        int GetVibrationSensorSensitivity();
-
-        void SetVibrationSensorSensitivity(int vibrationSensorSensitivity);
+        /** Provides a consistent copy of the current settings without locking. */
+        SettingsSnapshot GetSnapshot() const;
 
-        int GetBallHitDetectionDistance();
+        /** Provides the generation of the current settings, which changes on every write. */
+        uint32_t GetGeneration() const;
 
-        void SetBallHitDetectionDistance(int ballHitDetectionDistance);
+        /** 
+         * Notifies the given task with the given bits whenever a new generation is published.
+         * Returns false if no more subscribers can be registered.
+         */
+        bool Subscribe(TaskHandle_t task, uint32_t notifyBits);
 
-        bool GetDistanceOnlyHitDetection();
+        /**
+         * Groups the following setter calls of the task into one change, which is published as a
+         * single generation by CommitChanges(). Fails without starting a change if the current
+         * generation is not the expected one, 0 expects none.
+         */
+        bool BeginChanges(uint32_t expectedGeneration = 0);
 
-        void SetDistanceOnlyHitDetection(bool distanceOnlyHitDetection);
+        /** Publishes the changes since BeginChanges(), nothing if every value was set to what it was. */
+        void CommitChanges();
 
-        int GetLedBrightness();
-
-        void SetLedBrightness(int ledBrightness);
+        /** Provides the MAC address of the WiFi interface. */
+        String GetMacAddress();
 
-        LedMode GetLedMode();
+        /** 
+         * Get<Name>() and Set<Name>() of every setting in SETTINGS_SCHEMA. A setter clips a number
+         * to its range and ignores a string of an invalid length, an empty string sets the default.
+         */
+        #define SETTING_ACCESSORS(kind, Name, field, key, api, low, high, def) \
+            SETTING_TYPE_##kind Get##Name(); \
+            void Set##Name(SETTING_TYPE_##kind value);
+        SETTINGS_SCHEMA(SETTING_ACCESSORS)
+        #undef SETTING_ACCESSORS
 
-        void SetLedMode(LedMode ledMode);
+        /** Sets the settings of /api/settings contained in the object, the others are left unchanged. */
+        void Patch(JsonObjectConst object);
 
-        bool IsFirstRun();
+        /** Lists the settings of the object that Patch() would ignore, separated by commas, empty if it has none. */
+        static String Validate(JsonObjectConst object);
 
-        void SetFirstRun(bool firstRun);
+        /** Adds the settings of /api/settings to the object. */
+        static void ToJson(const StoredSettings& settings, JsonObject object);
 
         void ResetToDefaults();
 
-        int GetAfterHitTimeout();
-
-        void SetAfterHitTimeout(int timeout);
-
-        bool GetUpdateSuccess();
-
-        void SetUpdateSuccess(bool success);
-
-        bool GetExtraLog();
-        void SetExtraLog(bool enabled);
-
     private:
 		friend class Singleton<Settings>;
         /** Singleton constructor */
         Settings();
-        void SetModified();
-
-        static const char* keyVolume;
-        static const int defaultVolume;
-
-        static const char* keyMetronomeSound;
-        static const int defaultMetronomeSound;
-
-        static const char* keyHitSound;
-        static const int defaultHitSound;
-
-        static const char* keyMissSound;
-        static const int defaultMissSound;
-
-        static const char* keyDeviceName;
-        static const String defaultDeviceName;
-
-        static const char* keyDevicePassword;
-        static const String defaultDevicePassword;
-
-        static const char* keyWifiPassword;
-        static const String defaultWifiPassword;
-
-        static const char* keyVibrationSensorSensitivity;
-        static const int defaultVibrationSensorSensitivity;
-
-        static const char* keyBallHitDetectionDistance;
-        static const int defaultBallHitDetectionDistance;
-
-        static const char* keyDistanceOnlyHitDetection;
-        static const bool defaultDistanceOnlyHitDetection;
-
-        static const char* keyLedBrightness;
-        static const int defaultLedBrightness;
-
-        static const char* keyLedMode;
-        static const LedMode defaultLedMode;
-
-        static const char* keyFirstRun;
-        static const bool defaultFirstRun;
-
-        static const char* keyAfterHitTimeout;
-        static const int defaultAfterHitTimeout;
-
-        static const char* keyUpdateSuccess;
-        static const bool defaultUpdateSuccess;
 
-        static const char* keyExtraLog;
-        static const bool defaultExtraLog;
+        /** Loads all settings from NVS into the first snapshot. */
+        void Load();
+
+        /** Reads the settings stored as separate keys, by firmwares before the settings blob. */
+        void LoadKeys(StoredSettings* settings);
+        void RemoveKeys();
+
+        /** Provides the latest published snapshot. */
+        const SettingsSnapshot* Current() const;
+
+        /** Locks out other writers and provides a copy of the current snapshot to modify. */
+        SettingsSnapshot* BeginChange();
+
+        /** 
+         * Stores and publishes the snapshot provided by BeginChange() and notifies all subscribers,
+         * unless it is unchanged or the outermost BeginChanges() has not been committed yet.
+         */
+        void CommitChange();
+
+        /** Reads a setting stored as a separate key, or its default. */
+        void LoadKey(const char* key, int* value, int defaultValue);
+        void LoadKey(const char* key, bool* value, bool defaultValue);
+        void LoadKey(const char* key, LedMode* value, LedMode defaultValue);
+        template <size_t N>
+        void LoadKey(const char* key, char (*value)[N], const char* defaultValue);
+
+        /** Provides a field of the current snapshot. */
+        template <typename T>
+        T Get(T StoredSettings::* field) const;
+        template <size_t N>
+        String Get(char (StoredSettings::* field)[N]) const;
+
+        /** Sets a field of a new snapshot after validating the value, nothing is published if it is unchanged. */
+        template <typename T>
+        void Set(const char* name, T StoredSettings::* field, T value, T low, T high, T defaultValue);
+        template <size_t N>
+        void Set(const char* name, char (StoredSettings::* field)[N], String value, int low, int high, const char* defaultValue);
+
+        /** Whether a setter accepts the JSON value of a field, a number is always clipped to its range. */
+        template <typename T>
+        static bool IsValid(JsonVariantConst value, T StoredSettings::* field, T low, T high, T defaultValue);
+        template <size_t N>
+        static bool IsValid(JsonVariantConst value, char (StoredSettings::* field)[N], int low, int high, const char* defaultValue);
+        /** Trims a string and replaces an empty one by the default, false if its length is out of range. */
+        static bool Normalize(String& value, int low, int high, const char* defaultValue);
+
+        static const char* keyBlob;
+        static const uint16_t blobVersion;
+
+        /** Number of snapshot slots, readers copying a slot must not be lapped by writers */
+        static const int snapshotSlots = 4;
+        static const int maxSubscribers = 4;
 
         System::Settings store;
-        bool modified;
+        System::SettingsBlob<StoredSettings> blob;
+
+        SettingsSnapshot snapshots[snapshotSlots];
+        std::atomic<SettingsSnapshot*> current;
+        SettingsSnapshot* pending;
+        uint32_t generationCounter;
+        /** Recursive, as setters nest within BeginChanges() and CommitChanges() */
+        SemaphoreHandle_t changeMutex;
+        int changeDepth;
+        /** Whether a setter modified the pending snapshot */
+        bool pendingChanged;
+
+        struct Subscriber {
+            TaskHandle_t task;
+            uint32_t notifyBits;
+        };
+        Subscriber subscribers[maxSubscribers];
+        int subscriberCount;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+#include "LedMode.h"
+
+/*
+ * The schema of the settings, one line per setting:
+ *
+ *   SETTING(kind, Name, field, key, api, min, max, default)
+ *
+ * kind     Int, Bool, LedMode or String
+ * Name     Settings::GetName() and Settings::SetName() are generated
+ * field    Member of StoredSettings and name in the JSON of /api/settings
+ * key      NVS key of firmwares before the settings blob, only read once to move the settings into the blob
+ * api      Whether the setting is served and set by /api/settings
+ * min/max  Range numbers are clipped to, length range of a string, which is rejected outside of it
+ * default  Value of a new device, an empty string is replaced by it
+ *
+ * The order and the kinds make up the layout of the settings blob, a change
+ * requires a new Settings::blobVersion.
+ */
+#define SETTINGS_SCHEMA(SETTING) \
+    SETTING(Int,     Volume,                     volume,                     "volume",          true,  0,        100, 25) \
+    SETTING(Int,     MetronomeSound,             metronomeSound,             "metronomeSound",  true,  0,        2,   0) \
+    SETTING(Int,     MetronomeBpm,               metronomeBpm,               "metronomeBpm",    true,  20,       240, 30) \
+    SETTING(Int,     HitSound,                   hitSound,                   "hitSound",        true,  0,        2,   0) \
+    SETTING(Int,     MissSound,                  missSound,                  "missSound",       true,  0,        2,   0) \
+    SETTING(String,  DeviceName,                 deviceName,                 "deviceName",      true,  0,        32,  "GoalFinder 01") \
+    SETTING(String,  DevicePassword,             devicePassword,             "devicePassword",  true,  0,        64,  "") \
+    SETTING(String,  WifiPassword,               wifiPassword,               "wifiPassword",    true,  8,        63,  "") \
+    SETTING(Int,     VibrationSensorSensitivity, vibrationSensorSensitivity, "shotSensitivity", true,  0,        100, 100) \
+    SETTING(Int,     BallHitDetectionDistance,   ballHitDetectionDistance,   "ballHitDetDist",  true,  100,      600, 180) \
+    SETTING(Bool,    DistanceOnlyHitDetection,   distanceOnlyHitDetection,   "distOnlyHitDet",  true,  false,    true, false) \
+    SETTING(Int,     LedBrightness,              ledBrightness,              "ledBrightness",   true,  0,        100, 100) \
+    SETTING(LedMode, LedMode,                    ledMode,                    "ledMode",         true,  Standard, Off, Flash) \
+    SETTING(Bool,    FirstRun,                   firstRun,                   "firstRun",        false, false,    true, true) \
+    SETTING(Int,     AfterHitTimeout,            afterHitTimeout,            "afterHitTimeout", true,  0,        60,  5) \
+    SETTING(Bool,    UpdateSuccess,              updateSuccess,              "updateSuccess",   false, false,    true, false) \
+    SETTING(Bool,    ExtraLog,                   extraLog,                   "extraLog",        false, false,    true, false)
+
+/** The type of the accessors of a kind */
+#define SETTING_TYPE_Int     int
+#define SETTING_TYPE_Bool    bool
+#define SETTING_TYPE_LedMode LedMode
+#define SETTING_TYPE_String  String
+
+/** The member of StoredSettings of a kind, a string holds max characters */
+#define SETTING_FIELD_Int(field, max)     int field;
+#define SETTING_FIELD_Bool(field, max)    bool field;
+#define SETTING_FIELD_LedMode(field, max) LedMode field;
+#define SETTING_FIELD_String(field, max)  char field[(max) + 1];
+
+/** The type of a kind in JSON */
+#define SETTING_JSON_TYPE_Int     int
+#define SETTING_JSON_TYPE_Bool    bool
+#define SETTING_JSON_TYPE_LedMode int
+#define SETTING_JSON_TYPE_String  const char*
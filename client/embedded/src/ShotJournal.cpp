@@ -0,0 +1,91 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "ShotJournal.h"
+
+ShotJournal::ShotJournal() : lastSequence(0)
+{
+    memset(events, 0, sizeof(events));
+    for (size_t i = 0; i < (size_t)ShotEventType::Count; i++) {
+        counts[i].store(0);
+    }
+}
+
+uint32_t ShotJournal::Append(ShotEventType type)
+{
+    uint32_t sequence = lastSequence.load(std::memory_order_relaxed) + 1;
+    ShotEvent& slot = events[sequence & (capacity - 1)];
+    // invalidate the slot first, so that readers copying the old event retry
+    __atomic_store_n(&slot.sequence, 0, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampMs = millis();
+    slot.type = type;
+    __atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+    counts[(size_t)type].fetch_add(1, std::memory_order_relaxed);
+    lastSequence.store(sequence, std::memory_order_release);
+    return sequence;
+}
+
+uint32_t ShotJournal::GetLastSequence() const
+{
+    return lastSequence.load(std::memory_order_acquire);
+}
+
+uint32_t ShotJournal::GetFirstSequence() const
+{
+    uint32_t last = GetLastSequence();
+    return last > capacity ? last - capacity + 1 : 1;
+}
+
+uint32_t ShotJournal::GetCount(ShotEventType type) const
+{
+    return counts[(size_t)type].load(std::memory_order_relaxed);
+}
+
+size_t ShotJournal::Read(uint32_t since, ShotEvent* copies, size_t maxCount) const
+{
+    uint32_t last = GetLastSequence();
+    uint32_t sequence = max(since + 1, GetFirstSequence());
+    size_t count = 0;
+    for (; sequence <= last && count < maxCount; sequence++) {
+        const ShotEvent& slot = events[sequence & (capacity - 1)];
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != sequence) {
+            // overwritten since the last sequence was read, newer events follow in later slots
+            continue;
+        }
+        ShotEvent copy = slot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == sequence) {
+            copy.sequence = sequence;
+            copies[count++] = copy;
+        }
+    }
+    return count;
+}
+
+const char* ShotJournal::GetTypeName(ShotEventType type)
+{
+    switch (type) {
+        case ShotEventType::Shot:
+            return "shot";
+        case ShotEventType::Hit:
+            return "hit";
+        case ShotEventType::Miss:
+            return "miss";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/** The kinds of events detected during a game */
+enum class ShotEventType : uint8_t
+{
+    Shot,
+    Hit,
+    Miss,
+    Count
+};
+
+struct ShotEvent
+{
+    /** Increments with every event since the start of the device, starts at 1 */
+    uint32_t sequence;
+    /** The device time the event was detected at */
+    uint32_t timestampMs;
+    ShotEventType type;
+};
+
+/**
+ * Keeps the latest detected events in RAM, so that any number of clients can
+ * follow them with their own cursor instead of consuming shared counters.
+ *
+ * Only the detection task appends. Readers on other tasks copy the slots
+ * without a lock and retry a slot the writer reused while it was copied,
+ * like the snapshots of the settings.
+ */
+class ShotJournal
+{
+    public:
+        static const size_t capacity = 64;
+
+        ShotJournal();
+
+        /** Records an event (detection task only), returns its sequence number. */
+        uint32_t Append(ShotEventType type);
+
+        /** Provides the sequence number of the latest event, 0 if there is none. */
+        uint32_t GetLastSequence() const;
+        /** Provides the sequence number of the oldest event still stored. */
+        uint32_t GetFirstSequence() const;
+        /** Provides the number of events of a type since the start of the device. */
+        uint32_t GetCount(ShotEventType type) const;
+
+        /**
+         * Copies the stored events following a sequence number, oldest first.
+         * Returns the number of events copied.
+         */
+        size_t Read(uint32_t since, ShotEvent* events, size_t maxCount) const;
+
+        static const char* GetTypeName(ShotEventType type);
+
+    private:
+        static_assert((capacity & (capacity - 1)) == 0, "ShotJournal capacity must be a power of two");
+
+        ShotEvent events[capacity];
+        std::atomic<uint32_t> lastSequence;
+        std::atomic<uint32_t> counts[(size_t)ShotEventType::Count];
+};
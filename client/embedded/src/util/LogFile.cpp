@@ -0,0 +1,259 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "LogFile.h"
+
+#define LOG_DIR "/logs"
+
+LogFile::LogFile(FileSystem* fileSystem) :
+    fileSystem(fileSystem),
+    hasPrevious(false),
+    batchLength(0),
+    batchSinceMs(0),
+    writeFailed(false),
+    droppedBytes(0),
+    suspended(false)
+{
+    mutex = xSemaphoreCreateMutex();
+    previous = { 0, 0 };
+    current = { 0, 0 };
+}
+
+LogFile::~LogFile()
+{
+    vSemaphoreDelete(mutex);
+}
+
+bool LogFile::Begin()
+{
+    fs::FS* fs = fileSystem->GetInternalFileSystem();
+    if (!fs->exists(LOG_DIR) && !fs->mkdir(LOG_DIR)) {
+        return false;
+    }
+
+    // keep the two newest files, their names are the offsets of their first bytes
+    Segment newest = { 0, 0 };
+    Segment older = { 0, 0 };
+    uint8_t foundCount = 0;
+    uint32_t obsolete[8];
+    uint8_t obsoleteCount = 0;
+    File dir = fs->open(LOG_DIR);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+        const char* name = strrchr(entry.name(), '/');
+        name = name != nullptr ? name + 1 : entry.name();
+        char* end;
+        Segment segment = { (uint32_t)strtoul(name, &end, 16), (uint32_t)entry.size() };
+        entry.close();
+        if (end == name || strcmp(end, ".log") != 0) {
+            continue;
+        }
+        Segment dropped = segment;
+        if (foundCount == 0 || segment.start > newest.start) {
+            dropped = older;
+            older = newest;
+            newest = segment;
+        } else if (foundCount == 1 || segment.start > older.start) {
+            dropped = older;
+            older = segment;
+        }
+        if (++foundCount > 2 && obsoleteCount < sizeof(obsolete) / sizeof(obsolete[0])) {
+            obsolete[obsoleteCount++] = dropped.start;
+        }
+    }
+    dir.close();
+    char path[32];
+    for (uint8_t i = 0; i < obsoleteCount; i++) {
+        GetPath(obsolete[i], path, sizeof(path));
+        fs->remove(path);
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (foundCount > 0) {
+        current = newest;
+        previous = older;
+        hasPrevious = foundCount > 1;
+    }
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+void LogFile::Append(const char* text, size_t length)
+{
+    if (batchLength == 0) {
+        batchSinceMs = millis();
+    }
+    while (length > 0) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        if (suspended) {
+            xSemaphoreGive(mutex);
+            return;
+        }
+        size_t count = min(length, blockSize - batchLength);
+        if (count == 0) {
+            // the lines collected while the file cannot be written fill the batch
+            droppedBytes += length;
+            xSemaphoreGive(mutex);
+            return;
+        }
+        memcpy(batch + batchLength, text, count);
+        batchLength += count;
+        xSemaphoreGive(mutex);
+        text += count;
+        length -= count;
+        // lines may be split, the file is a stream of bytes
+        if (!writeFailed && batchLength >= blockSize - current.size % blockSize) {
+            Flush(false);
+        }
+    }
+}
+
+void LogFile::Loop()
+{
+    if (batchLength > 0 && millis() - batchSinceMs >= flushIntervalMs) {
+        Flush(true);
+    }
+}
+
+unsigned long LogFile::GetFlushWaitMs() const
+{
+    if (batchLength == 0) {
+        return ULONG_MAX;
+    }
+    unsigned long waitedMs = millis() - batchSinceMs;
+    return waitedMs >= flushIntervalMs ? 0 : flushIntervalMs - waitedMs;
+}
+
+void LogFile::Suspend()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (!suspended && batchLength > 0) {
+        droppedBytes += batchLength - Write(batch, batchLength);
+        batchLength = 0;
+    }
+    suspended = true;
+    xSemaphoreGive(mutex);
+}
+
+uint32_t LogFile::GetStartOffset()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t start = hasPrevious ? previous.start : current.start;
+    xSemaphoreGive(mutex);
+    return start;
+}
+
+uint32_t LogFile::GetEndOffset()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t end = current.start + current.size + batchLength;
+    xSemaphoreGive(mutex);
+    return end;
+}
+
+size_t LogFile::Read(uint32_t offset, uint8_t* buffer, size_t maxLength)
+{
+    size_t count = 0;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t end = current.start + current.size;
+    const Segment* segment = nullptr;
+    if (hasPrevious && offset >= previous.start && offset < previous.start + previous.size) {
+        segment = &previous;
+    } else if (offset >= current.start && offset < end) {
+        segment = &current;
+    } else if (offset >= end && offset < end + batchLength) {
+        // the collected lines follow the current file
+        count = min(maxLength, (size_t)(end + batchLength - offset));
+        memcpy(buffer, batch + (offset - end), count);
+    }
+    if (segment != nullptr && !suspended) {
+        char path[32];
+        GetPath(segment->start, path, sizeof(path));
+        // the file is opened for every read, so that it can be rotated in between
+        File file = fileSystem->GetInternalFileSystem()->open(path, FILE_READ);
+        if (file && file.seek(offset - segment->start)) {
+            count = file.read(buffer, min(maxLength, (size_t)(segment->start + segment->size - offset)));
+        }
+        file.close();
+    }
+    xSemaphoreGive(mutex);
+    return count;
+}
+
+uint32_t LogFile::GetDropped()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint32_t dropped = droppedBytes;
+    xSemaphoreGive(mutex);
+    return dropped;
+}
+
+void LogFile::Flush(bool all)
+{
+    // the written bytes leave the batch under the same lock, so a reader sees them exactly once
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    while (batchLength > 0 && !suspended) {
+        // end every append on a block boundary of the file
+        size_t count = min(batchLength, blockSize - current.size % blockSize);
+        if (count < blockSize - current.size % blockSize && !all) {
+            break;
+        }
+        size_t written = Write(batch, count);
+        memmove(batch, batch + written, batchLength - written);
+        batchLength -= written;
+        writeFailed = written < count;
+        if (writeFailed) {
+            // the file system may be full, the rest is written again after flushIntervalMs
+            batchSinceMs = millis();
+            break;
+        }
+    }
+    xSemaphoreGive(mutex);
+}
+
+size_t LogFile::Write(const char* data, size_t length)
+{
+    if (current.size >= maxFileSize) {
+        Rotate();
+    }
+    char path[32];
+    GetPath(current.start, path, sizeof(path));
+    File file = fileSystem->GetInternalFileSystem()->open(path, FILE_APPEND);
+    size_t written = 0;
+    if (file) {
+        written = file.write((const uint8_t*)data, length);
+        current.size += written;
+        file.close();
+    }
+    return written;
+}
+
+void LogFile::Rotate()
+{
+    char path[32];
+    if (hasPrevious) {
+        GetPath(previous.start, path, sizeof(path));
+        fileSystem->GetInternalFileSystem()->remove(path);
+    }
+    previous = current;
+    hasPrevious = true;
+    current.start = previous.start + previous.size;
+    current.size = 0;
+}
+
+void LogFile::GetPath(uint32_t start, char* path, size_t size)
+{
+    snprintf(path, size, LOG_DIR "/%08lx.log", (unsigned long)start);
+}
@@ -0,0 +1,108 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <FileSystem.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/**
+ * Persists the log lines in a pair of rotating files on LittleFS.
+ *
+ * The lines are collected in RAM and appended in whole flash blocks, so that
+ * LittleFS rarely has to rewrite a partially filled block. A partial block is
+ * only written when the oldest line has waited for flushIntervalMs. Lines that
+ * could not be written stay in RAM and are written again flushIntervalMs
+ * later; once RAM is full too, new lines are dropped and counted. Readers get
+ * the lines not written yet from RAM, so polling the log never forces a write.
+ * Once the current file reaches maxFileSize, the older file is deleted and a
+ * new one is started. Suspend() writes the collected lines and stops all file
+ * access for good, before the file system partition is overwritten.
+ *
+ * Every byte ever logged has an offset, which stays valid across rotations and
+ * restarts: each file is named after the offset of its first byte.
+ *
+ * Append(), Loop() and GetFlushWaitMs() are called by the logger task only,
+ * the other functions may be called by any task.
+ */
+class LogFile
+{
+    public:
+        /** The LittleFS block size, appends end on a block boundary */
+        static const size_t blockSize = 4096;
+        static const uint32_t maxFileSize = 64 * 1024;
+        static const uint32_t flushIntervalMs = 30000;
+
+        LogFile(FileSystem* fileSystem);
+        virtual ~LogFile();
+
+        /** Finds the existing log files, the file system must be mounted. Nothing is written before. */
+        bool Begin();
+
+        // Logger task
+        void Append(const char* text, size_t length);
+        /** Writes the collected lines if they are due. */
+        void Loop();
+        /** Provides the time until the collected lines are due, ULONG_MAX if there are none. */
+        unsigned long GetFlushWaitMs() const;
+
+        // Any task
+        /** Writes the collected lines and ignores all later appends and reads until the restart. */
+        void Suspend();
+        /** Provides the offset of the oldest byte still stored. */
+        uint32_t GetStartOffset();
+        /** Provides the offset following the last byte appended, written to flash or not. */
+        uint32_t GetEndOffset();
+        /** Reads stored or collected bytes from an offset, returns 0 if there are none (anymore). */
+        size_t Read(uint32_t offset, uint8_t* buffer, size_t maxLength);
+        /** Provides the number of bytes dropped because they could neither be written nor kept. */
+        uint32_t GetDropped();
+
+    private:
+        struct Segment
+        {
+            /** The offset of the first byte of the file */
+            uint32_t start;
+            uint32_t size;
+        };
+
+        /** Writes the collected lines up to the last block boundary, or all of them. */
+        void Flush(bool all);
+        /** Appends to the current file, returns the bytes written, the mutex must be held. */
+        size_t Write(const char* data, size_t length);
+        void Rotate();
+        static void GetPath(uint32_t start, char* path, size_t size);
+
+        FileSystem* fileSystem;
+        SemaphoreHandle_t mutex;
+        /** The older file, valid if hasPrevious, and the file appended to */
+        Segment previous;
+        Segment current;
+        bool hasPrevious;
+
+        /** The lines following the current file, changed under the mutex for the readers */
+        char batch[blockSize];
+        size_t batchLength;
+        /** The time the oldest collected line was appended, or the last write failed */
+        unsigned long batchSinceMs;
+        /** A write failed, the batch is written again by Loop() only */
+        bool writeFailed;
+        uint32_t droppedBytes;
+        /** Set under the mutex, the file system is not accessed anymore */
+        bool suspended;
+};
@@ -13,122 +13,517 @@
  * All trademarks used in this document are property of their respective owners.
  * =============================================================================== */
 
- #include "Logger.h"
+#include "util/Logger.h"
+#include "LogFile.h"
 #include <Arduino.h>
-#include "../Settings.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 
-Logger::LogLevel Logger::currentLevel = Logger::LogLevel::DEBUG;
-QueueHandle_t Logger::logQueue = nullptr;
+/*
+ * Set to 1 to send binary frames instead of text, to be decoded on the host by
+ * decode-log.py. Deferred messages are then never formatted on the device.
+ *
+ * Frame: 0xA5, type, payload length, payload, XOR of the payload bytes
+ * - 'M' module:   id, name
+ * - 'T' text:     timestamp ms (4), level, module id, text
+ * - 'D' deferred: timestamp ms (4), level, module id, format string address (4), arguments
+ * - 'X' dropped:  number of dropped messages (4)
+ * All numbers are little-endian.
+ */
+#ifndef LOGGER_BINARY_FRAMES
+#define LOGGER_BINARY_FRAMES 0
+#endif
+
+static_assert(LogArgs::capacity <= Logger::maxMessageLength, "deferred arguments must fit into a log record");
+
+static const char* const moduleNames[] = {
+    "GoalfinderApp",
+    "WebServer",
+    "LedController",
+    "AudioPlayer",
+    "SoftwareUpdater",
+    "ToFSensor",
+    "VibrationSensor",
+    "FileSystem",
+    "Settings",
+    "AudioClipCache",
+    "AudioMetronome",
+    "AudioMixer"
+};
+static_assert(sizeof(moduleNames) / sizeof(moduleNames[0]) == (size_t)LogModule::Count, "every module needs a name");
+
+static const char* const levelNames[] = { "OK", "DEBUG", "INFO", "WARN", "ERROR" };
+
+std::atomic<uint8_t> Logger::moduleLevels[(uint8_t)LogModule::Count];
+std::atomic<bool> Logger::extraLog(false);
+std::atomic<LogFile*> Logger::file(nullptr);
+MpscRing<Logger::LogRecord, Logger::recordCount> Logger::records;
+Logger::Module Logger::modules[Logger::maxModules];
+std::atomic<TaskHandle_t> Logger::drainTask(nullptr);
+std::atomic_flag Logger::draining = ATOMIC_FLAG_INIT;
+uint32_t Logger::reportedDrops = 0;
+uint32_t Logger::announcedModules = 0;
 
 void Logger::begin(unsigned long baudRate)
 {
     Serial.begin(baudRate);
     while (!Serial) { }
+}
+
+const char* Logger::GetLevelName(Logger::LogLevel level)
+{
+    return (size_t)level < sizeof(levelNames) / sizeof(levelNames[0]) ? levelNames[(size_t)level] : "UNKNOWN";
+}
+
+bool Logger::FindLevel(const char *name, Logger::LogLevel &level)
+{
+    for (size_t i = 0; i < sizeof(levelNames) / sizeof(levelNames[0]); i++) {
+        if (strcasecmp(levelNames[i], name) == 0) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::GetModuleName(LogModule module)
+{
+    return module < LogModule::Count ? moduleNames[(uint8_t)module] : "?";
+}
+
+bool Logger::FindModule(const char *name, LogModule &module)
+{
+    for (uint8_t i = 0; i < (uint8_t)LogModule::Count; i++) {
+        if (strcmp(moduleNames[i], name) == 0) {
+            module = (LogModule)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::SetLevel(LogModule module, Logger::LogLevel level)
+{
+    if (module < LogModule::Count) {
+        moduleLevels[(uint8_t)module].store((uint8_t)Severity(level), std::memory_order_relaxed);
+    }
+}
+
+Logger::LogLevel Logger::GetLevel(LogModule module)
+{
+    if (module >= LogModule::Count) {
+        return LogLevel::DEBUG;
+    }
+    switch (moduleLevels[(uint8_t)module].load(std::memory_order_relaxed)) {
+        case LOG_LEVEL_DEBUG: return LogLevel::DEBUG;
+        case LOG_LEVEL_INFO:  return LogLevel::INFO;
+        case LOG_LEVEL_WARN:  return LogLevel::WARN;
+        default:              return LogLevel::ERROR;
+    }
+}
 
-    logQueue = xQueueCreate(50, sizeof(LogEntry*));
-    if (logQueue == nullptr) {
-        Serial.println("[ERROR][Logger] failed to create log queue");
+void Logger::SetExtraLog(bool enabled)
+{
+    extraLog.store(enabled, std::memory_order_relaxed);
+}
+
+uint8_t Logger::internModule(const char *name)
+{
+    for (uint8_t id = 0; id < maxModules; id++) {
+        Module &module = modules[id];
+        uint8_t state = module.state.load(std::memory_order_acquire);
+        if (state == 2 && strcmp(module.name, name) == 0) {
+            return id;
+        }
+        // a module being added by another task is skipped rather than waited for,
+        // at worst the name is added twice
+        uint8_t expected = 0;
+        if (state == 0 && module.state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+            strlcpy(module.name, name, sizeof(module.name));
+            module.state.store(2, std::memory_order_release);
+            return id;
+        }
     }
+    return maxModules;
 }
 
-const char* Logger::levelToString(Logger::LogLevel level)
+Logger::LogRecord* Logger::beginRecord(const char *file, Logger::LogLevel level, uint32_t &ticket)
 {
-    switch (level)
-    {
-        case Logger::LogLevel::OK:     return "OK";
-        case Logger::LogLevel::DEBUG:  return "DEBUG";
-        case Logger::LogLevel::INFO:   return "INFO";
-        case Logger::LogLevel::WARN:   return "WARN";
-        case Logger::LogLevel::ERROR:  return "ERROR";
-        default:                             return "UNKNOWN";
+    LogRecord *record = records.BeginPush(ticket);
+    if (record != nullptr) {
+        record->format = nullptr;
+        record->timestampMs = millis();
+        record->level = level;
+        record->moduleId = internModule(file);
     }
+    return record;
 }
 
-void Logger::printFormatted(const String &message, const String &file, Logger::LogLevel level)
+void Logger::endRecord(Logger::LogRecord *record, int length, uint32_t ticket)
 {
-    enqueue(message, file, level);
+    if (length < 0) {
+        length = 0;
+    }
+    record->length = (uint16_t)min((size_t)length, maxMessageLength - 1);
+    publishRecord(ticket);
+}
+
+void Logger::publishRecord(uint32_t ticket)
+{
+    records.EndPush(ticket);
+    TaskHandle_t task = drainTask.load(std::memory_order_acquire);
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    } else {
+        drainWithoutTask();
+    }
+}
+
+void Logger::drainWithoutTask()
+{
+    static char buffer[256];
+
+    // a record published while another task drains is picked up by the next round
+    while (drainTask.load(std::memory_order_acquire) == nullptr && records.Front() != nullptr
+        && !draining.test_and_set(std::memory_order_acquire)) {
+        drain(buffer, sizeof(buffer));
+        draining.clear(std::memory_order_release);
+    }
+}
+
+void Logger::enqueue(const char *file, Logger::LogLevel level, const char *fmt, va_list args)
+{
+    uint32_t ticket;
+    LogRecord *record = beginRecord(file, level, ticket);
+    if (record != nullptr) {
+        endRecord(record, vsnprintf(record->message, sizeof(record->message), fmt, args), ticket);
+    }
+}
+
+void Logger::enqueueText(const char *file, Logger::LogLevel level, const char *text)
+{
+    uint32_t ticket;
+    LogRecord *record = beginRecord(file, level, ticket);
+    if (record != nullptr) {
+        endRecord(record, (int)strlcpy(record->message, text, sizeof(record->message)), ticket);
+    }
+}
+
+void Logger::logPacked(const char *file, Logger::LogLevel level, const char *fmt, const LogArgs &args)
+{
+    uint32_t ticket;
+    LogRecord *record = beginRecord(file, level, ticket);
+    if (record != nullptr) {
+        record->format = fmt;
+        memcpy(record->message, args.GetData(), args.GetLength());
+        record->length = (uint16_t)args.GetLength();
+        publishRecord(ticket);
+    }
 }
 
 void Logger::log(const String &message)
 {
-    printFormatted(message, "unknown", Logger::LogLevel::INFO);
+    enqueueText("unknown", Logger::LogLevel::INFO, message.c_str());
 }
 
 void Logger::log(const String &message, Logger::LogLevel level)
 {
-    printFormatted(message, "unknown", level);
+    enqueueText("unknown", level, message.c_str());
 }
 
 void Logger::log(const String &message, const String &file, Logger::LogLevel level)
 {
-    printFormatted(message, file, level);
+    enqueueText(file.c_str(), level, message.c_str());
 }
 
 void Logger::logExtra(const String &message, const String &file, Logger::LogLevel level)
 {
-    if (Settings::GetInstance()->GetExtraLog()) {
-        printFormatted(message, file, level);
+    if (IsExtraLog()) {
+        enqueueText(file.c_str(), level, message.c_str());
     }
 }
 
 void Logger::log(const char *file, Logger::LogLevel level, const char *fmt, ...)
 {
-    char buf[256];
     va_list args;
     va_start(args, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, args);
+    enqueue(file, level, fmt, args);
     va_end(args);
-    printFormatted(String(buf), String(file), level);
 }
 
 void Logger::logExtra(const char *file, Logger::LogLevel level, const char *fmt, ...)
 {
-    if (Settings::GetInstance()->GetExtraLog()) {
-        char buf[256];
+    if (IsExtraLog()) {
         va_list args;
         va_start(args, fmt);
-        vsnprintf(buf, sizeof(buf), fmt, args);
+        enqueue(file, level, fmt, args);
         va_end(args);
-        printFormatted(String(buf), String(file), level);
     }
 }
 
-void Logger::Loop()
+void Logger::Loop(TickType_t waitTicks)
 {
-    if (logQueue == nullptr) {
-        return;
+    static char buffer[1024];
+
+    drainTask.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    // a task that logged before may still be printing the ring
+    while (draining.test_and_set(std::memory_order_acquire)) {
+        vTaskDelay(1);
+    }
+    LogFile *logFile = file.load(std::memory_order_acquire);
+    if (drain(buffer, sizeof(buffer)) == 0 && waitTicks > 0) {
+        if (logFile != nullptr) {
+            // wake up in time to write the lines collected for the log file
+            unsigned long flushWaitMs = logFile->GetFlushWaitMs();
+            if (flushWaitMs != ULONG_MAX) {
+                waitTicks = min(waitTicks, (TickType_t)pdMS_TO_TICKS(flushWaitMs));
+            }
+        }
+        if (waitTicks > 0 && ulTaskNotifyTake(pdTRUE, waitTicks) > 0) {
+            drain(buffer, sizeof(buffer));
+        }
+    }
+    draining.clear(std::memory_order_release);
+    if (logFile != nullptr) {
+        logFile->Loop();
     }
+}
+
+void Logger::SetFile(LogFile *logFile)
+{
+    file.store(logFile, std::memory_order_release);
+}
 
-    LogEntry *entryPtr = nullptr;
-    if (xQueueReceive(logQueue, &entryPtr, 0) == pdTRUE && entryPtr != nullptr) {
-        printNow(*entryPtr);
-        delete entryPtr;
+LogFile* Logger::GetFile()
+{
+    return file.load(std::memory_order_acquire);
+}
+
+uint32_t Logger::GetDropped()
+{
+    return records.GetDropped();
+}
+
+size_t Logger::formatDeferred(char *out, size_t size, const char *fmt, const uint8_t *args, size_t argLength)
+{
+    size_t used = 0;
+    size_t consumed = 0;
+    char spec[16];
+    while (*fmt != '\0' && used < size - 1) {
+        if (*fmt != '%' || fmt[1] == '%') {
+            out[used++] = *fmt;
+            fmt += (*fmt == '%') ? 2 : 1;
+            continue;
+        }
+        // split off one conversion, "*" widths are not supported
+        const char *start = fmt++;
+        while (*fmt != '\0' && strchr("-+ #0123456789.", *fmt) != nullptr) {
+            fmt++;
+        }
+        const char *modifier = fmt;
+        while (*fmt != '\0' && strchr("hlzjt", *fmt) != nullptr) {
+            fmt++;
+        }
+        if (*fmt == '\0') {
+            break;
+        }
+        char conversion = *fmt++;
+        size_t specLength = fmt - start;
+        if (specLength >= sizeof(spec) || strchr("diouxXcsfFeEgGaAp", conversion) == nullptr) {
+            continue;
+        }
+        memcpy(spec, start, specLength);
+        spec[specLength] = '\0';
+
+        // read the next tagged argument
+        if (consumed >= argLength) {
+            // the argument was dropped because the record was full
+            out[used++] = '?';
+            continue;
+        }
+        char tag = (char)args[consumed++];
+        const char *text = nullptr;
+        double real = 0;
+        int64_t integer = 0;
+        if (tag == 's') {
+            const void *end = memchr(args + consumed, '\0', argLength - consumed);
+            text = (const char *)(args + consumed);
+            consumed = end != nullptr ? (const uint8_t *)end - args + 1 : argLength;
+        } else if (tag == 'd' && consumed + sizeof(double) <= argLength) {
+            memcpy(&real, args + consumed, sizeof(double));
+            consumed += sizeof(double);
+            integer = (int64_t)real;
+        } else if ((tag == 'q' || tag == 'Q') && consumed + sizeof(int64_t) <= argLength) {
+            memcpy(&integer, args + consumed, sizeof(int64_t));
+            consumed += sizeof(int64_t);
+            real = tag == 'q' ? (double)integer : (double)(uint64_t)integer;
+        } else if ((tag == 'i' || tag == 'u') && consumed + sizeof(uint32_t) <= argLength) {
+            uint32_t word;
+            memcpy(&word, args + consumed, sizeof(word));
+            consumed += sizeof(word);
+            integer = tag == 'i' ? (int64_t)(int32_t)word : (int64_t)word;
+            real = (double)integer;
+        } else {
+            consumed = argLength;
+            out[used++] = '?';
+            continue;
+        }
+
+        int written;
+        if (conversion == 's') {
+            written = snprintf(out + used, size - used, spec, text != nullptr ? text : "?");
+        } else if (text != nullptr) {
+            written = snprintf(out + used, size - used, "?");
+        } else if (strchr("fFeEgGaA", conversion) != nullptr) {
+            written = snprintf(out + used, size - used, spec, real);
+        } else if (conversion == 'p') {
+            written = snprintf(out + used, size - used, spec, (void *)(uintptr_t)integer);
+        } else if (modifier[0] == 'j' || (modifier[0] == 'l' && modifier[1] == 'l')) {
+            written = snprintf(out + used, size - used, spec, (long long)integer);
+        } else if (modifier[0] == 'l') {
+            written = snprintf(out + used, size - used, spec, (long)integer);
+        } else if (modifier[0] == 'z' || modifier[0] == 't') {
+            written = snprintf(out + used, size - used, spec, (size_t)integer);
+        } else {
+            written = snprintf(out + used, size - used, spec, (int)integer);
+        }
+        if (written > 0) {
+            used += min((size_t)written, size - used - 1);
+        }
+    }
+    out[used] = '\0';
+    return used;
+}
+
+size_t Logger::formatLine(char *out, size_t size, const Logger::LogRecord &record)
+{
+    static char text[2 * maxMessageLength];
+    const char *message = record.message;
+    size_t length = record.length;
+    if (record.format != nullptr) {
+        length = formatDeferred(text, sizeof(text), record.format, (const uint8_t *)record.message, record.length);
+        message = text;
+    }
+    const char *module = record.moduleId < maxModules ? modules[record.moduleId].name : "?";
+    int written = snprintf(out, size, "[%lu.%03lu][%s][%s] %.*s\r\n",
+        (unsigned long)(record.timestampMs / 1000), (unsigned long)(record.timestampMs % 1000),
+        GetLevelName(record.level), module, (int)length, message);
+    return (written > 0 && (size_t)written < size) ? written : 0;
+}
+
+size_t Logger::beginFrame(char *out, size_t size, char type, size_t payloadLength)
+{
+    if (payloadLength > 255 || size < payloadLength + 4) {
+        return 0;
+    }
+    out[0] = (char)0xA5;
+    out[1] = type;
+    out[2] = (char)payloadLength;
+    return 3;
+}
+
+size_t Logger::endFrame(char *out, size_t length)
+{
+    uint8_t check = 0;
+    for (size_t i = 3; i < length; i++) {
+        check ^= (uint8_t)out[i];
     }
+    out[length] = (char)check;
+    return length + 1;
 }
 
-void Logger::printNow(const LogEntry &entry)
+size_t Logger::frameRecord(char *out, size_t size, const Logger::LogRecord &record)
 {
-    String out = String("[") + levelToString(entry.level) + "]";
-    if (!entry.file.isEmpty()) {
-        out += String("[") + entry.file + "]";
+    size_t used = 0;
+    if (record.moduleId < maxModules && (announcedModules & (1UL << record.moduleId)) == 0) {
+        const char *name = modules[record.moduleId].name;
+        size_t nameLength = strlen(name);
+        used = beginFrame(out, size, 'M', 1 + nameLength);
+        if (used == 0) {
+            return 0;
+        }
+        out[used++] = (char)record.moduleId;
+        memcpy(out + used, name, nameLength);
+        used = endFrame(out, used + nameLength);
+    }
+
+    bool deferred = record.format != nullptr;
+    size_t headerLength = deferred ? 10 : 6;
+    size_t start = used;
+    size_t pos = beginFrame(out + start, size - start, deferred ? 'D' : 'T', headerLength + record.length);
+    if (pos == 0) {
+        return 0;
+    }
+    pos += start;
+    memcpy(out + pos, &record.timestampMs, 4);
+    out[pos + 4] = (char)record.level;
+    out[pos + 5] = (char)record.moduleId;
+    if (deferred) {
+        uint32_t address = (uint32_t)(uintptr_t)record.format;
+        memcpy(out + pos + 6, &address, 4);
     }
-    out += " " + entry.message;
-    Serial.println(out);
+    pos += headerLength;
+    memcpy(out + pos, record.message, record.length);
+    used = start + endFrame(out + start, pos - start + record.length);
+    if (record.moduleId < maxModules) {
+        announcedModules |= 1UL << record.moduleId;
+    }
+    return used;
 }
 
-void Logger::enqueue(const String &message, const String &file, Logger::LogLevel level)
+size_t Logger::drain(char *buffer, size_t size)
 {
-    if (logQueue == nullptr) {
-        printNow({message, file, level});
-        return;
+    static char line[256];
+
+    LogFile *logFile = file.load(std::memory_order_acquire);
+    size_t count = 0;
+    size_t used = 0;
+    const LogRecord *record;
+    while ((record = records.Front()) != nullptr) {
+        size_t length = LOGGER_BINARY_FRAMES ? frameRecord(buffer + used, size - used, *record)
+                                             : formatLine(buffer + used, size - used, *record);
+        if (length == 0 && used > 0) {
+            // the record does not fit anymore, it is added again after the batch is written
+            Serial.write((const uint8_t *)buffer, used);
+            used = 0;
+            continue;
+        }
+        if (logFile != nullptr) {
+            // the log file is always written as text
+            if (LOGGER_BINARY_FRAMES) {
+                logFile->Append(line, formatLine(line, sizeof(line), *record));
+            } else {
+                logFile->Append(buffer + used, length);
+            }
+        }
+        used += length;
+        records.Pop();
+        count++;
     }
 
-    LogEntry *entryPtr = new LogEntry{message, file, level};
-    if (xQueueSend(logQueue, &entryPtr, 0) != pdTRUE) {
-        // queue full or failed — fallback to immediate print and free
-        printNow(*entryPtr);
-        delete entryPtr;
+    uint32_t dropped = records.GetDropped();
+    if (dropped != reportedDrops) {
+        if (size - used < 64) {
+            Serial.write((const uint8_t *)buffer, used);
+            used = 0;
+        }
+        uint32_t drops = dropped - reportedDrops;
+        int lineLength = snprintf(line, sizeof(line), "[WARN][Logger] %lu messages dropped, log ring full\r\n",
+            (unsigned long)drops);
+        if (LOGGER_BINARY_FRAMES) {
+            size_t pos = used + beginFrame(buffer + used, size - used, 'X', 4);
+            memcpy(buffer + pos, &drops, 4);
+            used = used + endFrame(buffer + used, pos - used + 4);
+        } else {
+            memcpy(buffer + used, line, lineLength);
+            used += lineLength;
+        }
+        if (logFile != nullptr) {
+            logFile->Append(line, lineLength);
+        }
+        reportedDrops = dropped;
     }
-}
\ No newline at end of file
+
+    if (used > 0) {
+        Serial.write((const uint8_t *)buffer, used);
+    }
+    return count;
+}
@@ -0,0 +1,85 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "AssetImage.h"
+#include "AssetTable.h"
+#include "util/Logger.h"
+
+#define ASSET_IMAGE_MAGIC "GFAS"
+#define ASSET_IMAGE_VERSION 1
+
+const char* AssetImage::partitionLabel = "assets";
+const uint8_t* AssetImage::data = nullptr;
+spi_flash_mmap_handle_t AssetImage::handle = 0;
+
+bool AssetImage::Begin()
+{
+    if (data != nullptr || handle != 0) {
+        return data != nullptr;
+    }
+    const esp_partition_t* partition = FindPartition();
+    if (partition == nullptr) {
+        LOG(WebServer, WARN, "No '%s' partition, serving the web app from LittleFS", partitionLabel);
+        return false;
+    }
+    if (AssetTable::imageSize > partition->size) {
+        LOG(WebServer, ERROR, "Asset image of %u bytes exceeds its partition", (unsigned)AssetTable::imageSize);
+        return false;
+    }
+    const void* mapped = nullptr;
+    // only the image is mapped, the MMU maps 64 KB pages
+    if (esp_partition_mmap(partition, 0, AssetTable::imageSize, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK) {
+        LOG(WebServer, ERROR, "Could not map the asset image");
+        return false;
+    }
+    const Header* header = (const Header*)mapped;
+    if (!CheckHeader(header, AssetTable::imageSize) || header->imageId != AssetTable::imageId) {
+        LOG(WebServer, ERROR, "Asset image does not match the firmware (id %08lx, expected %08lx)", 
+            (unsigned long)header->imageId, (unsigned long)AssetTable::imageId);
+        spi_flash_munmap(handle);
+        handle = 0;
+        return false;
+    }
+    data = (const uint8_t*)mapped;
+    LOG(WebServer, OK, "Mapped %u assets, %u bytes", (unsigned)header->count, (unsigned)header->size);
+    return true;
+}
+
+void AssetImage::Invalidate()
+{
+    data = nullptr;
+}
+
+bool AssetImage::IsValid()
+{
+    return data != nullptr;
+}
+
+const uint8_t* AssetImage::GetContent(const Asset* asset)
+{
+    return data != nullptr ? data + asset->offset : nullptr;
+}
+
+bool AssetImage::CheckHeader(const void* header, uint32_t size)
+{
+    const Header* image = (const Header*)header;
+    return memcmp(image->magic, ASSET_IMAGE_MAGIC, 4) == 0 && image->version == ASSET_IMAGE_VERSION && image->size == size;
+}
+
+const esp_partition_t* AssetImage::FindPartition()
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, partitionSubtype, partitionLabel);
+}
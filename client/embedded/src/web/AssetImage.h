@@ -0,0 +1,80 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "esp_partition.h"
+#include "AssetManifest.h"
+
+/**
+ * The web app, packed into the "assets" flash partition by
+ * gen-asset-manifest.py and mapped into the address space of the CPU.
+ *
+ * The files are served straight from the mapped flash, without a file
+ * system: reading them costs no directory walk and no block cache, the flash
+ * cache of the CPU fetches them on demand.
+ *
+ * The image is only used if its id matches the manifest compiled into the
+ * firmware, so that a firmware never serves the offsets of another build.
+ * Without a valid image the web server falls back to the web app on LittleFS,
+ * which is where units updated over the air from a partition table without
+ * the "assets" partition still have it.
+ */
+class AssetImage
+{
+    public:
+        /** The data partition subtype of the asset image, see partitions.csv */
+        static const esp_partition_subtype_t partitionSubtype = (esp_partition_subtype_t)0x40;
+        static const char* partitionLabel;
+
+        /** Maps the image and checks that it matches the manifest. */
+        static bool Begin();
+        /**
+         * Stops serving the image, e.g. before it is overwritten. The mapping
+         * is kept, as responses in flight still read from it.
+         */
+        static void Invalidate();
+        static bool IsValid();
+
+        /** Provides the bytes of an asset, nullptr if there is no valid image. */
+        static const uint8_t* GetContent(const Asset* asset);
+
+        /**
+         * Checks the header of an image of a size, e.g. of one just written
+         * for another firmware, without comparing the id with the manifest.
+         */
+        static bool CheckHeader(const void* header, uint32_t size);
+
+        /** Finds the partition of the image, nullptr if the partition table has none. */
+        static const esp_partition_t* FindPartition();
+
+    private:
+        struct Header
+        {
+            char magic[4];
+            uint8_t version;
+            uint8_t reserved[3];
+            uint32_t imageId;
+            uint32_t count;
+            uint32_t size;
+            uint8_t reserved2[12];
+        };
+        static_assert(sizeof(Header) == 32, "The asset image header has 32 bytes");
+
+        static const uint8_t* data;
+        static spi_flash_mmap_handle_t handle;
+};
@@ -0,0 +1,44 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "AssetManifest.h"
+#include "AssetTable.h"
+
+const Asset* AssetManifest::Find(const char* path)
+{
+    if (AssetTable::count == 0) {
+        return nullptr;
+    }
+    // minimal perfect hash: the first hash selects the seed of the second one
+    uint32_t seed = AssetTable::seeds[Hash(path, 0) % AssetTable::count];
+    const Asset* asset = &AssetTable::assets[Hash(path, seed) % AssetTable::count];
+    return strcmp(asset->path, path) == 0 ? asset : nullptr;
+}
+
+uint32_t AssetManifest::GetCount()
+{
+    return AssetTable::count;
+}
+
+uint32_t AssetManifest::Hash(const char* path, uint32_t seed)
+{
+    uint32_t hash = 0x811C9DC5 ^ seed;
+    for (const uint8_t* c = (const uint8_t*)path; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
@@ -0,0 +1,49 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/** A file of the web app, as listed by gen-asset-manifest.py */
+struct Asset
+{
+    /** The URL path the file is served at */
+    const char* path;
+    const char* contentType;
+    /** The position of the file in the asset image */
+    uint32_t offset;
+    uint32_t size;
+    /** Indicates whether the file is gzip-compressed */
+    bool gzip;
+    /** Strong ETag of the served bytes, including the quotes */
+    const char* etag;
+};
+
+/**
+ * Finds the files of the web app in the manifest generated at build time
+ * (AssetTable.h), instead of searching the image for every request.
+ */
+class AssetManifest
+{
+    public:
+        /** Provides the asset served at a URL path, nullptr if there is none. */
+        static const Asset* Find(const char* path);
+        /** Provides the number of assets in the manifest. */
+        static uint32_t GetCount();
+        /** 32 bit FNV-1a of a path, must match gen-asset-manifest.py */
+        static uint32_t Hash(const char* path, uint32_t seed);
+};
@@ -0,0 +1,61 @@
+// Generated by gen-asset-manifest.py from webapp/, do not edit.
+
+#pragma once
+
+#include "AssetManifest.h"
+
+namespace AssetTable
+{
+    constexpr uint32_t imageId = 0x05655def;
+    constexpr uint32_t imageSize = 448892;
+    constexpr uint32_t count = 40;
+
+    constexpr uint16_t seeds[count] = {
+        7, 2, 0, 0, 0, 0, 1, 1, 14, 0, 1, 2, 4, 0, 3, 0,
+        0, 19, 0, 35, 6, 0, 0, 1, 1, 8, 0, 0, 7, 17, 0, 1,
+        0, 0, 2, 0, 11, 0, 6, 16,
+    };
+
+    constexpr Asset assets[count] = {
+        { "/assets/CY9PuREv.css", "text/css", 352620, 252, true, "\"be90cdac45267150\"" },
+        { "/assets/YLf09C1p.js", "application/javascript", 440948, 847, true, "\"b718df0bab95d8c4\"" },
+        { "/assets/7OnKK7nV.js", "application/javascript", 7684, 1350, true, "\"26610a2f823303ed\"" },
+        { "/assets/Ism58Bt_.js", "application/javascript", 372008, 1456, true, "\"be2402731a70d0c3\"" },
+        { "/assets/EJWUUl1k.js", "application/javascript", 370828, 590, true, "\"7a13ab3f3b486bb4\"" },
+        { "/assets/8A5hucMn.css", "text/css", 9036, 554, true, "\"e9034a0e3ffb4b84\"" },
+        { "/assets/aLcP1RgS.js", "application/javascript", 442568, 935, true, "\"4bf7a00561b3f30c\"" },
+        { "/assets/CRS_zcz7.js", "application/javascript", 34512, 1004, true, "\"4a78816e301e1222\"" },
+        { "/assets/NLfJdlKT.js", "application/javascript", 377200, 63148, true, "\"766687d65fa4ee60\"" },
+        { "/assets/Be9N6vfJ.css", "text/css", 11976, 1062, true, "\"16b258128ec74f43\"" },
+        { "/assets/U7AnN9Wv.js", "application/javascript", 440348, 599, true, "\"51aab8e7996fa6ec\"" },
+        { "/assets/ClDlre4E.css", "text/css", 368416, 190, true, "\"ece31d850d74108b\"" },
+        { "/assets/CsITN_WX.css", "text/css", 369184, 1188, true, "\"5c49fbcdf765fb98\"" },
+        { "/assets/FkoDROEp.js", "application/javascript", 371420, 458, true, "\"9332e864b94169fb\"" },
+        { "/assets/ChTl6pPQ.png", "image/png", 352872, 15542, false, "\"a7a3a16d7683670a\"" },
+        { "/assets/D2eCe96X.css", "text/css", 370372, 189, true, "\"93785640218ff126\"" },
+        { "/assets/BDNg7Dcv.css", "text/css", 11376, 215, true, "\"02d8e16e619dc472\"" },
+        { "/assets/CWtRdzSs.png", "image/png", 35516, 317101, false, "\"ef6cdf6018467024\"" },
+        { "/assets/JQ6TlQ44.js", "application/javascript", 373464, 3278, true, "\"4328f334b8fdece8\"" },
+        { "/index.html", "text/html", 448592, 298, true, "\"1e874d11465e298e\"" },
+        { "/assets/oQ6nrZoR.js", "application/javascript", 446268, 776, true, "\"cc5be6c56fd6b9cf\"" },
+        { "/assets/CrA2gFWR.css", "text/css", 368608, 574, true, "\"aad62d8c41d6110b\"" },
+        { "/assets/CAcfQOxe.png", "image/png", 13312, 20929, false, "\"e8b8d4a140a3504f\"" },
+        { "/assets/BqK9DZqn.css", "text/css", 13040, 146, true, "\"545c7d624f341bb4\"" },
+        { "/assets/1UVnL7pd.svg", "image/svg+xml", 32, 7649, true, "\"fde6916d4ea145aa\"" },
+        { "/assets/BIh_O27r.css", "text/css", 11592, 382, true, "\"9a9de8cf1b7c05b8\"" },
+        { "/assets/ByBo7hmj.css", "text/css", 13188, 121, true, "\"f6569d2eb9c10266\"" },
+        { "/assets/tDt7Cf0a.css", "text/css", 447788, 554, true, "\"35c61aeb8cc02f35\"" },
+        { "/assets/8uA7wzHT.js", "application/javascript", 9592, 1784, true, "\"e323449ec639a425\"" },
+        { "/assets/feNa5pqS.js", "application/javascript", 443504, 914, true, "\"bacf7f1588698e7b\"" },
+        { "/assets/CDZgJxBn.css", "text/css", 34244, 268, true, "\"1f60a677b1e2cc70\"" },
+        { "/assets/DCf1U_N-.css", "text/css", 370564, 262, true, "\"c026f5e4d5e558c2\"" },
+        { "/assets/g1igkb8E.js", "application/javascript", 444420, 1344, true, "\"f0f2eb7e63ec0fcd\"" },
+        { "/assets/k_3NvlKq.js", "application/javascript", 445764, 504, true, "\"1152383a91559f39\"" },
+        { "/assets/a4bl2JCa.js", "application/javascript", 441796, 770, true, "\"21c633bf47b65931\"" },
+        { "/assets/pAlynUDn.js", "application/javascript", 447044, 743, true, "\"93d19f963f6f8843\"" },
+        { "/assets/LhPLRAEV.js", "application/javascript", 376836, 364, true, "\"497e4565a4db3205\"" },
+        { "/assets/Hwr6dvo1.js", "application/javascript", 371880, 126, false, "\"ceac7ae5b99b6bcb\"" },
+        { "/assets/z9wMP1hf.css", "text/css", 448344, 248, true, "\"f1c2dc24031506c3\"" },
+        { "/assets/KT98fjT0.css", "text/css", 376744, 89, true, "\"05d9345bd4bbd17c\"" },
+    };
+}
@@ -0,0 +1,91 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "EventStream.h"
+#include "util/Logger.h"
+
+EventStream::EventStream(const char* url, const ShotJournal* journal) : 
+    source(url), journal(journal), sentSequence(0), pendingSinceMs(0), lastSentMs(0)
+{
+}
+
+void EventStream::Begin(AsyncWebServer& server)
+{
+    sentSequence = journal->GetLastSequence();
+    source.onConnect([this](AsyncEventSourceClient* client) {
+        if (source.count() > maxClients) {
+            LOG(WebServer, WARN, "Rejected event stream client, %u connected", (unsigned)source.count());
+            client->close();
+            return;
+        }
+        // tells the client where the stream starts and how fast to reconnect
+        uint32_t last = journal->GetLastSequence();
+        char data[maxMessageSize];
+        snprintf(data, sizeof(data), "{\"seq\":%lu}", (unsigned long)last);
+        client->send(data, "hello", 0, 2000);
+        // catch up a reconnecting client, unless the device restarted since
+        uint32_t lastId = client->lastId();
+        if (lastId > 0 && lastId < last) {
+            uint32_t sequence = Format(lastId, data, sizeof(data));
+            if (sequence > 0) {
+                client->send(data, "shots", sequence);
+            }
+        }
+    });
+    server.addHandler(&source);
+}
+
+void EventStream::Loop()
+{
+    unsigned long now = millis();
+    if (journal->GetLastSequence() == sentSequence) {
+        if (now - lastSentMs >= keepAliveMs && source.count() > 0) {
+            // keeps idle connections open through the phones' power saving
+            source.send("", "ping", 0);
+            lastSentMs = now;
+        }
+        return;
+    }
+    if (pendingSinceMs == 0) {
+        pendingSinceMs = now != 0 ? now : 1;
+    }
+    if (now - pendingSinceMs >= coalesceMs) {
+        char data[maxMessageSize];
+        uint32_t sequence = Format(sentSequence, data, sizeof(data));
+        if (sequence > 0 && source.count() > 0) {
+            source.send(data, "shots", sequence);
+        }
+        sentSequence = sequence > 0 ? sequence : journal->GetLastSequence();
+        pendingSinceMs = 0;
+        lastSentMs = now;
+    }
+}
+
+uint32_t EventStream::Format(uint32_t since, char* data, size_t size)
+{
+    ShotEvent events[maxEvents];
+    size_t count = journal->Read(since, events, maxEvents);
+    size_t length = 0;
+    data[length++] = '[';
+    for (size_t i = 0; i < count; i++) {
+        length += snprintf(data + length, size - length, "%s{\"seq\":%lu,\"type\":\"%s\",\"ms\":%lu}",
+            i > 0 ? "," : "", (unsigned long)events[i].sequence, ShotJournal::GetTypeName(events[i].type), 
+            (unsigned long)events[i].timestampMs);
+    }
+    data[length++] = ']';
+    data[length] = '\0';
+    return count > 0 ? events[count - 1].sequence : 0;
+}
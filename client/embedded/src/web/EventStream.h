@@ -0,0 +1,69 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "ShotJournal.h"
+
+/**
+ * Pushes the events of the shot journal to the web clients as Server-Sent Events.
+ *
+ * The detection task only appends to the journal, so it never waits for the
+ * network. Loop() runs on the Arduino loop task: it waits coalesceMs after it
+ * sees the first new event and sends all events recorded by then as one
+ * message, so a shot followed by its hit costs every client a single TCP
+ * segment. Each client has its own queue within the AsyncEventSource, a slow
+ * phone does not hold back the others. A client reconnecting with the
+ * Last-Event-ID header gets the events it missed, which may repeat events it
+ * already received: clients ignore sequence numbers they have seen.
+ *
+ * Message: event "shots", id = sequence of the last event,
+ * data = [{"seq":1,"type":"shot","ms":12345}, ...]
+ */
+class EventStream
+{
+    public:
+        static const unsigned long coalesceMs = 50;
+        static const unsigned long keepAliveMs = 15000;
+        /** More clients are rejected and fall back to polling /api/events?since=, every open stream holds a socket of lwIP */
+        static const size_t maxClients = 6;
+        /** Events sent in one message at most */
+        static const size_t maxEvents = 16;
+
+        EventStream(const char* url, const ShotJournal* journal);
+
+        /** Registers the stream on the web server. */
+        void Begin(AsyncWebServer& server);
+        /** Sends the new events once they are due. */
+        void Loop();
+
+    private:
+        /** The brackets and maxEvents events of at most 56 characters, with the terminator */
+        static const size_t maxMessageSize = 3 + maxEvents * 56;
+
+        /** Formats the events following a sequence number, returns the sequence of the last one or 0. */
+        uint32_t Format(uint32_t since, char* data, size_t size);
+
+        AsyncEventSource source;
+        const ShotJournal* journal;
+        /** The last event sent to all clients */
+        uint32_t sentSequence;
+        /** The time Loop() saw the first new event, 0 if none */
+        unsigned long pendingSinceMs;
+        unsigned long lastSentMs;
+};
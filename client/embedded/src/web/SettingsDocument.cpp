@@ -0,0 +1,81 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#include "SettingsDocument.h"
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <GoalfinderApp.h>
+#include "version.h"
+#include "util/Logger.h"
+
+SettingsDocument::SettingsDocument() : 
+    cachedGeneration(0), cachedSoundEnabled(false), bootId(esp_random())
+{
+    mutex = xSemaphoreCreateMutex();
+}
+
+SettingsDocument::~SettingsDocument()
+{
+    vSemaphoreDelete(mutex);
+}
+
+SettingsDocument::Pointer SettingsDocument::Get()
+{
+    uint32_t generation = Settings::GetInstance()->GetGeneration();
+    bool soundEnabled = GoalfinderApp::GetInstance()->IsSoundEnabled();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (!cached || generation != cachedGeneration || soundEnabled != cachedSoundEnabled) {
+        SettingsSnapshot settings = Settings::GetInstance()->GetSnapshot();
+        cached = Build(settings, soundEnabled);
+        // the snapshot may be newer than the generation read above
+        cachedGeneration = settings.generation;
+        cachedSoundEnabled = soundEnabled;
+    }
+    Pointer document = cached;
+    xSemaphoreGive(mutex);
+    return document;
+}
+
+SettingsDocument::Pointer SettingsDocument::Build(const SettingsSnapshot& settings, bool soundEnabled)
+{
+    if (macAddress.isEmpty()) {
+        macAddress = Settings::GetInstance()->GetMacAddress();
+    }
+
+    JsonDocument doc;
+    Settings::ToJson(settings, doc.to<JsonObject>());
+    doc["macAddress"] = macAddress;
+    doc["isSoundEnabled"] = soundEnabled;
+    doc["version"] = FIRMWARE_VERSION;
+
+    std::shared_ptr<Content> content = std::make_shared<Content>();
+    serializeJson(doc, content->json);
+    snprintf(content->etag, sizeof(content->etag), "\"%08lx-%lu-%d\"", (unsigned long)bootId, 
+        (unsigned long)settings.generation, soundEnabled ? 1 : 0);
+    LOG_EXTRA(WebServer, DEBUG, "Serialized settings generation %lu, %u bytes", (unsigned long)settings.generation, 
+        (unsigned)content->json.length());
+    return content;
+}
+
+uint32_t SettingsDocument::GetGeneration(const char* etag) const
+{
+    unsigned long tagBootId;
+    unsigned long generation;
+    if (sscanf(etag, "\"%8lx-%lu-", &tagBootId, &generation) != 2 || tagBootId != bootId) {
+        return 0;
+    }
+    return (uint32_t)generation;
+}
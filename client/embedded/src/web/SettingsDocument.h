@@ -0,0 +1,64 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "Settings.h"
+
+/**
+ * The settings served by GET /api/settings, serialized once per change.
+ *
+ * Building the document costs a JSON serialization of all settings, so the
+ * bytes are cached along with their ETag and only rebuilt when the settings
+ * generation or the sound state differ from the cached ones. A document is
+ * immutable once built: a response in flight keeps its document alive, even
+ * if a newer one has replaced it in the cache meanwhile.
+ */
+class SettingsDocument
+{
+    public:
+        struct Content
+        {
+            String json;
+            /** Strong ETag, quotes included */
+            char etag[32];
+        };
+        typedef std::shared_ptr<const Content> Pointer;
+
+        SettingsDocument();
+        virtual ~SettingsDocument();
+
+        /** Provides the document of the current settings, rebuilt if they changed. */
+        Pointer Get();
+
+        /** Provides the settings generation an ETag of this boot was built from, 0 for any other tag. */
+        uint32_t GetGeneration(const char* etag) const;
+
+    private:
+        Pointer Build(const SettingsSnapshot& settings, bool soundEnabled);
+
+        SemaphoreHandle_t mutex;
+        Pointer cached;
+        uint32_t cachedGeneration;
+        bool cachedSoundEnabled;
+        /** Tells restarts apart, the generation starts over with every boot */
+        uint32_t bootId;
+        String macAddress;
+};
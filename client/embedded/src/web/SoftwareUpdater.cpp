@@ -16,17 +16,39 @@
 
 #include "SoftwareUpdater.h"
 #include <Update.h>
+#include <LittleFS.h>
 #include "Settings.h"
+#include "AssetImage.h"
 #include "util/Logger.h"
+#include "util/LogFile.h"
 
 // static member initialization 
 SoftwareUpdater::UpdatePhase SoftwareUpdater::phase              = PHASE_IDLE;
 uint32_t                     SoftwareUpdater::firmwareSize        = 0;
 uint32_t                     SoftwareUpdater::filesystemSize      = 0;
+uint32_t                     SoftwareUpdater::assetsSize          = 0;
 uint32_t                     SoftwareUpdater::firmwareBytesWritten = 0;
-uint32_t                     SoftwareUpdater::fsBytesWritten      = 0;
-uint8_t                      SoftwareUpdater::headerBuffer[GFPKG_HEADER_SIZE] = {};
+const esp_partition_t*       SoftwareUpdater::filesystemPartition = nullptr;
+const esp_partition_t*       SoftwareUpdater::assetsPartition     = nullptr;
+const esp_partition_t*       SoftwareUpdater::partition           = nullptr;
+uint32_t                     SoftwareUpdater::partitionBytesWritten = 0;
+uint32_t                     SoftwareUpdater::partitionBytesErased  = 0;
+uint32_t                     SoftwareUpdater::partitionCrc        = 0;
+uint8_t                      SoftwareUpdater::headerBuffer[GFPKG_V2_HEADER_SIZE] = {};
 uint8_t                      SoftwareUpdater::headerPos           = 0;
+uint8_t                      SoftwareUpdater::headerSize          = GFPKG_HEADER_SIZE;
+
+// continues a CRC-32 (IEEE 802.3) over the next bytes, start with 0
+static uint32_t UpdateCrc32(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
 
 // constructor
 SoftwareUpdater::SoftwareUpdater(AsyncWebServer* server) {
@@ -38,10 +60,106 @@ void SoftwareUpdater::ResetState() {
     phase              = PHASE_HEADER;
     firmwareSize       = 0;
     filesystemSize     = 0;
+    assetsSize         = 0;
     firmwareBytesWritten = 0;
-    fsBytesWritten     = 0;
+    filesystemPartition = nullptr;
+    assetsPartition    = nullptr;
+    partition          = nullptr;
+    partitionBytesWritten = 0;
+    partitionBytesErased  = 0;
+    partitionCrc       = 0;
     headerPos          = 0;
-    memset(headerBuffer, 0, GFPKG_HEADER_SIZE);
+    headerSize         = GFPKG_HEADER_SIZE;
+    memset(headerBuffer, 0, GFPKG_V2_HEADER_SIZE);
+}
+
+// starts writing the next non-empty part of a package
+//
+// Update writes the firmware and keeps it open, the filesystem and the asset
+// image are written to their partitions directly. The firmware is only
+// activated once all parts are written and verified, so a failed upload
+// leaves the running firmware in place.
+bool SoftwareUpdater::BeginNextPhase() {
+    if (phase == PHASE_HEADER && firmwareSize > 0) {
+        if (!Update.begin(firmwareSize, U_FLASH)) {
+            Update.printError(Serial);
+            return false;
+        }
+        phase = PHASE_FIRMWARE;
+    } else if ((phase == PHASE_HEADER || phase == PHASE_FIRMWARE) && filesystemSize > 0) {
+        LOG(SoftwareUpdater, INFO, "Starting filesystem update: %u bytes", filesystemSize);
+        // nothing may write to the mounted file system while its partition is overwritten,
+        // it stays unmounted until the restart that follows every upload
+        LogFile* logFile = Logger::GetFile();
+        Logger::SetFile(nullptr);
+        if (logFile != nullptr) {
+            logFile->Suspend();
+        }
+        LittleFS.end();
+        BeginPartition(filesystemPartition);
+        phase = PHASE_FILESYSTEM;
+    } else if (phase != PHASE_ASSETS && assetsSize > 0) {
+        LOG(SoftwareUpdater, INFO, "Starting asset image update: %u bytes", assetsSize);
+        // the image is about to change, so it must not be served anymore
+        AssetImage::Invalidate();
+        BeginPartition(assetsPartition);
+        phase = PHASE_ASSETS;
+    } else {
+        if (firmwareSize > 0) {
+            if (!Update.end(true)) {
+                Update.printError(Serial);
+                return false;
+            }
+            LOG(SoftwareUpdater, OK, "Firmware activated");
+        }
+        phase = PHASE_COMPLETE;
+    }
+    return true;
+}
+
+void SoftwareUpdater::Abort() {
+    if (Update.isRunning()) {
+        Update.abort();
+    }
+    phase = PHASE_ERROR;
+}
+
+void SoftwareUpdater::BeginPartition(const esp_partition_t* target) {
+    partition             = target;
+    partitionBytesWritten = 0;
+    partitionBytesErased  = 0;
+    partitionCrc          = 0;
+}
+
+// erases the sectors of the partition just before they are written
+bool SoftwareUpdater::WritePartition(const uint8_t* data, size_t len) {
+    uint32_t end = partitionBytesWritten + len;
+    if (end > partitionBytesErased) {
+        uint32_t eraseEnd = (end + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SPI_FLASH_SEC_SIZE;
+        if (esp_partition_erase_range(partition, partitionBytesErased, eraseEnd - partitionBytesErased) != ESP_OK) {
+            return false;
+        }
+        partitionBytesErased = eraseEnd;
+    }
+    if (esp_partition_write(partition, partitionBytesWritten, data, len) != ESP_OK) {
+        return false;
+    }
+    partitionCrc = UpdateCrc32(partitionCrc, data, len);
+    partitionBytesWritten = end;
+    return true;
+}
+
+bool SoftwareUpdater::VerifyPartition() {
+    uint8_t buffer[256];
+    uint32_t crc = 0;
+    for (uint32_t offset = 0; offset < partitionBytesWritten; offset += sizeof(buffer)) {
+        size_t count = min((size_t)(partitionBytesWritten - offset), sizeof(buffer));
+        if (esp_partition_read(partition, offset, buffer, count) != ESP_OK) {
+            return false;
+        }
+        crc = UpdateCrc32(crc, buffer, count);
+    }
+    return crc == partitionCrc;
 }
 
 // register the OTA endpoint 
@@ -64,7 +182,8 @@ void SoftwareUpdater::Begin(const char* uri) {
 // chunked upload handler (called for every chunk of the upload) 
 //
 // Supports two formats:
-//   1. Combined .gfpkg  – 16-byte header + firmware + filesystem
+//   1. Combined .gfpkg  – 16-byte header + firmware + filesystem, or a
+//                         32-byte header (v2) + ... + asset image
 //   2. Legacy   .bin    – plain firmware binary (auto-detected when magic
 //                         bytes do not match "GFPK")
 //
@@ -73,7 +192,7 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
                                    uint8_t *data, size_t len, bool final) {
     // first chunk: reset state machine 
     if (!index) {
-        Logger::log("Update Started", "SoftwareUpdater", Logger::LogLevel::INFO);
+        LOG(SoftwareUpdater, INFO, "Update Started");
         ResetState();
     }
 
@@ -84,13 +203,16 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
     while (offset < len) {
         switch (phase) {
 
-        // 1. Buffer the 16-byte header 
+        // 1. Buffer the 16-byte header, which is 32 bytes long from version 2 on
         case PHASE_HEADER: {
-            while (offset < len && headerPos < GFPKG_HEADER_SIZE) {
+            while (offset < len && headerPos < headerSize) {
                 headerBuffer[headerPos++] = data[offset++];
+                if (headerPos > 4 && memcmp(headerBuffer, GFPKG_MAGIC, 4) == 0 && headerBuffer[4] >= 2) {
+                    headerSize = GFPKG_V2_HEADER_SIZE;
+                }
             }
 
-            if (headerPos < GFPKG_HEADER_SIZE) {
+            if (headerPos < headerSize) {
                 break; // need more data
             }
 
@@ -100,34 +222,42 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
                 uint8_t version = headerBuffer[4];
                 memcpy(&firmwareSize,    &headerBuffer[5], 4);
                 memcpy(&filesystemSize,  &headerBuffer[9], 4);
+                if (version >= 2) {
+                    memcpy(&assetsSize,  &headerBuffer[13], 4);
+                }
 
-                Logger::log("SoftwareUpdater", Logger::LogLevel::INFO,
-                            "GFPKG v%u: firmware=%u bytes, filesystem=%u bytes",
-                            version, firmwareSize, filesystemSize);
+                LOG(SoftwareUpdater, INFO, "GFPKG v%u: firmware=%u bytes, filesystem=%u bytes, assets=%u bytes",
+                            version, firmwareSize, filesystemSize, assetsSize);
 
-                if (firmwareSize > 0) {
-                    if (!Update.begin(firmwareSize, U_FLASH)) {
-                        Update.printError(Serial);
+                if (firmwareSize == 0 && filesystemSize == 0 && assetsSize == 0) {
+                    LOG(SoftwareUpdater, ERROR, "GFPKG has zero-size payload");
+                    phase = PHASE_ERROR;
+                    return;
+                }
+                // rejected before anything is written, the partition table can only be changed over serial
+                if (filesystemSize > 0) {
+                    filesystemPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+                    if (filesystemPartition == nullptr || filesystemSize > filesystemPartition->size) {
+                        LOG(SoftwareUpdater, ERROR, "No filesystem partition for %u bytes", filesystemSize);
                         phase = PHASE_ERROR;
                         return;
                     }
-                    phase = PHASE_FIRMWARE;
-                } else if (filesystemSize > 0) {
-                    // Filesystem-only package (no firmware)
-                    if (!Update.begin(filesystemSize, U_SPIFFS)) {
-                        Update.printError(Serial);
+                }
+                if (assetsSize > 0) {
+                    assetsPartition = AssetImage::FindPartition();
+                    if (assetsPartition == nullptr || assetsSize > assetsPartition->size) {
+                        LOG(SoftwareUpdater, ERROR, "No asset partition for %u bytes, flash the firmware over serial once", assetsSize);
                         phase = PHASE_ERROR;
                         return;
                     }
-                    phase = PHASE_FILESYSTEM;
-                } else {
-                    Logger::log("GFPKG has zero-size payload", "SoftwareUpdater", Logger::LogLevel::ERROR);
+                }
+                if (!BeginNextPhase()) {
                     phase = PHASE_ERROR;
                     return;
                 }
             } else {
                 // legacy plain .bin firmware
-                Logger::logExtra("Legacy firmware update detected", "SoftwareUpdater", Logger::LogLevel::INFO);
+                LOG_EXTRA(SoftwareUpdater, INFO, "Legacy firmware update detected");
                 int contentLen = request->contentLength();
                 if (!Update.begin(contentLen, U_FLASH)) {
                     Update.printError(Serial);
@@ -153,7 +283,7 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
 
             if (Update.write(data + offset, toWrite) != toWrite) {
                 Update.printError(Serial);
-                phase = PHASE_ERROR;
+                Abort();
                 return;
             }
 
@@ -161,23 +291,12 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
             offset               += toWrite;
 
             if (firmwareBytesWritten >= firmwareSize) {
-                if (!Update.end(true)) {
-                    Update.printError(Serial);
-                    phase = PHASE_ERROR;
-                    return;
-                }
-                Logger::log("Firmware Upload Complete", "SoftwareUpdater", Logger::LogLevel::OK);
+                // ended after the other parts, so that it only boots with them
+                LOG(SoftwareUpdater, OK, "Firmware Upload Complete");
 
-                if (filesystemSize > 0) {
-                    Logger::log("SoftwareUpdater", Logger::LogLevel::INFO, "Starting filesystem update: %u bytes", filesystemSize);
-                    if (!Update.begin(filesystemSize, U_SPIFFS)) {
-                        Update.printError(Serial);
-                        phase = PHASE_ERROR;
-                        return;
-                    }
-                    phase = PHASE_FILESYSTEM;
-                } else {
-                    phase = PHASE_COMPLETE;
+                if (!BeginNextPhase()) {
+                    Abort();
+                    return;
                 }
             }
             break;
@@ -185,20 +304,65 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
 
         // 3. Write filesystem (LittleFS) partition
         case PHASE_FILESYSTEM: {
-            size_t toWrite = len - offset;
+            uint32_t remaining = filesystemSize - partitionBytesWritten;
+            size_t   available = len - offset;
+            size_t   toWrite   = (available < remaining) ? available : remaining;
 
-            if (Update.write(data + offset, toWrite) != toWrite) {
-                Update.printError(Serial);
-                phase = PHASE_ERROR;
+            if (!WritePartition(data + offset, toWrite)) {
+                LOG(SoftwareUpdater, ERROR, "Writing the filesystem failed at %u", partitionBytesWritten);
+                Abort();
                 return;
             }
+            offset += toWrite;
 
-            fsBytesWritten += toWrite;
-            offset          += toWrite;
+            if (partitionBytesWritten >= filesystemSize) {
+                if (!VerifyPartition()) {
+                    LOG(SoftwareUpdater, ERROR, "Filesystem does not read back as uploaded");
+                    Abort();
+                    return;
+                }
+                LOG(SoftwareUpdater, OK, "Filesystem Upload Complete");
+
+                if (!BeginNextPhase()) {
+                    Abort();
+                    return;
+                }
+            }
+            break;
+        }
+
+        // 4. Write the asset image partition, which Update does not know
+        case PHASE_ASSETS: {
+            uint32_t remaining = assetsSize - partitionBytesWritten;
+            size_t   available = len - offset;
+            size_t   toWrite   = (available < remaining) ? available : remaining;
+
+            if (!WritePartition(data + offset, toWrite)) {
+                LOG(SoftwareUpdater, ERROR, "Writing the asset image failed at %u", partitionBytesWritten);
+                Abort();
+                return;
+            }
+            offset += toWrite;
+
+            if (partitionBytesWritten >= assetsSize) {
+                uint8_t header[GFPKG_V2_HEADER_SIZE];
+                if (!VerifyPartition() || esp_partition_read(partition, 0, header, sizeof(header)) != ESP_OK ||
+                    !AssetImage::CheckHeader(header, assetsSize)) {
+                    LOG(SoftwareUpdater, ERROR, "Asset image does not read back as a valid image");
+                    Abort();
+                    return;
+                }
+                LOG(SoftwareUpdater, OK, "Asset Image Upload Complete");
+
+                if (!BeginNextPhase()) {
+                    Abort();
+                    return;
+                }
+            }
             break;
         }
 
-        // 4. Legacy plain firmware .bin
+        // 5. Legacy plain firmware .bin
         case PHASE_LEGACY: {
             size_t toWrite = len - offset;
 
@@ -218,12 +382,15 @@ void SoftwareUpdater::HandleUpdate(AsyncWebServerRequest *request,
 
     // last chunk: finalize whichever update is active
     if (final) {
-        if (phase == PHASE_FIRMWARE || phase == PHASE_FILESYSTEM || phase == PHASE_LEGACY) {
+        if (phase == PHASE_FIRMWARE || phase == PHASE_FILESYSTEM || phase == PHASE_ASSETS) {
+            LOG(SoftwareUpdater, ERROR, "Package truncated");
+            Abort();
+        } else if (phase == PHASE_LEGACY) {
             if (!Update.end(true)) {
                 Update.printError(Serial);
                 phase = PHASE_ERROR;
             } else {
-                Logger::log("Update Complete", "SoftwareUpdater", Logger::LogLevel::OK);
+                LOG(SoftwareUpdater, OK, "Update Complete");
                 phase = PHASE_COMPLETE;
             }
         }
@@ -16,9 +16,11 @@
 
 #pragma once
 #include <ESPAsyncWebServer.h>
+#include "esp_partition.h"
 
-#define GFPKG_HEADER_SIZE 16
-#define GFPKG_MAGIC       "GFPK"
+#define GFPKG_HEADER_SIZE    16
+#define GFPKG_V2_HEADER_SIZE 32
+#define GFPKG_MAGIC          "GFPK"
 
 class SoftwareUpdater 
 {
@@ -33,9 +35,10 @@ class SoftwareUpdater
         /// Phases of a combined (.gfpkg) or legacy (.bin) OTA update.
         enum UpdatePhase {
             PHASE_IDLE,         ///< No update in progress
-            PHASE_HEADER,       ///< Receiving the 16-byte header
+            PHASE_HEADER,       ///< Receiving the 16-byte (v1) or 32-byte (v2) header
             PHASE_FIRMWARE,     ///< Writing firmware (app) partition
             PHASE_FILESYSTEM,   ///< Writing filesystem (LittleFS) partition
+            PHASE_ASSETS,       ///< Writing the asset image partition (v2)
             PHASE_LEGACY,       ///< Plain .bin firmware-only update
             PHASE_COMPLETE,     ///< All phases finished successfully
             PHASE_ERROR         ///< An error occurred
@@ -44,11 +47,29 @@ class SoftwareUpdater
         static UpdatePhase   phase;
         static uint32_t      firmwareSize;
         static uint32_t      filesystemSize;
+        static uint32_t      assetsSize;
         static uint32_t      firmwareBytesWritten;
-        static uint32_t      fsBytesWritten;
-        static uint8_t       headerBuffer[GFPKG_HEADER_SIZE];
+        static const esp_partition_t* filesystemPartition;
+        static const esp_partition_t* assetsPartition;
+        /// The partition of the filesystem or asset image, which Update does not write while it holds the firmware
+        static const esp_partition_t* partition;
+        static uint32_t      partitionBytesWritten;
+        /// End of the erased part of the partition
+        static uint32_t      partitionBytesErased;
+        /// CRC-32 of the bytes written to the partition, checked against the flash once all are written
+        static uint32_t      partitionCrc;
+        static uint8_t       headerBuffer[GFPKG_V2_HEADER_SIZE];
         static uint8_t       headerPos;
+        /// Bytes of the header, known once its version arrived, which may be in a later chunk
+        static uint8_t       headerSize;
 
         static void ResetState();
+        static bool BeginNextPhase();
+        /** Stops the update, the firmware is left inactive. */
+        static void Abort();
+        static void BeginPartition(const esp_partition_t* target);
+        static bool WritePartition(const uint8_t* data, size_t len);
+        /** Reads the written bytes back and compares their CRC with the one of the upload. */
+        static bool VerifyPartition();
         static void HandleUpdate(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
 };
\ No newline at end of file
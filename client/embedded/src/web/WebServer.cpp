@@ -21,8 +21,11 @@
 #include <GoalfinderApp.h>
 
 #include "Settings.h"
-#include "version.h"
 #include "util/Logger.h"
+#include "util/LogFile.h"
+#include "AssetManifest.h"
+#include "AssetImage.h"
+#include "SettingsDocument.h"
 
 #define WEBAPP_DIR "/web"
 #define INDEX_PATH "/index.html"
@@ -32,6 +35,11 @@
 #define MAX_AUTH_ATTEMPTS 5
 #define AUTH_TIMEOUT_MS 60000 // 1 minute
 
+static const size_t maxEventsPerRequest = 32;
+static SettingsDocument settingsDocument;
+/** Larger settings patches are rejected, the settings JSON has less than 512 bytes */
+static const size_t maxSettingsPatchSize = 1024;
+
 FileSystem* internalFS;
 
 // Rate limiting for auth endpoint
@@ -40,6 +48,26 @@ static int authAttemptCount = 0;
 static bool authTimedOut = false;
 static unsigned long authTimeoutStart = 0;
 
+/** Indicates whether the client already has the representation with the ETag (If-None-Match). */
+static bool IsNotModified(AsyncWebServerRequest* request, const char* etag)
+{
+    if (!request->hasHeader("If-None-Match")) {
+        return false;
+    }
+    // a list of tags, weak ones match as well
+    const String& tags = request->header("If-None-Match");
+    return tags == "*" || tags.indexOf(etag) >= 0;
+}
+
+/** Answers a conditional request with a bodyless 304. */
+static void SendNotModified(AsyncWebServerRequest* request, const char* etag, const char* cacheControl)
+{
+    AsyncWebServerResponse* response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
 static String GetContentType(const String* fileName) 
 {
     if(fileName == 0) 
@@ -96,8 +124,7 @@ static String GetContentType(const String* fileName)
     }
     else 
     {
-        Logger::log("Unknown File Type", "WebServer", Logger::LogLevel::WARN);
-        // Serial.printf("[WARN][WebServer.cpp] Unknown file type for: %s\n", fileName->c_str());
+        LOG(WebServer, WARN, "Unknown file type for: %s", fileName->c_str());
         return "application/octet-stream";
     }
 }
@@ -111,14 +138,62 @@ static void HandleNotFound(AsyncWebServerRequest* request)
         return;
     }
     // Serial.println("[WARN][WebServer.cpp] Failed request: " + request->url());
-    Logger::log("Failed Request", "WebServer", Logger::LogLevel::WARN);
+    LOG(WebServer, WARN, "Failed request: %s", request->url().c_str());
 
     request->send(404, "text/plain", "Not found");
 }
 
+/**
+ * Serves the web app from the "/web" directory of LittleFS, where it was
+ * installed before the asset partition existed. The files are looked up by
+ * path, they need not belong to the manifest of this firmware.
+ */
+static void SendFromFileSystem(AsyncWebServerRequest* request)
+{
+    String filePath = WEBAPP_DIR + request->url();
+    String contentType = GetContentType(&filePath);
+
+    // Try the gzip-compressed version first
+    String compressedPath = filePath + COMPRESSED_FILE_EXTENSION;
+    bool isCompressed = internalFS->FileExists(compressedPath);
+    bool fileExists = isCompressed || internalFS->FileExists(filePath);
+
+    // If neither exists, fall back to index.html (SPA routing)
+    if(!fileExists)
+    {
+        filePath = WEBAPP_DIR INDEX_PATH;
+        compressedPath = filePath + COMPRESSED_FILE_EXTENSION;
+        isCompressed = internalFS->FileExists(compressedPath);
+        fileExists = isCompressed || internalFS->FileExists(filePath);
+        contentType = "text/html";
+    }
+
+    if(!fileExists)
+    {
+        LOG(WebServer, WARN, "Web app not installed, requested %s", request->url().c_str());
+        request->send(503, "text/plain", "Web app not installed");
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse(*internalFS->GetInternalFileSystem(), 
+        isCompressed ? compressedPath : filePath, contentType);
+    if(response == nullptr)
+    {
+        LOG(WebServer, ERROR, "Failed to create response");
+        request->send(500, "text/plain", "Internal server error");
+        return;
+    }
+    if(isCompressed) {
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    // Don't cache index.html so the browser always fetches fresh asset references
+    response->addHeader("Cache-Control", filePath.endsWith(INDEX_PATH) ? "no-cache" : "max-age=604800"); // 1 week
+    request->send(response);
+}
+
 static void HandleRequest(AsyncWebServerRequest* request)
 {
-    Logger::log("WebServer", Logger::LogLevel::INFO, "Received request %s", request->url().c_str());
+    LOG(WebServer, INFO, "Received request %s", request->url().c_str());
 
     // Captive portal: redirect requests coming from non-AP hosts (e.g. connectivity checks)
     // so they don't get served SPA content instead of a proper portal response
@@ -128,56 +203,52 @@ static void HandleRequest(AsyncWebServerRequest* request)
         return;
     }
 
-    String filePath = WEBAPP_DIR + request->url();  
-    String contentType = GetContentType(&filePath);
-
-    // Try the gzip-compressed version first
-    String compressedPath = filePath + COMPRESSED_FILE_EXTENSION;
-    bool isCompressed = internalFS->FileExists(compressedPath);
-    bool fileExists = isCompressed;
+    // without a valid asset image, e.g. on a unit updated over the air that kept its partition table
+    if(!AssetImage::IsValid())
+    {
+        SendFromFileSystem(request);
+        return;
+    }
 
-    // If no compressed version, try the uncompressed file directly
-    if(!fileExists)
+    // one lookup in the manifest generated at build time, unknown paths are routes of the SPA
+    const Asset* asset = AssetManifest::Find(request->url().c_str());
+    if(asset == nullptr)
     {
-        fileExists = internalFS->FileExists(filePath);
+        asset = AssetManifest::Find(INDEX_PATH);
     }
 
-    // If neither exists, fall back to index.html (SPA routing)
-    if(!fileExists)
+    // Don't cache index.html so the browser always fetches fresh asset references, it only transfers headers while unchanged
+    const char* cacheControl = asset != nullptr && strcmp(asset->path, INDEX_PATH) == 0 ? "no-cache" : "max-age=604800"; // 1 week
+    if(asset != nullptr && IsNotModified(request, asset->etag))
     {
-        compressedPath = WEBAPP_DIR INDEX_PATH COMPRESSED_FILE_EXTENSION;
-        isCompressed = internalFS->FileExists(compressedPath);
-        fileExists = isCompressed;
-        contentType = "text/html";
+        SendNotModified(request, asset->etag, cacheControl);
+        return;
     }
 
-    if(!fileExists)
+    const uint8_t* content = asset != nullptr ? AssetImage::GetContent(asset) : nullptr;
+    if(content == nullptr)
     {
-        Logger::log("WebServer", Logger::LogLevel::WARN, "File not found: %s", filePath.c_str());
-        request->send(404, "text/plain", "File not found");
+        LOG(WebServer, WARN, "Web app not installed, requested %s", request->url().c_str());
+        request->send(503, "text/plain", "Web app not installed");
         return;
     }
 
-    String servePath = isCompressed ? compressedPath : filePath;
-    AsyncWebServerResponse* response = request->beginResponse(LittleFS, servePath, contentType);
+    // sent straight from the mapped flash, lwIP copies it into its segments
+    AsyncWebServerResponse* response = request->beginResponse(200, asset->contentType, content, asset->size);
 
     if(response == nullptr)
     {
-        Logger::log("WebServer", Logger::LogLevel::ERROR, "Failed to create response");
+        LOG(WebServer, ERROR, "Failed to create response");
         request->send(500, "text/plain", "Internal server error");
         return;
     }
    
-    if(isCompressed) {
+    if(asset->gzip) {
         response->addHeader("Content-Encoding", "gzip");
     }
 
-    // Don't cache index.html so the browser always fetches fresh asset references
-    if(filePath.endsWith("index.html" COMPRESSED_FILE_EXTENSION)) {
-        response->addHeader("Cache-Control", "no-cache");
-    } else {
-        response->addHeader("Cache-Control", "max-age=604800"); // 1 week
-    }
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", cacheControl);
 
 
 
@@ -203,35 +274,32 @@ static void HandleRequest(AsyncWebServerRequest* request)
     //request->beginResponseStream(contentType);
 }
 
-static void HandleLoadSettings(AsyncWebServerRequest* request) 
+static void SendSettings(AsyncWebServerRequest* request, SettingsDocument::Pointer document)
 {
-    AsyncJsonResponse* response = new AsyncJsonResponse();
+    // the response holds on to the document, a newer one may replace it in the cache meanwhile
+    AsyncWebServerResponse* response = request->beginResponse("application/json", document->json.length(), 
+        [document](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            size_t count = min(maxLen, (size_t)(document->json.length() - index));
+            memcpy(buffer, document->json.c_str() + index, count);
+            return count;
+        });
     response->addHeader("Server", "Settings");
-    JsonVariant& root = response->getRoot();
-
-    Settings* settings = Settings::GetInstance();    
-    
-    root["deviceName"] = settings->GetDeviceName();
-    root["wifiPassword"] = settings->GetWifiPassword();
-    root["devicePassword"] = settings->GetDevicePassword();
-    root["vibrationSensorSensitivity"] = settings->GetVibrationSensorSensitivity();
-    root["ballHitDetectionDistance"] = settings->GetBallHitDetectionDistance();
-    root["distanceOnlyHitDetection"] = settings->GetDistanceOnlyHitDetection();
-    root["volume"] = settings->GetVolume();
-    root["metronomeSound"] = settings->GetMetronomeSound();
-    root["hitSound"] = settings->GetHitSound();
-    root["missSound"] = settings->GetMissSound();
-    root["ledMode"] = (int)settings->GetLedMode();
-    root["ledBrightness"] = settings->GetLedBrightness();
-    root["macAddress"] = settings->GetMacAddress();
-    root["isSoundEnabled"] = GoalfinderApp::GetInstance()->IsSoundEnabled();
-    root["version"] = FIRMWARE_VERSION;
-    root["afterHitTimeout"] = settings->GetAfterHitTimeout();
-
-    response->setLength();
+    response->addHeader("ETag", document->etag);
+    response->addHeader("Cache-Control", "no-cache");
     request->send(response);
 }
 
+static void HandleLoadSettings(AsyncWebServerRequest* request) 
+{
+    // the generation changes with every write, the sound state is served along with the settings
+    SettingsDocument::Pointer document = settingsDocument.Get();
+    if (IsNotModified(request, document->etag)) {
+        SendNotModified(request, document->etag, "no-cache");
+        return;
+    }
+    SendSettings(request, document);
+}
+
 static void HandleSaveSettings(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) 
 {
     JsonDocument doc;
@@ -241,49 +309,194 @@ static void HandleSaveSettings(AsyncWebServerRequest* request, uint8_t* data, si
     memcpy(jsonStr, data, len);
     jsonStr[len] = '\0';
 
-    Logger::log("WebServer", Logger::LogLevel::INFO, "Received settings: %s", jsonStr);
+    LOG(WebServer, INFO, "Received settings: %s", jsonStr);
     deserializeJson(doc, jsonStr, len);
     delete[] jsonStr;
 
     GoalfinderApp* app = GoalfinderApp::GetInstance();
     //app->SetIsSoundEnabled(doc["isSoundEnabled"]);
 
+    // validate all settings before applying any of them
+    String rejected = Settings::Validate(doc.as<JsonObjectConst>());
+    if (!rejected.isEmpty()) {
+        request->send(422, "text/plain", "Invalid settings: " + rejected);
+        return;
+    }
+
+    // settings missing in the document are left unchanged
+    Settings::GetInstance()->Patch(doc.as<JsonObjectConst>());
+
+    request->send(204);
+}
+
+static void ReceiveSettingsPatch(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)
+{
+    // collected until HandlePatchSettings() runs, freed along with the request
+    if (index == 0 && total <= maxSettingsPatchSize) {
+        request->_tempObject = calloc(1, total + 1);
+    }
+    if (request->_tempObject != nullptr && index + len <= total) {
+        memcpy((char*)request->_tempObject + index, data, len);
+    }
+}
+
+static void HandlePatchSettings(AsyncWebServerRequest* request)
+{
+    JsonDocument doc;
+    const char* body = (const char*)request->_tempObject;
+    if (body == nullptr || deserializeJson(doc, body) != DeserializationError::Ok || !doc.is<JsonObject>()) {
+        request->send(400, "text/plain", "Invalid settings");
+        return;
+    }
+    // validate all settings before applying any of them, a rejected patch changes nothing
+    String rejected = Settings::Validate(doc.as<JsonObjectConst>());
+    if (!rejected.isEmpty()) {
+        request->send(422, "text/plain", "Invalid settings: " + rejected);
+        return;
+    }
+
+    // If-Match rejects the patch if another client changed the settings since this one loaded them
+    uint32_t expectedGeneration = 0;
+    if (request->hasHeader("If-Match") && request->header("If-Match") != "*") {
+        expectedGeneration = settingsDocument.GetGeneration(request->header("If-Match").c_str());
+        if (expectedGeneration == 0) {
+            // a tag of a previous boot never matches
+            expectedGeneration = UINT32_MAX;
+        }
+    }
     Settings* settings = Settings::GetInstance();
-    settings->SetDeviceName(doc["deviceName"]);
-    if (!doc["wifiPassword"].isNull()) {
-        settings->SetWifiPassword(doc["wifiPassword"]);
-    }
-    settings->SetDevicePassword(doc["devicePassword"]);
-    settings->SetVibrationSensorSensitivity(doc["vibrationSensorSensitivity"]);
-    settings->SetBallHitDetectionDistance(doc["ballHitDetectionDistance"]);
-    settings->SetDistanceOnlyHitDetection(doc["distanceOnlyHitDetection"]);
-    settings->SetVolume(doc["volume"]);
-    settings->SetMetronomeSound(doc["metronomeSound"]);
-    settings->SetHitSound(doc["hitSound"]);
-    settings->SetMissSound(doc["missSound"]);
-    settings->SetLedMode(doc["ledMode"]);
-    settings->SetAfterHitTimeout(doc["afterHitTimeout"]);
-    if (!doc["ledBrightness"].isNull()) {
-        settings->SetLedBrightness(doc["ledBrightness"]);
+    if (!settings->BeginChanges(expectedGeneration)) {
+        AsyncWebServerResponse* response = request->beginResponse(412, "text/plain", "Settings changed");
+        response->addHeader("ETag", settingsDocument.Get()->etag);
+        request->send(response);
+        return;
+    }
+
+    // only the supplied settings are set, the setters skip unchanged values
+    settings->Patch(doc.as<JsonObjectConst>());
+    settings->CommitChanges();
+
+    // the new ETag lets the client send its next patch without loading the settings again
+    SendSettings(request, settingsDocument.Get());
+}
+
+static void HandleLoadLogLevels(AsyncWebServerRequest* request)
+{
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    response->addHeader("Server", "GoalFinder");
+    JsonVariant& root = response->getRoot();
+
+    for (uint8_t i = 0; i < (uint8_t)LogModule::Count; i++) {
+        LogModule module = (LogModule)i;
+        root[Logger::GetModuleName(module)] = Logger::GetLevelName(Logger::GetLevel(module));
+    }
+
+    response->setLength();
+    request->send(response);
+}
+
+static void HandleSaveLogLevels(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) 
+{
+    JsonDocument doc;
+    if (deserializeJson(doc, data, len) || !doc.is<JsonObject>()) {
+        request->send(400, "text/plain", "Invalid JSON");
+        return;
+    }
+
+    // validate all entries before applying any of them
+    for (JsonPair entry : doc.as<JsonObject>()) {
+        LogModule module;
+        Logger::LogLevel level;
+        if (!Logger::FindModule(entry.key().c_str(), module) || !entry.value().is<const char*>()
+            || !Logger::FindLevel(entry.value().as<const char*>(), level)) {
+            request->send(400, "text/plain", "Unknown module or level");
+            return;
+        }
+    }
+    for (JsonPair entry : doc.as<JsonObject>()) {
+        LogModule module;
+        Logger::LogLevel level;
+        Logger::FindModule(entry.key().c_str(), module);
+        Logger::FindLevel(entry.value().as<const char*>(), level);
+        Logger::SetLevel(module, level);
+        LOG(WebServer, INFO, "Log level of %s set to %s", entry.key().c_str(), Logger::GetLevelName(level));
     }
 
     request->send(204);
 }
 
-static void HandleHits(AsyncWebServerRequest* request) {
-    int hits = GoalfinderApp::GetInstance()->GetDetectedHits();
+static void HandleLogs(AsyncWebServerRequest* request)
+{
+    LogFile* logFile = Logger::GetFile();
+    if (logFile == nullptr) {
+        request->send(404, "text/plain", "No log file");
+        return;
+    }
 
-    GoalfinderApp::GetInstance()->ResetDetectedHits();
+    // includes the lines not written to flash yet, they are read from RAM
+    uint32_t start = logFile->GetStartOffset();
+    uint32_t end = logFile->GetEndOffset();
+    uint32_t since = start;
+    if (request->hasParam("since")) {
+        since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+        // a client behind the oldest line or ahead of the log starts over
+        if (since < start || since > end) {
+            since = start;
+        }
+    }
 
-    request->send(200, "text/plain", String(hits));
+    // streamed in chunks straight from the file, the log end is fixed when the request arrives
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/plain",
+        [logFile, since, end](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            uint32_t offset = since + index;
+            if (offset >= end) {
+                return 0;
+            }
+            return logFile->Read(offset, buffer, min(maxLen, (size_t)(end - offset)));
+        });
+    response->addHeader("X-Log-Start", String(since));
+    response->addHeader("X-Log-Offset", String(end));
+    // lines that could not be stored have no offset, a growing count shows the gap
+    response->addHeader("X-Log-Dropped", String(logFile->GetDropped()));
+    request->send(response);
 }
 
-static void HandleMisses(AsyncWebServerRequest* request) {
-    int misses = GoalfinderApp::GetInstance()->GetDetectedMisses();
+static void HandleEvents(AsyncWebServerRequest* request) {
+    const ShotJournal& journal = GoalfinderApp::GetInstance()->GetShotJournal();
+    uint32_t since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+    size_t limit = maxEventsPerRequest;
+    if (request->hasParam("limit")) {
+        limit = constrain(request->getParam("limit")->value().toInt(), 1L, (long)maxEventsPerRequest);
+    }
+
+    ShotEvent events[maxEventsPerRequest];
+    size_t count = journal.Read(since, events, limit);
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    response->addHeader("Server", "GoalFinder");
+    JsonVariant& root = response->getRoot();
+    // a client is behind if first > since + 1, the events in between are lost
+    root["first"] = journal.GetFirstSequence();
+    root["last"] = journal.GetLastSequence();
+    JsonArray array = root["events"].to<JsonArray>();
+    for (size_t i = 0; i < count; i++) {
+        JsonObject event = array.add<JsonObject>();
+        event["seq"] = events[i].sequence;
+        event["type"] = ShotJournal::GetTypeName(events[i].type);
+        event["ms"] = events[i].timestampMs;
+    }
+
+    response->setLength();
+    request->send(response);
+}
 
-    GoalfinderApp::GetInstance()->ResetDetectedMisses();
+// Totals since the start of the device, which are no longer reset by reading them
+static void HandleHits(AsyncWebServerRequest* request) {
+    request->send(200, "text/plain", String(GoalfinderApp::GetInstance()->GetDetectedHits()));
+}
 
-    request->send(200, "text/plain", String(misses));
+static void HandleMisses(AsyncWebServerRequest* request) {
+    request->send(200, "text/plain", String(GoalfinderApp::GetInstance()->GetDetectedMisses()));
 }
 
 static void HandleRestart(AsyncWebServerRequest* request) 
@@ -425,7 +638,8 @@ static void HandleIsAuth(AsyncWebServerRequest* request) {
     request->send(response);
 }
 
-WebServer::WebServer(FileSystem* fileSystem) : server(80), updater(&server)
+WebServer::WebServer(FileSystem* fileSystem, const ShotJournal* shotJournal) : 
+    server(80), updater(&server), events(API_URL"/events", shotJournal)
 {
     internalFS = fileSystem;
     Init();
@@ -438,7 +652,7 @@ void WebServer::Init()
     server.onNotFound(HandleNotFound); 
     
     // TODO Replace any serial.out with "Log"
-    Logger::log("WebServer", Logger::LogLevel::OK, "Web server initialized");
+    LOG(WebServer, OK, "Web server initialized");
 }
 
 void WebServer::Begin() 
@@ -446,6 +660,7 @@ void WebServer::Begin()
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
 
     updater.Begin(API_URL"/update");
+    AssetImage::Begin();
 
     // Captive portal detection endpoints
     // Android (incl. Samsung) expects a 302 redirect on probe URLs to trigger the sign-in sheet.
@@ -496,10 +711,19 @@ void WebServer::Begin()
     server.on(API_URL"/isauth", HTTP_GET, HandleIsAuth);
     server.on(API_URL"/settings", HTTP_GET, HandleLoadSettings);
     server.on(API_URL"/settings", HTTP_POST, [](AsyncWebServerRequest* request) {}, 0, HandleSaveSettings);
+    server.on(API_URL"/settings", HTTP_PATCH, HandlePatchSettings, 0, ReceiveSettingsPatch);
     server.on(API_URL"/restart", HTTP_POST, HandleRestart);    
     server.on(API_URL"/factory-reset", HTTP_POST, HandleFactoryReset);
+    server.on(API_URL"/log-levels", HTTP_GET, HandleLoadLogLevels);
+    server.on(API_URL"/log-levels", HTTP_POST, [](AsyncWebServerRequest* request) {}, 0, HandleSaveLogLevels);
+    server.on(API_URL"/logs", HTTP_GET, HandleLogs);
     server.on(API_URL"/hits", HTTP_GET, HandleHits);
     server.on(API_URL"/misses", HTTP_GET, HandleMisses);
+    // polled with a cursor, without it the request opens the event stream
+    server.on(API_URL"/events", HTTP_GET, HandleEvents).setFilter([](AsyncWebServerRequest* request) {
+        return request->hasParam("since");
+    });
+    events.Begin(server);
     server.on("/*", HTTP_GET, HandleRequest);
 
     server.onNotFound([](AsyncWebServerRequest *request) {
@@ -507,8 +731,8 @@ void WebServer::Begin()
             // Handle CORS preflight
             AsyncWebServerResponse* response = request->beginResponse(200);
             response->addHeader("Access-Control-Allow-Origin", "*");
-            response->addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-            response->addHeader("Access-Control-Allow-Headers", "Content-Type");
+            response->addHeader("Access-Control-Allow-Methods", "GET, POST, PATCH, OPTIONS");
+            response->addHeader("Access-Control-Allow-Headers", "Content-Type, If-Match");
             request->send(response);
         } else if (request->host() != WiFi.softAPIP().toString()) {
             // Captive portal: any request to a non-AP host gets redirected
@@ -520,7 +744,7 @@ void WebServer::Begin()
 
     //server.serveStatic("/", LittleFS, "/web/").setDefaultFile("index.html").setCacheControl("max-age=604800");
     server.begin();
-    Logger::log("WebServer", Logger::LogLevel::OK, "Started web server");
+    LOG(WebServer, OK, "Started web server");
 }
 
 void WebServer::Stop() 
@@ -528,6 +752,11 @@ void WebServer::Stop()
     server.end();
 }
 
+void WebServer::Loop()
+{
+    events.Loop();
+}
+
 WebServer::~WebServer()
 {
 }
\ No newline at end of file
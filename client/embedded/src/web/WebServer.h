@@ -18,6 +18,7 @@
 #include <ESPAsyncWebServer.h>
 #include <FileSystem.h>
 #include "SoftwareUpdater.h"
+#include "EventStream.h"
 #include "Settings.h"
 
 class WebServer 
@@ -26,10 +27,13 @@ class WebServer
         virtual ~WebServer();
         void Begin();
         void Stop();
-        WebServer(FileSystem* fileSystem);
+        /** Sends the pending events to the clients of the event stream. */
+        void Loop();
+        WebServer(FileSystem* fileSystem, const ShotJournal* shotJournal);
     private:
         AsyncWebServer server;
         SoftwareUpdater updater;
+        EventStream events;
         void Init();
         bool isDone;
 };
\ No newline at end of file
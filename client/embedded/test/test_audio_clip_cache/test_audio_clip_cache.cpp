@@ -0,0 +1,127 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+
+/*
+ * A voice plays the cached head of a clip while another clip is preloaded.
+ * The cache must keep the head the voice reads from, even though its budget
+ * only has room for one head. Run on the host: pio test -e native
+ */
+#include <unity.h>
+#include <LittleFS.h>
+#include <FileSystem.h>
+#include <AudioClipCache.h>
+#include <AudioGeneratorGfa.h>
+#include <AudioVoice.h>
+
+static const char* playingClip = "/test-playing.gfa";
+static const char* preloadedClip = "/test-preloaded.gfa";
+static const uint32_t sampleRate = 22050;
+static const uint32_t clipFrames = sampleRate;
+static const uint16_t headMs = 100;
+/** Room for the head of one mono clip */
+static const size_t budgetBytes = (size_t)headMs * sampleRate / 1000 * sizeof(int16_t);
+
+static FileSystem fileSystem(false);
+
+/** Writes a mono PCM clip whose samples count up from the first one. */
+static void WriteClip(const char* path, int16_t first)
+{
+    uint8_t header[16] = { 'G', 'F', 'A', 'U', 1, AudioGeneratorGfa::codecPcm, 1, 0 };
+    memcpy(&header[8], &sampleRate, sizeof(sampleRate));
+    memcpy(&header[12], &clipFrames, sizeof(clipFrames));
+    File file = LittleFS.open(path, FILE_WRITE);
+    file.write(header, sizeof(header));
+    for (uint32_t i = 0; i < clipFrames; i++) {
+        int16_t sample = (int16_t)(first + i);
+        file.write((const uint8_t*)&sample, sizeof(sample));
+    }
+    file.close();
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_preload_keeps_the_head_a_voice_plays()
+{
+    AudioClipCache cache(&fileSystem, budgetBytes, headMs);
+    TEST_ASSERT_TRUE(cache.Load(playingClip));
+    AudioClipHead* head = cache.Find(playingClip);
+    TEST_ASSERT_NOT_NULL(head);
+
+    // the buffer of the voice is shorter than the head, so the voice stays on it
+    AudioVoice voice(&fileSystem, sampleRate);
+    voice.Play(playingClip, head, 100, nullptr);
+    TEST_ASSERT_EQUAL(1, head->pins);
+
+    // there is no room for a second head without evicting the pinned one
+    TEST_ASSERT_FALSE(cache.Load(preloadedClip));
+    TEST_ASSERT_EQUAL_PTR(head, cache.Find(playingClip));
+    TEST_ASSERT_NOT_NULL(head->samples);
+
+    // the clip plays on from the head into the file without a gap
+    uint32_t frames = 0;
+    int16_t frame[2];
+    for (int i = 0; i < 1000 && frames < clipFrames / 2; i++) {
+        voice.Decode();
+        while (frames < clipFrames / 2 && voice.Peek(frame)) {
+            TEST_ASSERT_EQUAL_INT16(frames, frame[0]);
+            voice.Pop();
+            frames++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(clipFrames / 2, frames);
+
+    // once the voice has left the head, it is evicted for the next clip
+    TEST_ASSERT_EQUAL(0, head->pins);
+    TEST_ASSERT_TRUE(cache.Load(preloadedClip));
+    TEST_ASSERT_NULL(cache.Find(playingClip));
+}
+
+void test_stop_unpins_the_head()
+{
+    AudioClipCache cache(&fileSystem, budgetBytes, headMs);
+    TEST_ASSERT_TRUE(cache.Load(playingClip));
+    AudioClipHead* head = cache.Find(playingClip);
+    TEST_ASSERT_NOT_NULL(head);
+
+    AudioVoice voice(&fileSystem, sampleRate);
+    voice.Play(playingClip, head, 100, nullptr);
+    voice.Stop();
+    TEST_ASSERT_EQUAL(0, head->pins);
+    TEST_ASSERT_TRUE(cache.Load(preloadedClip));
+}
+
+int main(int argc, char** argv)
+{
+    fileSystem.Begin();
+    WriteClip(playingClip, 0);
+    WriteClip(preloadedClip, -20000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_preload_keeps_the_head_a_voice_plays);
+    RUN_TEST(test_stop_unpins_the_head);
+    int failures = UNITY_END();
+
+    LittleFS.remove(playingClip);
+    LittleFS.remove(preloadedClip);
+    return failures;
+}
@@ -0,0 +1,188 @@
+#!/usr/bin/python3
+
+# Transcodes the MP3 clips in data/ into .gfa clips, which are cheap to decode
+# on the device (see lib/lib_audioplayer/include/AudioGeneratorGfa.h).
+#
+# Clip format (16-byte header + payload):
+#   Bytes  0-3:   GFAU Magic
+#   Byte   4:     Format version (1)
+#   Byte   5:     Codec (0 = PCM 16 bit, 1 = IMA-ADPCM)
+#   Byte   6:     Channels (1)
+#   Byte   7:     Reserved (0x00)
+#   Bytes  8-11:  Sample rate  (uint32_t, little-endian)
+#   Bytes  12-15: Sample count (uint32_t, little-endian)
+#   --- payload ---
+#   PCM:       [int16_t samples, little-endian]
+#   IMA-ADPCM: [256-byte blocks: int16_t predictor, uint8_t step index, 0x00,
+#               252 bytes with 504 samples, low nibble first]
+#
+# MP3 decoding requires ffmpeg on the PATH. Without it, no clips are transcoded
+# and the device keeps decoding the MP3 clips.
+#
+# Usage:
+#   PlatformIO:  runs automatically before the filesystem image is built
+#   Standalone:  python transcode-audio.py [--codec adpcm|pcm] [--rate 22050] [<data dir>]
+
+import argparse
+import glob
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+HEADER_SIZE = 16
+MAGIC = b"GFAU"
+FORMAT_VERSION = 1
+CODEC_PCM = 0
+CODEC_IMA_ADPCM = 1
+ADPCM_BLOCK_SIZE = 256
+ADPCM_BLOCK_HEADER_SIZE = 4
+ADPCM_SAMPLES_PER_BLOCK = (ADPCM_BLOCK_SIZE - ADPCM_BLOCK_HEADER_SIZE) * 2
+
+# I2S output rate of the clips, must match AudioPlayer::outputRate
+DEFAULT_RATE = 22050
+
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+
+
+def decode_mp3(path, rate):
+    """Decode an MP3 file into mono 16 bit samples at the given rate using ffmpeg."""
+
+    result = subprocess.run(
+        ["ffmpeg", "-v", "error", "-i", path, "-f", "s16le", "-ac", "1", "-ar", str(rate), "-"],
+        stdout=subprocess.PIPE,
+        check=True,
+    )
+    data = result.stdout
+    return list(struct.unpack("<%dh" % (len(data) // 2), data[: len(data) // 2 * 2]))
+
+
+def adpcm_step(predictor, index, nibble):
+    """Apply one IMA-ADPCM nibble, exactly as the decoder on the device does."""
+
+    step = STEP_TABLE[index]
+    diff = step >> 3
+    if nibble & 4:
+        diff += step
+    if nibble & 2:
+        diff += step >> 1
+    if nibble & 1:
+        diff += step >> 2
+    predictor = predictor - diff if nibble & 8 else predictor + diff
+    predictor = max(-32768, min(32767, predictor))
+    index = max(0, min(88, index + INDEX_TABLE[nibble & 7]))
+    return predictor, index
+
+
+def encode_adpcm(samples):
+    """Encode mono 16 bit samples into IMA-ADPCM blocks."""
+
+    predictor = 0
+    index = 0
+    out = bytearray()
+    for start in range(0, len(samples), ADPCM_SAMPLES_PER_BLOCK):
+        block = samples[start : start + ADPCM_SAMPLES_PER_BLOCK]
+        out += struct.pack("<hBB", predictor, index, 0)
+        nibbles = []
+        for sample in block:
+            step = STEP_TABLE[index]
+            diff = sample - predictor
+            nibble = 0
+            if diff < 0:
+                nibble = 8
+                diff = -diff
+            if diff >= step:
+                nibble |= 4
+                diff -= step
+            if diff >= step >> 1:
+                nibble |= 2
+                diff -= step >> 1
+            if diff >= step >> 2:
+                nibble |= 1
+            predictor, index = adpcm_step(predictor, index, nibble)
+            nibbles.append(nibble)
+        if len(nibbles) % 2:
+            nibbles.append(0)
+        for i in range(0, len(nibbles), 2):
+            out.append(nibbles[i] | (nibbles[i + 1] << 4))
+    return bytes(out)
+
+
+def encode_pcm(samples):
+    return struct.pack("<%dh" % len(samples), *samples)
+
+
+def transcode(mp3_path, gfa_path, codec, rate):
+    """Create a .gfa clip from an MP3 clip."""
+
+    samples = decode_mp3(mp3_path, rate)
+    payload = encode_adpcm(samples) if codec == CODEC_IMA_ADPCM else encode_pcm(samples)
+
+    header = MAGIC                                          # 4 bytes
+    header += struct.pack("<BBBB", FORMAT_VERSION, codec, 1, 0)  # 4 bytes
+    header += struct.pack("<I", rate)                       # 4 bytes
+    header += struct.pack("<I", len(samples))               # 4 bytes
+
+    assert len(header) == HEADER_SIZE
+
+    with open(gfa_path, "wb") as f:
+        f.write(header)
+        f.write(payload)
+
+    print(
+        f"[GFA] {os.path.basename(mp3_path)} -> {os.path.basename(gfa_path)}: "
+        f"{len(samples) / rate:.2f} s, {os.path.getsize(mp3_path):,} -> {HEADER_SIZE + len(payload):,} bytes"
+    )
+
+
+def transcode_dir(data_dir, codec=CODEC_IMA_ADPCM, rate=DEFAULT_RATE):
+    """Transcode all MP3 clips of a directory whose .gfa clip is missing or outdated."""
+
+    if shutil.which("ffmpeg") is None:
+        print("[GFA] ffmpeg not found, the clips are not transcoded and will be played as MP3")
+        return
+
+    for mp3_path in sorted(glob.glob(os.path.join(data_dir, "*.mp3"))):
+        gfa_path = os.path.splitext(mp3_path)[0] + ".gfa"
+        if os.path.isfile(gfa_path) and os.path.getmtime(gfa_path) >= os.path.getmtime(mp3_path):
+            continue
+        transcode(mp3_path, gfa_path, codec, rate)
+
+
+# ---------------------------------------------------------------------------
+# PlatformIO integration – transcode before the filesystem image is built
+# ---------------------------------------------------------------------------
+try:
+    Import("env")
+
+    def transcode_action(source, target, env):
+        transcode_dir(env.subst("${PROJECT_DATA_DIR}"))
+
+    env.AddPreAction("$BUILD_DIR/${ESP32_FS_IMAGE_NAME}.bin", transcode_action)
+except Exception:
+    pass
+
+# ---------------------------------------------------------------------------
+# Standalone CLI usage
+# ---------------------------------------------------------------------------
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Transcode MP3 clips into .gfa clips")
+    parser.add_argument("data_dir", nargs="?", default="data")
+    parser.add_argument("--codec", choices=["adpcm", "pcm"], default="adpcm")
+    parser.add_argument("--rate", type=int, default=DEFAULT_RATE)
+    args = parser.parse_args()
+    if not os.path.isdir(args.data_dir):
+        print(f"Data directory not found: {args.data_dir}")
+        sys.exit(1)
+    transcode_dir(args.data_dir, CODEC_IMA_ADPCM if args.codec == "adpcm" else CODEC_PCM, args.rate)
@@ -0,0 +1 @@
+import{z as o}from"./NLfJdlKT.js";function n(t,e,a,m){return o({get:t,set:u=>{e(Math.max(a,Math.min(m,u)))}})}export{n as u};
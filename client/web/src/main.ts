@@ -86,6 +86,7 @@ const i18n = createI18n({
                 language: "Language",
                 metronome_sound: "Metronome Sound",
                 current_metronome_sound: "Current Metronome Sound: ",
+                metronome_bpm: "Metronome Tempo (BPM)",
                 miss_sound: "Miss Sound",
                 current_miss_sound: "Current Miss Sound: ",
                 info: "Information",
@@ -233,6 +234,7 @@ const i18n = createI18n({
                 language: "Sprache",
                 metronome_sound: "Metronome Ton",
                 current_metronome_sound: "Aktueller Metronome Ton: ",
+                metronome_bpm: "Metronom Tempo (BPM)",
                 miss_sound: "Fehlschuss Ton",
                 current_miss_sound: "Aktueller Fehlschuss Ton: ",
                 info: "Informationen",
@@ -17,8 +17,7 @@
 
 
 import type {Player} from "@/models/player";
-
-const API_URL = "/api"
+import {type ShotEvent, ShotEventStream} from "@/models/shotEvents";
 
 abstract class Game {
     protected readonly _players: Player[];
@@ -80,6 +79,7 @@ export class ShotChallengeGame extends Game {
     public _timer: number = 0;
     public hasEnded: boolean = false;
     private timerIntervalId: number = -1;
+    private readonly events = new ShotEventStream();
     public selectedPlayerIndex: number = 0;
 
     public get timer(): number {
@@ -103,35 +103,12 @@ export class ShotChallengeGame extends Game {
 
     public async start(): Promise<void> {
         if(!this.isRunning) {
-            this.timerIntervalId = setInterval(async () => {
+            // opened here, so that the listener updates the game through its reactive proxy
+            this.events.open(event => this.onShotEvent(event));
+            this.timerIntervalId = setInterval(() => {
                 if (this.hasEnded) return;
                 this._timer--;
 
-                if (this.hasEnded) return;
-                const newHitsData = await fetch(`${API_URL}/hits`, {method: "GET"});
-                const newHits = parseInt(await newHitsData.text());
-
-                if (this.hasEnded) return;
-                const newMissesData = await fetch(`${API_URL}/misses`, {method: "GET"});
-                const newMisses = parseInt(await newMissesData.text());
-
-                if(this.hasEnded) return;
-                if(newHits > 0) {
-                    console.log("[ShotChallenge] hits detected:", newHits);
-                    for(let i = 0; i < newHits; i++) {
-                        this.getSelectedPlayer().addHit();
-                        this.resetTimer();
-                        this.selectNewPlayer();
-                    }
-                } else if(newMisses > 0) {
-                    console.log("[ShotChallenge] misses detected:", newMisses);
-                    for(let i = 0; i < newMisses; i++) {
-                        this.getSelectedPlayer().addMiss();
-                        this.resetTimer();
-                        this.selectNewPlayer();
-                    }
-                }
-
                 if(this._timer <= 0) {
                     this.getSelectedPlayer().addMiss();
                     this.resetTimer();
@@ -143,8 +120,21 @@ export class ShotChallengeGame extends Game {
         super.start();
     }
 
+    private onShotEvent(event: ShotEvent): void {
+        if (this.hasEnded || event.type === "shot") return;
+        console.log("[ShotChallenge] detected:", event.type);
+        if (event.type === "hit") {
+            this.getSelectedPlayer().addHit();
+        } else {
+            this.getSelectedPlayer().addMiss();
+        }
+        this.resetTimer();
+        this.selectNewPlayer();
+    }
+
     public pause(): void {
         clearInterval(this.timerIntervalId);
+        this.events.close();
 
         super.pause();
     }
@@ -175,6 +165,7 @@ export class TimedShotsChallengeGame extends Game {
     public _timer: number = 0;
     public hasEnded: boolean = false;
     private timerIntervalId: number = -1;
+    private readonly events = new ShotEventStream();
     public selectedPlayerIndex: number = 0;
 
     public get timer(): number {
@@ -198,33 +189,11 @@ export class TimedShotsChallengeGame extends Game {
 
     public async start(): Promise<void> {
         if(!this.isRunning) {
-            this.timerIntervalId = setInterval(async () => {
+            this.events.open(event => this.onShotEvent(event));
+            this.timerIntervalId = setInterval(() => {
                 if (this.hasEnded) return;
                 this._timer--;
 
-                if (this.hasEnded) return;
-                const newHitsData = await fetch(`${API_URL}/hits`, {method: "GET"});
-                const newHits = parseInt(await newHitsData.text());
-
-                if (this.hasEnded) return;
-                const newMissesData = await fetch(`${API_URL}/misses`, {method: "GET"});
-                const newMisses = parseInt(await newMissesData.text());
-
-                if(this.hasEnded) return;
-                if(newHits > 0) {
-                    console.log("[TimedShots] hits detected:", newHits);
-                    for(let i = 0; i < newHits; i++) {
-                        this.getSelectedPlayer().addHit();
-                    }
-                }
-
-                if(newMisses > 0) {
-                    console.log("[TimedShots] misses detected:", newMisses);
-                    for(let i = 0; i < newMisses; i++) {
-                        this.getSelectedPlayer().addMiss();
-                    }
-                }
-
                 if(this._timer <= 0) {
                     this.resetTimer();
                     this.selectNewPlayer();
@@ -235,8 +204,20 @@ export class TimedShotsChallengeGame extends Game {
         super.start();
     }
 
+    private onShotEvent(event: ShotEvent): void {
+        if (this.hasEnded) return;
+        if (event.type === "hit") {
+            console.log("[TimedShots] hit detected");
+            this.getSelectedPlayer().addHit();
+        } else if (event.type === "miss") {
+            console.log("[TimedShots] miss detected");
+            this.getSelectedPlayer().addMiss();
+        }
+    }
+
     public pause(): void {
         clearInterval(this.timerIntervalId);
+        this.events.close();
 
         super.pause();
     }
@@ -265,7 +246,7 @@ export class FreePlayGame {
     private _hits: number = 0;
     private _misses: number = 0;
     private _isRunning: boolean = false;
-    private pollingIntervalId: number = -1;
+    private readonly events = new ShotEventStream();
 
     public get hits(): number {
         return this._hits;
@@ -281,32 +262,25 @@ export class FreePlayGame {
 
     public async start(): Promise<void> {
         if (!this._isRunning) {
-            this.pollingIntervalId = setInterval(async () => {
-                if (!this._isRunning) return;
-
-                const newHitsData = await fetch(`${API_URL}/hits`, { method: "GET" });
-                const newHits = parseInt(await newHitsData.text());
-
-                const newMissesData = await fetch(`${API_URL}/misses`, { method: "GET" });
-                const newMisses = parseInt(await newMissesData.text());
-
-                if (newHits > 0) {
-                    console.log("[FreePlay] hits detected:", newHits);
-                    this._hits += newHits;
-                }
-
-                if (newMisses > 0) {
-                    console.log("[FreePlay] misses detected:", newMisses);
-                    this._misses += newMisses;
-                }
-            }, 1000);
+            this.events.open(event => this.onShotEvent(event));
         }
 
         this._isRunning = true;
     }
 
+    private onShotEvent(event: ShotEvent): void {
+        if (!this._isRunning) return;
+        if (event.type === "hit") {
+            console.log("[FreePlay] hit detected");
+            this._hits++;
+        } else if (event.type === "miss") {
+            console.log("[FreePlay] miss detected");
+            this._misses++;
+        }
+    }
+
     public pause(): void {
-        clearInterval(this.pollingIntervalId);
+        this.events.close();
         this._isRunning = false;
     }
 
@@ -0,0 +1,141 @@
+/*
+ * ===============================================================================
+ * (c) HTBLA Leonding 2024 - 2026
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Licensed under MIT License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the license.
+ * - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * All trademarks used in this document are property of their respective owners.
+ * ===============================================================================
+ */
+
+
+const API_URL = "/api"
+
+export type ShotEventType = "shot" | "hit" | "miss";
+
+export interface ShotEvent {
+    /** Increments with every event since the start of the device */
+    seq: number;
+    type: ShotEventType;
+    /** Device time of the detection */
+    ms: number;
+}
+
+interface ShotEventPage {
+    /** The oldest event the device still has */
+    first: number;
+    /** The last event detected, 0 if none */
+    last: number;
+    events: ShotEvent[];
+}
+
+/**
+ * Receives the events detected by the device as they happen (Server-Sent Events).
+ * Only events detected after the stream was opened are passed to the listener.
+ * After a reconnect the device replays the missed events, so events already
+ * seen are skipped by their sequence number.
+ *
+ * The device keeps a few streams open at most. If the stream closes before the
+ * device greeted it, it was rejected (or the device is unreachable) and the
+ * events are polled with /api/events?since= instead, until close() is called.
+ */
+export class ShotEventStream {
+    private static readonly pollIntervalMs = 1000;
+
+    private source: EventSource | null = null;
+    private pollTimer: number | null = null;
+    private lastSequence: number = -1;
+    private listener: ((event: ShotEvent) => void) | null = null;
+
+    public open(listener: (event: ShotEvent) => void): void {
+        if (this.source || this.pollTimer !== null) {
+            return;
+        }
+
+        this.lastSequence = -1;
+        this.listener = listener;
+        const source = new EventSource(`${API_URL}/events`);
+        let greeted = false;
+        this.source = source;
+        source.addEventListener("hello", (message: MessageEvent) => {
+            greeted = true;
+            this.restartFrom(JSON.parse(message.data).seq);
+        });
+        source.addEventListener("shots", (message: MessageEvent) => {
+            this.receive(JSON.parse(message.data) as ShotEvent[]);
+        });
+        source.addEventListener("error", () => {
+            if (!greeted && this.source === source) {
+                source.close();
+                this.source = null;
+                this.schedulePoll(0);
+            }
+            // the browser reconnects by itself, each connection is greeted again
+            greeted = false;
+        });
+    }
+
+    public close(): void {
+        this.source?.close();
+        this.source = null;
+        if (this.pollTimer !== null) {
+            window.clearTimeout(this.pollTimer);
+            this.pollTimer = null;
+        }
+        this.listener = null;
+    }
+
+    /** Starts at the device's last event, unless it was seen already and the device did not restart. */
+    private restartFrom(seq: number): void {
+        if (this.lastSequence < 0 || seq < this.lastSequence) {
+            this.lastSequence = seq;
+        }
+    }
+
+    private receive(events: ShotEvent[]): void {
+        for (const event of events) {
+            if (this.lastSequence >= 0 && event.seq > this.lastSequence) {
+                this.lastSequence = event.seq;
+                this.listener?.(event);
+            }
+        }
+    }
+
+    private schedulePoll(delayMs: number): void {
+        this.pollTimer = window.setTimeout(() => this.poll(), delayMs);
+    }
+
+    private async poll(): Promise<void> {
+        let delayMs = ShotEventStream.pollIntervalMs;
+        try {
+            // the first request only learns where the events start
+            const since = Math.max(this.lastSequence, 0);
+            const limit = this.lastSequence < 0 ? "&limit=1" : "";
+            const response = await fetch(`${API_URL}/events?since=${since}${limit}`,
+                { signal: AbortSignal.timeout(3000) });
+            if (response.ok) {
+                const page: ShotEventPage = await response.json();
+                if (this.lastSequence < 0 || page.last < this.lastSequence) {
+                    this.restartFrom(page.last);
+                } else {
+                    this.receive(page.events);
+                }
+                // more events than fit in one response are fetched right away
+                if (page.events.length > 0 && page.last > this.lastSequence) {
+                    delayMs = 0;
+                }
+            }
+        } catch (error) {
+            console.error(error);
+        }
+        if (this.pollTimer !== null) {
+            this.schedulePoll(delayMs);
+        }
+    }
+}
@@ -1,6 +1,5 @@
 import type {Player} from "@/models/player";
-
-const API_URL = "/api"
+import {ShotEventStream} from "@/models/shotEvents";
 
 abstract class Game {
     private readonly _players: Player[];
@@ -61,6 +60,8 @@ export class ShotChallengeGame extends Game {
 
     private _timer: number = 0;
     private timerIntervalId: number = -1;
+    private readonly events = new ShotEventStream();
+    private hitsInTurn: number = 0;
     private selectedPlayerIndex: number = 0;
 
     public get timer(): number {
@@ -83,33 +84,25 @@ export class ShotChallengeGame extends Game {
     }
 
     public async start(): Promise<void> {
-        let hits: number = 0;
-        console.log(hits);
-
-        try {
-            const hitsData = await fetch(`${API_URL}/hits`, {method: "GET"});
-            hits = parseInt(await hitsData.text());
-        }
-        catch (e) {
-            console.log(e);
-        }
-
         if(!this.isRunning) {
-            this.timerIntervalId = setInterval(async () => {
+            this.hitsInTurn = 0;
+            this.events.open(event => {
+                if (event.type === "hit") {
+                    this.hitsInTurn++;
+                }
+            });
+            this.timerIntervalId = setInterval(() => {
                 this._timer--;
 
                 if (this._timer <= 0) {
-                    const newHitsData = await fetch(`${API_URL}/hits`, {method: "GET"});
-                    const newHits = parseInt(await newHitsData.text());
-                    console.log(newHits);
-
-                    if(newHits > hits) {
+                    if(this.hitsInTurn > 0) {
                         this.getSelectedPlayer().addHit();
                     }
                     else {
                         this.getSelectedPlayer().addMiss();
                     }
 
+                    this.hitsInTurn = 0;
                     this.resetTimer();
                     this.selectNewPlayer();
                 }
@@ -121,6 +114,7 @@ export class ShotChallengeGame extends Game {
 
     public pause(): void {
         clearInterval(this.timerIntervalId);
+        this.events.close();
 
         super.pause();
     }
@@ -1,5 +1,5 @@
 import {defineStore} from "pinia";
-import {ref} from "vue";
+import {ref, type Ref} from "vue";
 
 const API_URL = "/api"
 const WIFI_PASSWORD_MIN_LENGTH = 4;
@@ -43,6 +43,7 @@ export const useSettingsStore = defineStore("settings", () => {
     //Audio
     const volume = ref(0);
     const metronomeSound = ref(0);
+    const metronomeBpm = ref(30);
     const hitSound = ref(0);
     const missSound = ref(0);
 
@@ -50,6 +51,48 @@ export const useSettingsStore = defineStore("settings", () => {
     const macAddress = ref("");
     const version = ref("");
 
+    // The settings stored on the device, by their JSON names
+    const persisted: Record<string, Ref<string | number | boolean>> = {
+        deviceName,
+        devicePassword,
+        wifiPassword,
+        vibrationSensorSensitivity,
+        ballHitDetectionDistance,
+        distanceOnlyHitDetection,
+        volume,
+        metronomeSound,
+        metronomeBpm,
+        hitSound,
+        missSound,
+        ledMode,
+        ledBrightness,
+        afterHitTimeout,
+    };
+    // The values the device has, as last loaded or saved, and their ETag
+    let saved: Record<string, unknown> = {};
+    let etag: string | null = null;
+
+    function remember(json: Record<string, unknown>, tag: string | null): void {
+        saved = {};
+        for (const key of Object.keys(persisted)) {
+            saved[key] = json[key];
+        }
+        etag = tag;
+    }
+
+    function collectChanges(): Record<string, unknown> {
+        const changes: Record<string, unknown> = {};
+        for (const [key, value] of Object.entries(persisted)) {
+            if (value.value !== saved[key]) {
+                changes[key] = value.value;
+            }
+        }
+        if (wifiPassword.value.length > 0 && wifiPassword.value.length < WIFI_PASSWORD_MIN_LENGTH) {
+            delete changes.wifiPassword;
+        }
+        return changes;
+    }
+
     const refreshAvailableNetworks = () => {
 
     }
@@ -71,6 +114,7 @@ export const useSettingsStore = defineStore("settings", () => {
                 wifiPassword.value = json["wifiPassword"];
                 volume.value = json["volume"];
                 metronomeSound.value = json["metronomeSound"];
+                metronomeBpm.value = json["metronomeBpm"] ?? 30;
                 hitSound.value = json["hitSound"];
                 missSound.value = json["missSound"];
                 ledMode.value = json["ledMode"];
@@ -82,6 +126,7 @@ export const useSettingsStore = defineStore("settings", () => {
                 ballHitDetectionDistance.value = json["ballHitDetectionDistance"];
                 distanceOnlyHitDetection.value = json["distanceOnlyHitDetection"] ?? false;
                 afterHitTimeout.value = json["afterHitTimeout"] ?? 5;
+                remember(json, response.headers.get("ETag"));
 
                 // Map ledMode to its corresponding string representation
                 const ledModeMapping: { [key: number]: string } = {
@@ -103,19 +148,43 @@ export const useSettingsStore = defineStore("settings", () => {
         }
     }
 
-    async function saveSettings(): Promise<void> {
-        if (isLoading) return;
-        try {
-            const state = { ...useSettingsStore().$state };
+    /**
+     * Sends the changed settings only. If another client changed the settings in between,
+     * its values are loaded and the own changes are sent again, except for the settings
+     * both clients changed: those keep the value of the other client.
+     */
+    async function patchSettings(retry: boolean): Promise<void> {
+        const changes = collectChanges();
+        if (Object.keys(changes).length === 0) return;
+
+        const headers: Record<string, string> = {"Content-Type": "application/json"};
+        if (etag) {
+            headers["If-Match"] = etag;
+        }
+        const response = await fetch(`${API_URL}/settings`, {
+            method: "PATCH",
+            headers,
+            body: JSON.stringify(changes),
+        });
 
-            if (wifiPassword.value.length > 0 && wifiPassword.value.length < WIFI_PASSWORD_MIN_LENGTH) {
-                delete (state as any).wifiPassword;
+        if (response.ok) {
+            remember(await response.json(), response.headers.get("ETag"));
+        } else if (response.status === 412 && retry) {
+            const base = saved;
+            await getSettings();
+            for (const [key, value] of Object.entries(changes)) {
+                if (saved[key] === base[key]) {
+                    persisted[key].value = value as string | number | boolean;
+                }
             }
+            await patchSettings(false);
+        }
+    }
 
-            await fetch(`${API_URL}/settings`, {
-                method: "POST",
-                body: JSON.stringify(state),
-            });
+    async function saveSettings(): Promise<void> {
+        if (isLoading) return;
+        try {
+            await patchSettings(true);
 
             if(isSoundEnabled.value) {
                 await fetch(`${API_URL}/start`, {
@@ -253,6 +322,7 @@ export const useSettingsStore = defineStore("settings", () => {
         availableNetworks,
         volume,
         metronomeSound,
+        metronomeBpm,
         hitSound,
         missSound,
         macAddress,
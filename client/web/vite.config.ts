@@ -20,7 +20,7 @@ export default defineConfig({
     }
   },
   build: {
-    outDir: '../embedded/data/web',
+    outDir: '../embedded/webapp',
     emptyOutDir: true,
     rollupOptions: {
       output: {